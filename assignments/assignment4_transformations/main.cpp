@@ -12,6 +12,7 @@
 #include "bob/transformations.h"
 #include <ew/ewMath/vec3.h>
 #include <ew/procGen.h>
+#include <ew/instanceBuffer.h>
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 
@@ -55,13 +56,13 @@ int main() {
 	//Depth testing - required for depth sorting!
 	glEnable(GL_DEPTH_TEST);
 
-	ew::Shader shader("assets/vertexShader.vert", "assets/fragmentShader.frag");
+	//Reads _Model per instance instead of from a uniform
+	ew::Shader shader("assets/vertexShaderInstanced.vert", "assets/fragmentShader.frag");
 	
-	//Cube mesh
-	ew::Mesh cubeMesh1(ew::createCube(0.5f));
-	ew::Mesh cubeMesh2(ew::createCube(0.5f));
-	ew::Mesh cubeMesh3(ew::createCube(0.5f));
-	ew::Mesh cubeMesh4(ew::createCube(0.5f));
+	//Cube mesh, drawn once per transform in a single call
+	ew::Mesh cubeMesh(ew::createCube(0.5f));
+	ew::InstanceBuffer cubeInstances;
+	cubeMesh.setInstanceBuffer(cubeInstances);
 
 	
 	for (int i = 0; i < NUM_CUBES; i++)
@@ -80,15 +81,9 @@ int main() {
 		//Set uniforms
 		shader.use();
 
-		//TODO: Set model matrix uniform
-		for (int i = 0; i < NUM_CUBES; i++) 
-		{
-			shader.setMat4("_Model", cubeTransforms[i].getModelMatrix());
-			cubeMesh1.draw();
-			cubeMesh2.draw();
-			cubeMesh3.draw();
-			cubeMesh4.draw();
-		}
+		//Model matrices are only rebuilt for transforms that changed
+		cubeInstances.update(cubeTransforms, NUM_CUBES);
+		cubeMesh.drawInstanced(NUM_CUBES);
 
 		//Render UI
 		{
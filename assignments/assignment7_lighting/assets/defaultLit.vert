@@ -12,11 +12,12 @@ out Surface{
 }vs_out;
 
 uniform mat4 _Model;
+uniform mat3 _NormalMatrix; //transpose(inverse(mat3(_Model))), computed on the CPU once per object
 uniform mat4 _ViewProjection;
 
 void main(){
 	vs_out.UV = vUV;
 	vs_out.WorldPosition = vec3(_Model * vec4(vPos,1.0));
-	vs_out.WorldNormal = transpose(inverse(mat3(_Model))) * vNormal;
+	vs_out.WorldNormal = _NormalMatrix * vNormal;
 	gl_Position = _ViewProjection * _Model * vec4(vPos,1.0);
 }
@@ -11,6 +11,8 @@
 #include <ew/shader.h>
 #include <ew/texture.h>
 #include <ew/procGen.h>
+#include <ew/meshCache.h>
+#include <ew/lod.h>
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
@@ -86,11 +88,17 @@ int main() {
 		material.shininess = 15.0f //Shininess
 	};
 
-	//Create Shapes
-	ew::Mesh cubeMesh(ew::createCube(1.0f));
-	ew::Mesh planeMesh(ew::createPlane(5.0f, 5.0f, 10));
-	ew::Mesh sphereMesh(ew::createSphere(0.5f, 64));
-	ew::Mesh cylinderMesh(ew::createCylinder(0.5f, 1.0f, 32));
+	//Create Shapes. Identical requests share one mesh.
+	ew::ProceduralMeshCache meshCache;
+	ew::SharedMesh cubeMesh = meshCache.get(ew::CubeParams{ 1.0f });
+	ew::SharedMesh planeMesh = meshCache.get(ew::PlaneParams{ 5.0f, 5.0f, 10 });
+	//With a LOD chain, so the sphere drops detail it can't show when it is small on screen
+	ew::SharedMesh sphereMesh = meshCache.get(ew::MeshFileCache::makeKey("sphereLOD", ew::SphereParams::VERSION, { 0.5f, 64 }), []() {
+		ew::MeshData mesh = ew::createSphere(0.5f, 64);
+		ew::generateLODChain(mesh);
+		return mesh;
+	});
+	ew::SharedMesh cylinderMesh = meshCache.get(ew::CylinderParams{ 0.5f, 1.0f, 32 });
 
 	//Create Material
 	Material mat;
@@ -106,7 +114,8 @@ int main() {
 
 	resetCamera(camera,cameraController);
 
-	ew::Mesh lightSphereMesh = ew::createSphere(0.5f, 20);
+	//Low detail gizmo, one mesh shared by every light
+	ew::SharedMesh lightSphereMesh = meshCache.get(ew::SphereParams{ 0.5f, 20 });
 
 	ew::Transform lightTransforms[MAX_LIGHTS];
 
@@ -169,16 +178,20 @@ int main() {
 
 		//Draw shapes
 		shader.setMat4("_Model", cubeTransform.getModelMatrix());
-		cubeMesh.draw();
+		shader.setMat3("_NormalMatrix", cubeTransform.getNormalMatrix());
+		cubeMesh->draw();
 
 		shader.setMat4("_Model", planeTransform.getModelMatrix());
-		planeMesh.draw();
+		shader.setMat3("_NormalMatrix", planeTransform.getNormalMatrix());
+		planeMesh->draw();
 
 		shader.setMat4("_Model", sphereTransform.getModelMatrix());
-		sphereMesh.draw();
+		shader.setMat3("_NormalMatrix", sphereTransform.getNormalMatrix());
+		sphereMesh->drawLOD(ew::selectLOD(*sphereMesh, sphereTransform.getModelMatrix(), camera, (float)SCREEN_HEIGHT));
 
 		shader.setMat4("_Model", cylinderTransform.getModelMatrix());
-		cylinderMesh.draw();
+		shader.setMat3("_NormalMatrix", cylinderTransform.getNormalMatrix());
+		cylinderMesh->draw();
 
 		//Render point lights
 		for(int i = 0; i < lightCount; i++)
@@ -189,7 +202,7 @@ int main() {
 			
 			lightTransforms[i].position = lights[i].position;
 			unlitShader.setMat4("_Model", lightTransforms[i].getModelMatrix());
-			lightSphereMesh.draw();
+			lightSphereMesh->draw();
 		}
 
 		//Render UI
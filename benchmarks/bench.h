@@ -0,0 +1,48 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <stdio.h>
+#include <vector>
+
+//Shared harness for the benchmark cases. Each case is a function registered with EW_BENCH in its own file.
+//Run all cases with "ewBench", or only those whose name contains a filter with "ewBench <filter>".
+namespace bench {
+	struct Case {
+		const char* name;
+		void (*run)();
+	};
+
+	inline std::vector<Case>& cases() {
+		static std::vector<Case> all;
+		return all;
+	}
+
+	struct Registration {
+		Registration(const char* name, void (*run)()) { cases().push_back({ name, run }); }
+	};
+
+	/// <summary>
+	/// Runs fn once to warm caches, then repeats times, and returns the fastest run in milliseconds.
+	/// </summary>
+	inline double timeMs(const std::function<void()>& fn, int repeats = 5) {
+		fn();
+		double best = 0.0;
+		for (int i = 0; i < repeats; i++)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			fn();
+			const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			if (i == 0 || ms < best)
+				best = ms;
+		}
+		return best;
+	}
+
+	//Keeps a result observable so the optimizer can't drop the work that produced it. Defined in main.cpp.
+	void doNotOptimize(const void* p);
+}
+
+#define EW_BENCH(name) \
+	static void name(); \
+	static bench::Registration name##Registration(#name, name); \
+	static void name()
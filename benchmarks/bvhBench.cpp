@@ -0,0 +1,121 @@
+//BVH build, refit and queries at 10k, 100k and 1M objects, against testing every object
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include <ew/bvh.h>
+#include "bench.h"
+
+namespace {
+	//Unit boxes at constant density in a cube that grows with the count
+	std::vector<ew::AABB> makeBoxes(size_t count, float* worldSize) {
+		*worldSize = 10.0f * cbrtf((float)count);
+		std::vector<ew::AABB> boxes(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const ew::Vec3 center = ew::Vec3(ew::RandomRange(0.0f, *worldSize), ew::RandomRange(0.0f, *worldSize), ew::RandomRange(0.0f, *worldSize));
+			boxes[i].min = center - ew::Vec3(0.5f);
+			boxes[i].max = center + ew::Vec3(0.5f);
+		}
+		return boxes;
+	}
+
+	bool rayHitsBox(const ew::Ray& ray, const ew::AABB& box, float* distance) {
+		float tMin = 0.0f;
+		float tMax = INFINITY;
+		const float origin[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+		const float direction[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+		const float lo[3] = { box.min.x, box.min.y, box.min.z };
+		const float hi[3] = { box.max.x, box.max.y, box.max.z };
+		for (int a = 0; a < 3; a++)
+		{
+			const float inv = 1.0f / direction[a];
+			float t0 = (lo[a] - origin[a]) * inv;
+			float t1 = (hi[a] - origin[a]) * inv;
+			if (t0 > t1) {
+				const float t = t0;
+				t0 = t1;
+				t1 = t;
+			}
+			tMin = fmaxf(tMin, t0);
+			tMax = fminf(tMax, t1);
+		}
+		*distance = tMin;
+		return tMin <= tMax;
+	}
+}
+
+EW_BENCH(bvh) {
+	srand(1);
+	printf("%9s %10s %10s %12s %12s %12s %12s\n", "objects", "build ms", "refit ms", "frustum ms", "(all) ms", "1k rays ms", "(all) ms");
+	for (size_t count : { (size_t)10000, (size_t)100000, (size_t)1000000 }) {
+		float worldSize;
+		std::vector<ew::AABB> boxes = makeBoxes(count, &worldSize);
+		ew::BVH bvh;
+		const double buildMs = bench::timeMs([&]() { bvh.build(boxes.data(), boxes.size()); }, 3);
+
+		//Every object drifts a little, as in a frame of animation
+		std::vector<ew::AABB> moved = boxes;
+		for (ew::AABB& box : moved) {
+			box.min.y += 0.25f;
+			box.max.y += 0.25f;
+		}
+		const double refitMs = bench::timeMs([&]() { bvh.refit(moved.data()); }, 3);
+		bvh.build(boxes.data(), boxes.size());
+
+		//Looking into the world from one corner. The far plane scales with the world, so the same fraction is visible at every count.
+		ew::Camera camera;
+		camera.position = ew::Vec3(0.0f);
+		camera.target = ew::Vec3(worldSize * 0.5f, worldSize * 0.25f, worldSize * 0.5f);
+		camera.farPlane = worldSize * 0.5f;
+		camera.aspectRatio = 1.0f;
+		const ew::Frustum frustum = ew::extractFrustum(camera);
+		std::vector<unsigned int> visible;
+		visible.reserve(count);
+		const double frustumMs = bench::timeMs([&]() {
+			visible.clear();
+			bvh.queryFrustum(frustum, &visible);
+		});
+		const size_t bvhVisible = visible.size();
+		const double frustumAllMs = bench::timeMs([&]() {
+			visible.clear();
+			for (size_t i = 0; i < count; i++)
+			{
+				if (frustum.intersectsAABB(boxes[i].min, boxes[i].max))
+					visible.push_back((unsigned int)i);
+			}
+		});
+
+		std::vector<ew::Ray> rays(1000);
+		for (ew::Ray& ray : rays) {
+			ray.origin = ew::Vec3(ew::RandomRange(0.0f, worldSize), ew::RandomRange(0.0f, worldSize), -1.0f);
+			ray.direction = ew::Normalize(ew::Vec3(ew::RandomRange(-0.2f, 0.2f), ew::RandomRange(-0.2f, 0.2f), 1.0f));
+		}
+		int hits = 0;
+		const double raysMs = bench::timeMs([&]() {
+			hits = 0;
+			for (const ew::Ray& ray : rays) {
+				ew::RayHit hit;
+				hits += bvh.raycast(ray, &hit) ? 1 : 0;
+			}
+		}, 3);
+		//Testing every box is too slow for 1000 rays, so it is timed for 10 and scaled
+		const double raysAllMs = bench::timeMs([&]() {
+			float closest = 0.0f;
+			for (size_t r = 0; r < 10; r++)
+			{
+				closest = INFINITY;
+				for (size_t i = 0; i < count; i++)
+				{
+					float distance;
+					if (rayHitsBox(rays[r], boxes[i], &distance))
+						closest = fminf(closest, distance);
+				}
+			}
+			bench::doNotOptimize(&closest);
+		}, 1) * 100.0;
+
+		printf("%9zu %10.2f %10.2f %12.3f %12.3f %12.3f %12.1f   (%zu visible, %d rays hit)\n",
+			count, buildMs, refitMs, frustumMs, frustumAllMs, raysMs, raysAllMs, bvhVisible, hits);
+	}
+}
@@ -0,0 +1,30 @@
+#include <string.h>
+#include <ew/parallel.h>
+#include <ew/ewMath/simd.h>
+#include "bench.h"
+
+namespace bench {
+	//Out of line and volatile, so the compiler can't see through it
+	static const void* volatile s_sink;
+	void doNotOptimize(const void* p) {
+		s_sink = p;
+	}
+}
+
+int main(int argc, char** argv) {
+	const char* filter = argc > 1 ? argv[1] : "";
+	printf("SIMD %s, %u hardware threads\n", ew::SimdLevelName(ew::GetSimdLevel()), ew::hardwareThreadCount());
+	int ran = 0;
+	for (const bench::Case& c : bench::cases()) {
+		if (strstr(c.name, filter) == nullptr)
+			continue;
+		printf("\n== %s ==\n", c.name);
+		c.run();
+		ran++;
+	}
+	if (ran == 0) {
+		printf("No benchmark matches \"%s\"\n", filter);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,46 @@
+//Mat4 multiplies on each SIMD backend the CPU supports
+
+#include <vector>
+#include <ew/ewMath/ewMath.h>
+#include "bench.h"
+
+EW_BENCH(mat4Multiply) {
+	const size_t count = 1 << 20;
+	std::vector<ew::Mat4> matrices(count);
+	std::vector<ew::Vec4> vectors(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const float f = (float)(i % 97) * 0.01f;
+		matrices[i] = ew::Mat4(1.0f + f, f, 0.0f, 0.0f,
+			-f, 1.0f - f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			f, 2.0f * f, 3.0f * f, 1.0f);
+		vectors[i] = ew::Vec4(f, 1.0f, -f, 1.0f);
+	}
+	std::vector<ew::Mat4> products(count);
+	std::vector<ew::Vec4> transformed(count);
+
+	const ew::SimdLevel detected = ew::DetectSimdLevel();
+	for (int level = (int)ew::SimdLevel::SCALAR; level <= (int)detected; level++)
+	{
+		ew::SetSimdLevel((ew::SimdLevel)level);
+		//Products of neighbors, as when composing parent and child transforms
+		const double mulMs = bench::timeMs([&]() {
+			for (size_t i = 0; i + 1 < count; i++)
+			{
+				products[i] = matrices[i] * matrices[i + 1];
+			}
+			bench::doNotOptimize(products.data());
+		});
+		const double vecMs = bench::timeMs([&]() {
+			for (size_t i = 0; i < count; i++)
+			{
+				transformed[i] = matrices[i] * vectors[i];
+			}
+			bench::doNotOptimize(transformed.data());
+		});
+		printf("%-7s Mat4*Mat4 %6.2f ns   Mat4*Vec4 %6.2f ns\n", ew::SimdLevelName((ew::SimdLevel)level),
+			mulMs * 1e6 / (double)(count - 1), vecMs * 1e6 / (double)count);
+	}
+	ew::SetSimdLevel(detected);
+}
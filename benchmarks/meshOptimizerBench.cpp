@@ -0,0 +1,68 @@
+//Throughput of the vertex cache, overdraw and vertex fetch passes on spheres of increasing size
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <ew/procGen.h>
+#include <ew/meshOptimizer.h>
+#include "bench.h"
+
+namespace {
+	//procGen output is already in a cache friendly order, so triangles are shuffled like an unoptimized export
+	ew::MeshData shuffledSphere(int subdivisions) {
+		ew::MeshData mesh = ew::createSphere(1.0f, subdivisions);
+		const size_t triangleCount = mesh.indices.size() / 3;
+		std::vector<size_t> order(triangleCount);
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			order[i] = i;
+		}
+		std::shuffle(order.begin(), order.end(), std::mt19937(1));
+		std::vector<unsigned int> indices(mesh.indices.size());
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			std::copy(mesh.indices.begin() + order[i] * 3, mesh.indices.begin() + order[i] * 3 + 3, indices.begin() + i * 3);
+		}
+		mesh.indices.swap(indices);
+		return mesh;
+	}
+}
+
+EW_BENCH(meshOptimizer) {
+	printf("Millions of triangles per second per pass, on shuffled spheres\n");
+	printf("%10s %12s %12s %12s %12s %14s %14s\n", "triangles", "cache", "overdraw", "fetch", "all", "ACMR before", "ACMR after");
+	for (int subdivisions : { 64, 256, 1024 }) {
+		const ew::MeshData source = shuffledSphere(subdivisions);
+		const size_t triangleCount = source.indices.size() / 3;
+		const double millions = (double)triangleCount / 1e6;
+		ew::MeshData mesh;
+
+		std::vector<unsigned int> clusters;
+		const double cacheMs = bench::timeMs([&]() {
+			mesh = source;
+			ew::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), 16, &clusters);
+		}, 3);
+		const std::vector<unsigned int> cacheOrder = mesh.indices;
+		const double copyMs = bench::timeMs([&]() { mesh = source; }, 3);
+
+		const double overdrawMs = bench::timeMs([&]() {
+			mesh.indices = cacheOrder;
+			ew::optimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(), mesh.vertices.size(), clusters);
+		}, 3);
+		const double fetchMs = bench::timeMs([&]() {
+			mesh = source;
+			ew::optimizeVertexFetch(mesh);
+		}, 3);
+		ew::MeshOptimizeStats stats;
+		const double allMs = bench::timeMs([&]() {
+			mesh = source;
+			stats = ew::optimizeMesh(mesh);
+		}, 3);
+
+		//Copying the source back in is part of every timed run except overdraw's, so it is subtracted
+		printf("%10zu %12.1f %12.1f %12.1f %12.1f %14.3f %14.3f\n", triangleCount,
+			millions / ((cacheMs - copyMs) * 1e-3), millions / (overdrawMs * 1e-3),
+			millions / ((fetchMs - copyMs) * 1e-3), millions / ((allMs - copyMs) * 1e-3),
+			stats.before.acmr, stats.after.acmr);
+	}
+}
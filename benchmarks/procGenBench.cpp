@@ -0,0 +1,44 @@
+//Row parallel procedural generators across subdivision and thread counts.
+
+#include <vector>
+#include <ew/parallel.h>
+#include <ew/procGen.h>
+#include "bench.h"
+
+namespace {
+	std::vector<unsigned int> threadCounts() {
+		std::vector<unsigned int> counts = { 1, 2, 4 };
+		const unsigned int hardware = ew::hardwareThreadCount();
+		if (hardware > 4)
+			counts.push_back(hardware);
+		return counts;
+	}
+
+	void sweep(const char* name, std::vector<int> subdivisionCounts, ew::MeshData (*generate)(int subdivisions, unsigned int threadCount)) {
+		const std::vector<unsigned int> threads = threadCounts();
+		printf("%-8s subdiv %9s", name, "vertices");
+		for (unsigned int t : threads)
+			printf("  %2u thread%s", t, t == 1 ? " " : "s");
+		printf("\n");
+		for (int subdivisions : subdivisionCounts)
+		{
+			printf("%-8s %6d %9zu", "", subdivisions, generate(subdivisions, 1).vertices.size());
+			for (unsigned int t : threads)
+			{
+				const double ms = bench::timeMs([&]() {
+					ew::MeshData mesh = generate(subdivisions, t);
+					bench::doNotOptimize(mesh.vertices.data());
+				}, 3);
+				printf(" %8.3f ms", ms);
+			}
+			printf("\n");
+		}
+	}
+}
+
+EW_BENCH(procGen) {
+	sweep("plane", { 64, 256, 1024 }, [](int subdivisions, unsigned int threadCount) { return ew::createPlane(1.0f, 1.0f, subdivisions, threadCount); });
+	sweep("sphere", { 64, 256, 1024 }, [](int subdivisions, unsigned int threadCount) { return ew::createSphere(0.5f, subdivisions, threadCount); });
+	//One ring of quads, so it needs far more subdivisions for the same vertex count
+	sweep("cylinder", { 4096, 65536, 262144 }, [](int subdivisions, unsigned int threadCount) { return ew::createCylinder(0.5f, 1.0f, subdivisions, threadCount); });
+}
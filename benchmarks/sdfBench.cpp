@@ -0,0 +1,51 @@
+//Surface nets meshing of metaballs at 128^3, 256^3 and 512^3 cells across thread counts
+
+#include <math.h>
+#include <vector>
+#include <ew/parallel.h>
+#include <ew/sdfMesh.h>
+#include "bench.h"
+
+namespace {
+	const int RESOLUTIONS[] = { 128, 256, 512 };
+
+	//Smooth union of spheres spread through the region, so most blocks are empty or skipped but many hold surface
+	ew::Sdf makeMetaballs() {
+		ew::Sdf sdf;
+		for (int i = 0; i < 12; i++)
+		{
+			const float f = (float)i;
+			const ew::Vec3 center = ew::Vec3(sinf(f * 1.3f), cosf(f * 0.7f), sinf(f * 2.1f + 1.0f)) * 0.55f;
+			sdf.sphere(center, 0.2f + 0.05f * (float)(i % 3), ew::SdfOp::SMOOTH_UNION, 0.15f);
+		}
+		return sdf;
+	}
+}
+
+EW_BENCH(sdfMesh) {
+	const ew::Sdf sdf = makeMetaballs();
+	std::vector<unsigned int> threads = { 1, 2, 4 };
+	if (ew::hardwareThreadCount() > 4)
+		threads.push_back(ew::hardwareThreadCount());
+
+	printf("%-10s %9s", "resolution", "triangles");
+	for (unsigned int t : threads)
+		printf("  %2u thread%s", t, t == 1 ? " " : "s");
+	printf("\n");
+	for (int resolution : RESOLUTIONS)
+	{
+		ew::SdfMeshParams params;
+		params.resolution = resolution;
+		printf("%6d^3   %9zu", resolution, ew::createSdfMesh(sdf, params).indices.size() / 3);
+		for (unsigned int t : threads)
+		{
+			//Large grids take long enough that a single timed run is stable
+			const double ms = bench::timeMs([&]() {
+				ew::MeshData mesh = ew::createSdfMesh(sdf, params, t);
+				bench::doNotOptimize(mesh.vertices.data());
+			}, resolution >= 512 ? 1 : 3);
+			printf(" %8.1f ms", ms);
+		}
+		printf("\n");
+	}
+}
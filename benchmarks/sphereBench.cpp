@@ -0,0 +1,71 @@
+//Icosphere against cube sphere (and createSphere for reference) at equal geometric error: the fewest subdivisions
+//whose triangles stay within each error of the unit sphere, and what that mesh costs
+
+#include <math.h>
+#include <ew/procGen.h>
+#include "bench.h"
+
+namespace {
+	const float ERRORS[] = { 1e-2f, 1e-3f, 1e-4f };
+
+	typedef ew::MeshData (*Generator)(int subdivisions);
+
+	//Largest gap between the triangles and the unit sphere. Inscribed triangles are furthest inside at their
+	//centroids and edge midpoints, so those are sampled.
+	float maxError(const ew::MeshData& mesh) {
+		float error = 0.0f;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			const ew::Vec3& a = mesh.vertices[mesh.indices[i]].pos;
+			const ew::Vec3& b = mesh.vertices[mesh.indices[i + 1]].pos;
+			const ew::Vec3& c = mesh.vertices[mesh.indices[i + 2]].pos;
+			const ew::Vec3 samples[4] = { (a + b + c) / 3.0f, (a + b) * 0.5f, (b + c) * 0.5f, (c + a) * 0.5f };
+			for (const ew::Vec3& p : samples)
+			{
+				const float e = 1.0f - ew::Magnitude(p);
+				if (e > error)
+					error = e;
+			}
+		}
+		return error;
+	}
+
+	//Fewest subdivisions within maxAllowed. Error falls with subdivisions, so double then bisect.
+	int subdivisionsFor(Generator generate, float maxAllowed) {
+		int hi = 1;
+		while (maxError(generate(hi)) > maxAllowed)
+			hi *= 2;
+		int lo = hi / 2;
+		while (hi - lo > 1)
+		{
+			const int mid = (lo + hi) / 2;
+			if (maxError(generate(mid)) > maxAllowed)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		return hi;
+	}
+
+	void measure(const char* name, Generator generate, float maxAllowed) {
+		const int subdivisions = subdivisionsFor(generate, maxAllowed);
+		const ew::MeshData mesh = generate(subdivisions);
+		const double ms = bench::timeMs([&]() {
+			ew::MeshData m = generate(subdivisions);
+			bench::doNotOptimize(m.vertices.data());
+		});
+		printf("%-10s %6d %9zu %9zu %10.2e %8.3f ms\n", name, subdivisions, mesh.indices.size() / 3, mesh.vertices.size(), maxError(mesh), ms);
+	}
+}
+
+EW_BENCH(sphereEqualError) {
+	//Single threaded, so the times compare the meshes rather than how well each one splits across threads
+	for (float maxAllowed : ERRORS)
+	{
+		printf("max error %.0e\n", maxAllowed);
+		printf("%-10s %6s %9s %9s %10s %11s\n", "", "subdiv", "triangles", "vertices", "error", "time");
+		measure("icosphere", [](int subdivisions) { return ew::createIcosphere(1.0f, subdivisions, 1); }, maxAllowed);
+		measure("cubeSphere", [](int subdivisions) { return ew::createCubeSphere(1.0f, subdivisions, 1); }, maxAllowed);
+		measure("uvSphere", [](int subdivisions) { return ew::createSphere(1.0f, subdivisions, 1); }, maxAllowed);
+	}
+}
@@ -0,0 +1,74 @@
+//Model matrices for 100k transforms: composed from 5 matrices, in closed form, and from the cache
+
+#include <math.h>
+#include <vector>
+#include <ew/transform.h>
+#include "bench.h"
+
+namespace {
+	const size_t TRANSFORM_COUNT = 100000;
+
+	std::vector<ew::Transform> makeTransforms() {
+		std::vector<ew::Transform> transforms(TRANSFORM_COUNT);
+		for (size_t i = 0; i < TRANSFORM_COUNT; i++)
+		{
+			const float f = (float)i;
+			transforms[i].position = ew::Vec3(sinf(f) * 100.0f, f * 0.001f, cosf(f) * 100.0f);
+			transforms[i].rotation = ew::Vec3(fmodf(f * 7.0f, 360.0f), fmodf(f * 13.0f, 360.0f), fmodf(f * 3.0f, 360.0f));
+			transforms[i].scale = ew::Vec3(1.0f + fmodf(f, 3.0f));
+		}
+		return transforms;
+	}
+}
+
+EW_BENCH(transformModelMatrix) {
+	std::vector<ew::Transform> transforms = makeTransforms();
+	std::vector<ew::Mat4> models(TRANSFORM_COUNT);
+
+	//What Transform::getModelMatrix did before it was closed form
+	const double composedMs = bench::timeMs([&]() {
+		for (size_t i = 0; i < TRANSFORM_COUNT; i++)
+		{
+			const ew::Transform& t = transforms[i];
+			models[i] = ew::Translate(t.position)
+				* ew::RotateY(t.rotation.y * ew::DEG2RAD)
+				* ew::RotateX(t.rotation.x * ew::DEG2RAD)
+				* ew::RotateZ(t.rotation.z * ew::DEG2RAD)
+				* ew::Scale(t.scale);
+		}
+		bench::doNotOptimize(models.data());
+	});
+	const double closedFormMs = bench::timeMs([&]() {
+		for (size_t i = 0; i < TRANSFORM_COUNT; i++)
+		{
+			const ew::Transform& t = transforms[i];
+			models[i] = ew::TRS(t.position, t.rotation * ew::DEG2RAD, t.scale);
+		}
+		bench::doNotOptimize(models.data());
+	});
+	//Every transform moves each frame, so each call rebuilds its matrix
+	float frame = 0.0f;
+	const double dirtyMs = bench::timeMs([&]() {
+		frame += 1.0f;
+		for (size_t i = 0; i < TRANSFORM_COUNT; i++)
+		{
+			transforms[i].position.y = frame;
+			models[i] = transforms[i].getModelMatrix();
+		}
+		bench::doNotOptimize(models.data());
+	});
+	//Nothing moves, so each call is a cache check
+	const double cachedMs = bench::timeMs([&]() {
+		for (size_t i = 0; i < TRANSFORM_COUNT; i++)
+		{
+			models[i] = transforms[i].getModelMatrix();
+		}
+		bench::doNotOptimize(models.data());
+	});
+
+	printf("%zu transforms\n", TRANSFORM_COUNT);
+	printf("T*Ry*Rx*Rz*S          %7.3f ms\n", composedMs);
+	printf("TRS closed form       %7.3f ms\n", closedFormMs);
+	printf("getModelMatrix dirty  %7.3f ms\n", dirtyMs);
+	printf("getModelMatrix cached %7.3f ms\n", cachedMs);
+}
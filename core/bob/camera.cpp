@@ -16,7 +16,7 @@ namespace bob {
 
 	ew::Mat4 Camera::ViewMatrix()
 	{
-		return LookAt(position, target, ew::Vec3(0, 1, 0));
+		return bob::LookAt(position, target, ew::Vec3(0, 1, 0));
 	}
 
 	ew::Mat4 Camera::ProjectionMatrix()
@@ -1,211 +1,286 @@
 #include "procGen.h"
+#include "../ew/parallel.h"
+#include <stdio.h>
 
 namespace bob {
-	ew::MeshData createPlane(float width, float height, int subdivisions)
+	static bool fits(const ew::MeshCounts& counts, const ew::VertexSpan& vertices, const ew::IndexSpan& indices)
+	{
+		if (vertices.size >= counts.vertexCount && indices.size >= counts.indexCount)
+			return true;
+		printf("Need %zu vertices and %zu indices, got %zu and %zu\n", counts.vertexCount, counts.indexCount, vertices.size, indices.size);
+		return false;
+	}
+
+	//Allocates exactly what params needs and emits into it
+	template<typename Params>
+	static ew::MeshData createMesh(const Params& params, unsigned int threadCount)
 	{
-		ew::Vertex v;
 		ew::MeshData meshData;
-		//unsigned int startVertex = meshData->vertices.size();
-		for (int row = 0; row <= subdivisions; row++)
-		{
-			for (int col = 0; col <= subdivisions; col++)
-			{
-				v.pos.x = width * ((float)col / subdivisions);
-				v.pos.z = -height * ((float)row / subdivisions);
-				v.pos.y = 0;
-				v.normal = ew::Vec3(0, 1, 0);
-				v.uv = ew::Vec2(((float)col / subdivisions), ((float)row / subdivisions));
-				meshData.vertices.push_back(v);
-			}
-		}
+		ew::MeshCounts counts = queryCounts(params);
+		meshData.vertices.resize(counts.vertexCount);
+		meshData.indices.resize(counts.indexCount);
+		emit(params, ew::VertexSpan(meshData.vertices), ew::IndexSpan(meshData.indices), 0, threadCount);
+		meshData.bounds = queryBounds(params);
+		meshData.hasBounds = true;
+		return meshData;
+	}
 
+	ew::MeshCounts queryCounts(const PlaneParams& params)
+	{
+		size_t subdivisions = params.subdivisions < 1 ? 1 : params.subdivisions;
+		ew::MeshCounts counts;
+		counts.vertexCount = (subdivisions + 1) * (subdivisions + 1);
+		counts.indexCount = subdivisions * subdivisions * 6;
+		return counts;
+	}
+
+	ew::Bounds queryBounds(const PlaneParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(0, 0, -params.height), ew::Vec3(params.width, 0, 0));
+	}
+
+	bool emit(const PlaneParams& params, ew::VertexSpan vertexSpan, ew::IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertexSpan, indexSpan))
+			return false;
+		float width = params.width;
+		float height = params.height;
+		int subdivisions = params.subdivisions < 1 ? 1 : params.subdivisions;
 		int columns = subdivisions + 1;
-		for (int row = 0; row < subdivisions; row++)
+		ew::Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
+		//Each row fills its own vertices and the quads above it
+		ew::parallelFor(columns, threadCount, ew::procGenRowGrain(columns), [&](size_t begin, size_t end)
 		{
-			for (int col = 0; col < subdivisions; col++)
+			for (int row = (int)begin; row < (int)end; row++)
 			{
-				int start = row * columns + col;
-				//Bottom right triangle
-				meshData.indices.push_back(start);
-				meshData.indices.push_back(start + 1);
-				meshData.indices.push_back(start + columns + 1);
-				//Top left triangle
-				meshData.indices.push_back(start);
-				meshData.indices.push_back(start + columns + 1);
-				meshData.indices.push_back(start + columns);
+				ew::Vertex* v = vertices + (size_t)row * columns;
+				for (int col = 0; col <= subdivisions; col++, v++)
+				{
+					v->pos.x = width * ((float)col / subdivisions);
+					v->pos.z = -height * ((float)row / subdivisions);
+					v->pos.y = 0;
+					v->normal = ew::Vec3(0, 1, 0);
+					v->uv = ew::Vec2(((float)col / subdivisions), ((float)row / subdivisions));
+				}
+				if (row == subdivisions)
+					continue;
+				unsigned int* index = indices + (size_t)row * subdivisions * 6;
+				for (int col = 0; col < subdivisions; col++)
+				{
+					unsigned int start = baseVertex + row * columns + col;
+					//Bottom right triangle
+					*index++ = start;
+					*index++ = start + 1;
+					*index++ = start + columns + 1;
+					//Top left triangle
+					*index++ = start;
+					*index++ = start + columns + 1;
+					*index++ = start + columns;
+				}
 			}
-		}
-		return meshData;
+		});
+		return true;
 	}
 
-	ew::MeshData createSphere(float radius, int numSegments)
+	ew::MeshData createPlane(float width, float height, int subdivisions, unsigned int threadCount)
 	{
-		//SPHERE VERTICES
-		ew::Vertex v;
-		ew::MeshData meshData;
-		float thetaStep = 2*ew::PI / numSegments;
-		float phiStep = ew::PI / numSegments;
-		for (int row = 0; row <= numSegments; row++) 
-		{
-			//First and last row converge at poles
-			float phi = row * phiStep;
-			for (int col = 0; col <= numSegments; col++) //Duplicate column for each row
-			{
-				float theta = col * thetaStep;
-				v.pos.x = radius * cos(theta) * sin(phi);
-				v.pos.y = radius * cos(phi);
-				v.pos.z = radius * sin(theta) * sin(phi);
-				v.normal = ew::Normalize(ew::Vec3(cos(theta) * sin(phi), cos(phi), sin(theta) * sin(phi)));
-				v.uv = ew::Vec2(((float)col / numSegments), ((1 - (float)row / numSegments)));
-				meshData.vertices.push_back(v);
-			} 
-		}
-		//SPHERE INDICES
+		PlaneParams params;
+		params.width = width;
+		params.height = height;
+		params.subdivisions = subdivisions;
+		return createMesh(params, threadCount);
+	}
+
+	ew::MeshCounts queryCounts(const SphereParams& params)
+	{
+		size_t numSegments = params.numSegments < 1 ? 1 : params.numSegments;
+		ew::MeshCounts counts;
+		counts.vertexCount = (numSegments + 1) * (numSegments + 1);
+		counts.indexCount = numSegments * numSegments * 6;
+		return counts;
+	}
+
+	ew::Bounds queryBounds(const SphereParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(-params.radius), ew::Vec3(params.radius), params.radius);
+	}
+
+	bool emit(const SphereParams& params, ew::VertexSpan vertexSpan, ew::IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertexSpan, indexSpan))
+			return false;
+		float radius = params.radius;
+		int numSegments = params.numSegments < 1 ? 1 : params.numSegments;
 		int columns = numSegments + 1;
-		for (int row = 0; row < numSegments; row++)
+		//sin/cos per column and per row instead of per vertex
+		const ew::AngleTable theta(2 * ew::PI / numSegments, numSegments);
+		const ew::AngleTable phi(ew::PI / numSegments, numSegments);
+		ew::Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
+		ew::parallelFor(columns, threadCount, ew::procGenRowGrain(columns), [&](size_t begin, size_t end)
 		{
-			for (int col = 0; col < numSegments; col++)
+			for (int row = (int)begin; row < (int)end; row++)
 			{
-				int start = row * columns + col;
-				//Triangle 1
-				meshData.indices.push_back(start);
-				meshData.indices.push_back(start + 1);
-				meshData.indices.push_back(start + columns);
-				//Triangle 2
-				meshData.indices.push_back(start + columns);
-				meshData.indices.push_back(start + 1);
-				meshData.indices.push_back(start + columns + 1);
+				//SPHERE VERTICES
+				//First and last row converge at poles
+				ew::Vertex* v = vertices + (size_t)row * columns;
+				for (int col = 0; col <= numSegments; col++, v++) //Duplicate column for each row
+				{
+					v->normal = ew::Vec3(theta.cos[col] * phi.sin[row], phi.cos[row], theta.sin[col] * phi.sin[row]);
+					v->pos = v->normal * radius;
+					v->uv = ew::Vec2(((float)col / numSegments), ((1 - (float)row / numSegments)));
+				}
+				//SPHERE INDICES
+				if (row == numSegments)
+					continue;
+				unsigned int* index = indices + (size_t)row * numSegments * 6;
+				for (int col = 0; col < numSegments; col++)
+				{
+					unsigned int start = baseVertex + row * columns + col;
+					//Triangle 1
+					*index++ = start;
+					*index++ = start + 1;
+					*index++ = start + columns;
+					//Triangle 2
+					*index++ = start + columns;
+					*index++ = start + 1;
+					*index++ = start + columns + 1;
+				}
 			}
-		}
-		return meshData;
+		});
+		return true;
 	}
 
-	ew::MeshData createCylinder(float height, float radius, int numSegments)
+	ew::MeshData createSphere(float radius, int numSegments, unsigned int threadCount)
 	{
-		ew::Vertex v;
-		ew::MeshData meshData;
-		float thetaStep = 2 * ew::PI / numSegments;
+		SphereParams params;
+		params.radius = radius;
+		params.numSegments = numSegments;
+		return createMesh(params, threadCount);
+	}
 
-		//CYLINDER VERTICES
+	ew::MeshCounts queryCounts(const CylinderParams& params)
+	{
+		size_t numSegments = params.numSegments < 1 ? 1 : params.numSegments;
+		ew::MeshCounts counts;
+		//Two centers and four rings
+		counts.vertexCount = 2 + (numSegments + 1) * 4;
+		//Two fans of numSegments triangles and numSegments quads
+		counts.indexCount = numSegments * 12;
+		return counts;
+	}
+
+	ew::Bounds queryBounds(const CylinderParams& params)
+	{
+		float height = params.height;
+		float radius = params.radius;
+		return ew::makeBounds(ew::Vec3(-radius, -height / 2, -radius), ew::Vec3(radius, height / 2, radius), sqrt(radius * radius + height * height / 4));
+	}
+
+	bool emit(const CylinderParams& params, ew::VertexSpan vertexSpan, ew::IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertexSpan, indexSpan))
+			return false;
+		float height = params.height;
+		float radius = params.radius;
+		int numSegments = params.numSegments < 1 ? 1 : params.numSegments;
+		const ew::AngleTable theta(2 * ew::PI / numSegments, numSegments);
 
 		float topY = height / 2; //y = 0 is centered
 		float bottomY = -topY;
-		
-		#pragma region ring 1 top vertices
-			//Top center - Add top vertex(0, topY, 0);
-			v.pos = ew::Vec3(0, topY, 0);
-			v.normal = ew::Vec3(0, 1, 0); //up
-			v.uv = ew::Vec2(0.5f, 0.5f);
-			meshData.vertices.push_back(v);
-			//Top ring - Add top ring vertices
-			for (int i = 0; i <= numSegments; i++)
-			{
-				float theta = i * thetaStep;
-				float x = cos(theta) * radius;
-				float y = topY;
-				float z = sin(theta) * radius;
-				v.pos = ew::Vec3(x, y, z);
-				v.normal = ew::Vec3(0, 1, 0); //up
-				v.uv = ew::Vec2((x+1)/2,(z+1)/2);
-				meshData.vertices.push_back(v);
-			}
-			float sideStart = meshData.vertices.size();
-		#pragma endregion
 
-		#pragma region ring 1 side vertices
-			//Top ring - Add top ring vertices
-			for (int i = 0; i <= numSegments; i++)
-			{
-				float theta = i * thetaStep;
-				float x = cos(theta) * radius;
-				float y = topY;
-				float z = sin(theta) * radius;
-				v.pos = ew::Vec3(x, y, z);
-				v.normal = ew::Normalize(ew::Vec3(cos(theta), 0, sin(theta))); //out
-				v.uv = ew::Vec2(((float)i / numSegments), 1);
-				meshData.vertices.push_back(v);
-			}
-		#pragma endregion
+		//Top center, top ring, top side ring, bottom side ring, bottom ring, bottom center
+		unsigned int columns = numSegments + 1;
+		unsigned int topStart = 1;
+		unsigned int sideStart = topStart + columns;
+		unsigned int sideEnd = sideStart + columns * 2;
+		unsigned int bottomCenter = sideEnd + columns;
+		ew::Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
 
-		#pragma region ring 2 side vertices
-			//Bottom Ring - Add bottom ring vertices
-			for (int i = 0; i <= numSegments; i++)
-			{
-				float theta = i * thetaStep;
-				float x = cos(theta) * radius;
-				float y = bottomY;
-				float z = sin(theta) * radius;
-				v.pos = ew::Vec3(x, y, z);
-				v.normal = ew::Normalize(ew::Vec3(cos(theta), 0, sin(theta))); //out
-				v.uv = ew::Vec2(((float)i / numSegments), 0);
-				meshData.vertices.push_back(v);
-			}
-			float sideEnd = meshData.vertices.size();
+		//CYLINDER VERTICES
+		#pragma region center vertices
+			vertices[0].pos = ew::Vec3(0, topY, 0);
+			vertices[0].normal = ew::Vec3(0, 1, 0); //up
+			vertices[0].uv = ew::Vec2(0.5f, 0.5f);
+			vertices[bottomCenter].pos = ew::Vec3(0, bottomY, 0);
+			vertices[bottomCenter].normal = ew::Vec3(0, -1, 0); //down
+			vertices[bottomCenter].uv = ew::Vec2(0.5f, 0.5f);
 		#pragma endregion
 
-		#pragma region ring 2 bottom vertices
-			//Bottom Ring - Add bottom ring vertices
-			for (int i = 0; i <= numSegments; i++)
+		ew::parallelFor(columns, threadCount, 4096, [&](size_t begin, size_t end)
+		{
+			for (unsigned int i = (unsigned int)begin; i < (unsigned int)end; i++)
 			{
-				float theta = i * thetaStep;
-				float x = cos(theta) * radius;
-				float y = bottomY;
-				float z = sin(theta) * radius;
-				v.pos = ew::Vec3(x, y, z);
-				v.normal = ew::Vec3(0, 1, 0); //up
-				v.uv = ew::Vec2((x + 1) / 2, (z + 1) / 2);
-				meshData.vertices.push_back(v);
-			}
-			//Bottom Center - Add bottom vertex(0, bottomY, 0)
-			v.pos = ew::Vec3(0, bottomY, 0);
-			v.normal = ew::Vec3(0, -1, 0); //down
-			v.uv = ew::Vec2(0.5f, 0.5f);
-			meshData.vertices.push_back(v);
-		#pragma endregion
+				float x = theta.cos[i] * radius;
+				float z = theta.sin[i] * radius;
+				ew::Vec3 out = ew::Vec3(theta.cos[i], 0, theta.sin[i]);
 
-		//CYLINDER INDICES
-		
-		#pragma region ring 1 top indices
-			//Uses a triangle fan to connect ring to center
-			float start = 1;//Index of first ring vertex
-			float center = 0;//Index of center vertex
-			for (float i = 0; i <= numSegments; i++) 
-			{
-				meshData.indices.push_back(start + i);
-				meshData.indices.push_back(center);
-				meshData.indices.push_back(start + i + 1);
-			}
-		#pragma endregion
+				#pragma region ring vertices
+					ew::Vertex* v = &vertices[topStart + i];
+					v->pos = ew::Vec3(x, topY, z);
+					v->normal = ew::Vec3(0, 1, 0); //up
+					v->uv = ew::Vec2((x + 1) / 2, (z + 1) / 2);
 
-		#pragma region side indices
-			//Assumes bottom ring vertices have been added immediately after top ring
-			float columns = numSegments + 1;
-			for (int i = 0; i < columns; i++) 
-			{
-				start = sideStart + i;
-				//Triangle 1
-				meshData.indices.push_back(start);
-				meshData.indices.push_back(start + 1);
-				meshData.indices.push_back(start + columns);
-				//Triangle 2
-				meshData.indices.push_back(start + 1);
-				meshData.indices.push_back(start + columns + 1);
-				meshData.indices.push_back(start + columns);
-			}
-		#pragma endregion
+					v = &vertices[sideStart + i];
+					v->pos = ew::Vec3(x, topY, z);
+					v->normal = out;
+					v->uv = ew::Vec2(((float)i / numSegments), 1);
 
-		#pragma region ring 2 bottom indices
-			//Uses a triangle fan to connect ring to center
-			start = sideEnd;//Index of first ring vertex
-			center = meshData.vertices.size() - 1;//Index of center vertex
-			for (float i = 0; i <= numSegments; i++)
-			{
-				meshData.indices.push_back(center);
-				meshData.indices.push_back(start + i);
-				meshData.indices.push_back(start + i + 1);
+					v = &vertices[sideStart + columns + i];
+					v->pos = ew::Vec3(x, bottomY, z);
+					v->normal = out;
+					v->uv = ew::Vec2(((float)i / numSegments), 0);
+
+					v = &vertices[sideEnd + i];
+					v->pos = ew::Vec3(x, bottomY, z);
+					v->normal = ew::Vec3(0, -1, 0); //down
+					v->uv = ew::Vec2((x + 1) / 2, (z + 1) / 2);
+				#pragma endregion
+
+				//CYLINDER INDICES
+				if (i == (unsigned int)numSegments)
+					continue;
+
+				#pragma region ring 1 top indices
+					//Triangle fan connecting ring to center
+					unsigned int* index = indices + i * 3;
+					index[0] = baseVertex + topStart + i;
+					index[1] = baseVertex;
+					index[2] = baseVertex + topStart + i + 1;
+				#pragma endregion
+
+				#pragma region side indices
+					unsigned int start = baseVertex + sideStart + i;
+					index = indices + numSegments * 3 + i * 6;
+					//Triangle 1
+					index[0] = start;
+					index[1] = start + 1;
+					index[2] = start + columns;
+					//Triangle 2
+					index[3] = start + 1;
+					index[4] = start + columns + 1;
+					index[5] = start + columns;
+				#pragma endregion
+
+				#pragma region ring 2 bottom indices
+					index = indices + numSegments * 9 + i * 3;
+					index[0] = baseVertex + bottomCenter;
+					index[1] = baseVertex + sideEnd + i;
+					index[2] = baseVertex + sideEnd + i + 1;
+				#pragma endregion
 			}
-		#pragma endregion
+		});
+		return true;
+	}
 
-		return meshData;
+	ew::MeshData createCylinder(float height, float radius, int numSegments, unsigned int threadCount)
+	{
+		CylinderParams params;
+		params.height = height;
+		params.radius = radius;
+		params.numSegments = numSegments;
+		return createMesh(params, threadCount);
 	}
-}
\ No newline at end of file
+}
@@ -1,8 +1,44 @@
 #pragma once
 #include "../ew/mesh.h"
+#include "../ew/procGen.h"
 namespace bob 
 {
-	ew::MeshData createPlane(float width, float height, int subdivisions);
-	ew::MeshData createSphere(float radius, int numSegments);
-	ew::MeshData createCylinder(float height, float radius, int numSegments);
-}
+	//Sizes are computed up front and rows are filled in parallel on threadCount threads (0 = one per hardware thread)
+	ew::MeshData createPlane(float width, float height, int subdivisions, unsigned int threadCount = 0);
+	ew::MeshData createSphere(float radius, int numSegments, unsigned int threadCount = 0);
+	ew::MeshData createCylinder(float height, float radius, int numSegments, unsigned int threadCount = 0);
+
+	//Two phase versions of the above, same as ew::queryCounts/ew::emit (see ew/procGen.h).
+	//Bump a struct's VERSION whenever its generator's output changes, like the ew params.
+	struct PlaneParams
+	{
+		static constexpr unsigned int VERSION = 1;
+		float width = 1.0f;
+		float height = 1.0f;
+		int subdivisions = 1;
+	};
+	struct SphereParams
+	{
+		static constexpr unsigned int VERSION = 1;
+		float radius = 1.0f;
+		int numSegments = 16;
+	};
+	struct CylinderParams
+	{
+		static constexpr unsigned int VERSION = 1;
+		float height = 1.0f;
+		float radius = 1.0f;
+		int numSegments = 16;
+	};
+
+	ew::MeshCounts queryCounts(const PlaneParams& params);
+	ew::MeshCounts queryCounts(const SphereParams& params);
+	ew::MeshCounts queryCounts(const CylinderParams& params);
+	ew::Bounds queryBounds(const PlaneParams& params);
+	ew::Bounds queryBounds(const SphereParams& params);
+	ew::Bounds queryBounds(const CylinderParams& params);
+	//Returns false, writing nothing, if a span is smaller than queryCounts(params). baseVertex is added to every index.
+	bool emit(const PlaneParams& params, ew::VertexSpan vertices, ew::IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+	bool emit(const SphereParams& params, ew::VertexSpan vertices, ew::IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+	bool emit(const CylinderParams& params, ew::VertexSpan vertices, ew::IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+}
\ No newline at end of file
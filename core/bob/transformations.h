@@ -2,6 +2,7 @@
 #include "../ew/ewMath/mat4.h"
 #include "../ew/ewMath/vec3.h"
 #include "../ew/ewMath/ewMath.h"
+#include "../ew/transform.h"
 namespace bob {
 	//Identity matrix
 	inline ew::Mat4 Identity() {
@@ -57,19 +58,9 @@ namespace bob {
 			0, 0, 0, 1
 		);
 	};
-	struct Transform {
-		ew::Vec3 position = ew::Vec3(0.0f, 0.0f, 0.0f);
-		ew::Vec3 rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (degrees)
-		ew::Vec3 scale = ew::Vec3(1.0f, 1.0f, 1.0f);
-		ew::Mat4 getModelMatrix() const {
-			return 
-				Translate(position) *
-				RotateY(ew::Radians(rotation.y)) *
-				RotateX(ew::Radians(rotation.x)) *
-				RotateZ(ew::Radians(rotation.z)) *
-					Scale(scale);
-		}
-	};
+	//Same fields and rotation order as the old bob::Transform.
+	//ew::Transform builds the matrix in closed form and caches it between frames.
+	using Transform = ew::Transform;
 
 	//Creates a right handed view space
 	//eye = eye (camera) position
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace ew {
+	/// <summary>
+	/// std::vector allocator that aligns storage for SIMD loads (32 bytes = one AVX register)
+	/// </summary>
+	template<typename T, size_t Alignment = 32>
+	struct AlignedAllocator {
+		using value_type = T;
+		template<typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+		AlignedAllocator() = default;
+		template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+		T* allocate(size_t n) {
+			if (n == 0)
+				return nullptr;
+#if defined(_MSC_VER)
+			void* p = _aligned_malloc(n * sizeof(T), Alignment);
+#else
+			void* p = nullptr;
+			if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0)
+				p = nullptr;
+#endif
+			if (!p)
+				throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+		void deallocate(T* p, size_t) {
+#if defined(_MSC_VER)
+			_aligned_free(p);
+#else
+			free(p);
+#endif
+		}
+		template<typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+		template<typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+	};
+
+	template<typename T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+}
@@ -0,0 +1,136 @@
+#include "bounds.h"
+#include "mesh.h"
+#include "ewMath/simd.h"
+#include <cstddef>
+
+#if EW_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace ew {
+	namespace {
+		float absf(float x) {
+			return x < 0.0f ? -x : x;
+		}
+
+#if EW_SIMD_X86
+		//Vertex.pos is followed by normal, so a 4 wide load reads pos + one garbage lane that is never used
+		static_assert(offsetof(Vertex, pos) + sizeof(float) * 4 <= sizeof(Vertex), "Vertex layout");
+
+		void minMaxSSE(const Vertex* vertices, size_t count, ew::Vec3* outMin, ew::Vec3* outMax) {
+			__m128 min0 = _mm_loadu_ps(&vertices[0].pos.x), max0 = min0;
+			__m128 min1 = min0, max1 = min0;
+			size_t i = 0;
+			//Two independent accumulators to hide min/max latency
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128 a = _mm_loadu_ps(&vertices[i].pos.x);
+				const __m128 b = _mm_loadu_ps(&vertices[i + 1].pos.x);
+				min0 = _mm_min_ps(min0, a); max0 = _mm_max_ps(max0, a);
+				min1 = _mm_min_ps(min1, b); max1 = _mm_max_ps(max1, b);
+			}
+			for (; i < count; i++)
+			{
+				const __m128 a = _mm_loadu_ps(&vertices[i].pos.x);
+				min0 = _mm_min_ps(min0, a); max0 = _mm_max_ps(max0, a);
+			}
+			alignas(16) float mn[4], mx[4];
+			_mm_store_ps(mn, _mm_min_ps(min0, min1));
+			_mm_store_ps(mx, _mm_max_ps(max0, max1));
+			*outMin = ew::Vec3(mn[0], mn[1], mn[2]);
+			*outMax = ew::Vec3(mx[0], mx[1], mx[2]);
+		}
+
+		float maxDistanceSqSSE(const Vertex* vertices, size_t count, const ew::Vec3& center) {
+			const __m128 c = _mm_setr_ps(center.x, center.y, center.z, 0.0f);
+			//Zeroes the garbage lane before summing
+			const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+			__m128 best = _mm_setzero_ps();
+			for (size_t i = 0; i < count; i++)
+			{
+				__m128 d = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(&vertices[i].pos.x), c), xyzMask);
+				d = _mm_mul_ps(d, d);
+				//Horizontal sum into every lane
+				d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)));
+				d = _mm_add_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 3, 2)));
+				best = _mm_max_ps(best, d);
+			}
+			return _mm_cvtss_f32(best);
+		}
+#endif
+	}
+
+	Bounds computeBounds(const Vertex* vertices, size_t count)
+	{
+		Bounds bounds;
+		if (count == 0)
+			return bounds;
+		AABB& box = bounds.box;
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::SSE) {
+			minMaxSSE(vertices, count, &box.min, &box.max);
+			bounds.sphere.center = box.center();
+			bounds.sphere.radius = sqrtf(maxDistanceSqSSE(vertices, count, bounds.sphere.center));
+			return bounds;
+		}
+#endif
+		box.min = box.max = vertices[0].pos;
+		for (size_t i = 1; i < count; i++)
+		{
+			const ew::Vec3& p = vertices[i].pos;
+			box.min = ew::Vec3(fminf(box.min.x, p.x), fminf(box.min.y, p.y), fminf(box.min.z, p.z));
+			box.max = ew::Vec3(fmaxf(box.max.x, p.x), fmaxf(box.max.y, p.y), fmaxf(box.max.z, p.z));
+		}
+		bounds.sphere.center = box.center();
+		float maxDistSq = 0.0f;
+		for (size_t i = 0; i < count; i++)
+		{
+			const ew::Vec3 d = vertices[i].pos - bounds.sphere.center;
+			maxDistSq = maxf(maxDistSq, ew::Dot(d, d));
+		}
+		bounds.sphere.radius = sqrtf(maxDistSq);
+		return bounds;
+	}
+
+	AABB transformAABB(const AABB& box, const ew::Mat4& m)
+	{
+		const ew::Vec3 c = box.center();
+		const ew::Vec3 e = box.extents();
+		//Each world axis gets the center's position plus the box's extents projected onto it
+		auto centerRow = [&](int row) { return m.at(0, row) * c.x + m.at(1, row) * c.y + m.at(2, row) * c.z + m.at(3, row); };
+		auto extentRow = [&](int row) { return absf(m.at(0, row)) * e.x + absf(m.at(1, row)) * e.y + absf(m.at(2, row)) * e.z; };
+		const ew::Vec3 newCenter = ew::Vec3(centerRow(0), centerRow(1), centerRow(2));
+		const ew::Vec3 newExtents = ew::Vec3(extentRow(0), extentRow(1), extentRow(2));
+		AABB out;
+		out.min = newCenter - newExtents;
+		out.max = newCenter + newExtents;
+		return out;
+	}
+
+	BoundingSphere transformSphere(const BoundingSphere& sphere, const ew::Mat4& m)
+	{
+		const ew::Vec3& c = sphere.center;
+		BoundingSphere out;
+		out.center = ew::Vec3(
+			m.at(0, 0) * c.x + m.at(1, 0) * c.y + m.at(2, 0) * c.z + m.at(3, 0),
+			m.at(0, 1) * c.x + m.at(1, 1) * c.y + m.at(2, 1) * c.z + m.at(3, 1),
+			m.at(0, 2) * c.x + m.at(1, 2) * c.y + m.at(2, 2) * c.z + m.at(3, 2));
+		//Largest axis scale, so non-uniform scale still encloses the mesh
+		float maxScaleSq = 0.0f;
+		for (int col = 0; col < 3; col++)
+		{
+			const ew::Vec3 axis = ew::Vec3(m.at(col, 0), m.at(col, 1), m.at(col, 2));
+			maxScaleSq = maxf(maxScaleSq, ew::Dot(axis, axis));
+		}
+		out.radius = sphere.radius * sqrtf(maxScaleSq);
+		return out;
+	}
+
+	Bounds transformBounds(const Bounds& bounds, const ew::Mat4& m)
+	{
+		Bounds out;
+		out.box = transformAABB(bounds.box, m);
+		out.sphere = transformSphere(bounds.sphere, m);
+		return out;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "ewMath/ewMath.h"
+
+namespace ew {
+	struct Vertex;
+
+	//Axis aligned bounding box
+	struct AABB {
+		ew::Vec3 min = ew::Vec3(0.0f);
+		ew::Vec3 max = ew::Vec3(0.0f);
+		inline ew::Vec3 center()const { return (min + max) * 0.5f; }
+		inline ew::Vec3 extents()const { return (max - min) * 0.5f; }
+	};
+
+	struct BoundingSphere {
+		ew::Vec3 center = ew::Vec3(0.0f);
+		float radius = 0.0f;
+	};
+
+	struct Ray {
+		ew::Vec3 origin = ew::Vec3(0.0f);
+		ew::Vec3 direction = ew::Vec3(0.0f, 0.0f, -1.0f); //Unit length
+	};
+
+	//Local space bounds of a mesh
+	struct Bounds {
+		AABB box;
+		BoundingSphere sphere;
+	};
+
+	//Bounds from a known box, e.g. a procedural shape. The sphere is centered on the box
+	//with the given radius, or the half diagonal when none is given.
+	inline Bounds makeBounds(const ew::Vec3& min, const ew::Vec3& max, float radius) {
+		Bounds b;
+		b.box.min = min;
+		b.box.max = max;
+		b.sphere.center = b.box.center();
+		b.sphere.radius = radius;
+		return b;
+	}
+	inline Bounds makeBounds(const ew::Vec3& min, const ew::Vec3& max) {
+		return makeBounds(min, max, ew::Magnitude((max - min) * 0.5f));
+	}
+
+	/// <summary>
+	/// Computes an AABB and a bounding sphere from vertex positions.
+	/// The sphere is centered on the box and reaches the furthest vertex, which is tighter than the box's corner.
+	/// Uses SSE when available.
+	/// </summary>
+	Bounds computeBounds(const Vertex* vertices, size_t count);
+
+	//Compile to single min/max instructions, unlike fminf/fmaxf which also handle NaN
+	inline float minf(float a, float b) { return a < b ? a : b; }
+	inline float maxf(float a, float b) { return a > b ? a : b; }
+
+	/// <summary>
+	/// Slab test. invDirection is 1/ray.direction per axis (infinite for zero components is fine).
+	/// </summary>
+	/// <param name="tHit">Entry distance along the ray, or tMin if the origin is inside the box</param>
+	/// <returns>True if the ray overlaps the box between tMin and tMax</returns>
+	inline bool intersectRayAABB(const ew::Vec3& origin, const ew::Vec3& invDirection, const AABB& box, float tMin, float tMax, float* tHit) {
+		const float tx1 = (box.min.x - origin.x) * invDirection.x, tx2 = (box.max.x - origin.x) * invDirection.x;
+		const float ty1 = (box.min.y - origin.y) * invDirection.y, ty2 = (box.max.y - origin.y) * invDirection.y;
+		const float tz1 = (box.min.z - origin.z) * invDirection.z, tz2 = (box.max.z - origin.z) * invDirection.z;
+		tMin = maxf(tMin, maxf(minf(tx1, tx2), maxf(minf(ty1, ty2), minf(tz1, tz2))));
+		tMax = minf(tMax, minf(maxf(tx1, tx2), minf(maxf(ty1, ty2), maxf(tz1, tz2))));
+		*tHit = tMin;
+		return tMin <= tMax;
+	}
+
+	//Smallest box containing both
+	inline AABB combineAABB(const AABB& a, const AABB& b) {
+		AABB out;
+		out.min = ew::Vec3(minf(a.min.x, b.min.x), minf(a.min.y, b.min.y), minf(a.min.z, b.min.z));
+		out.max = ew::Vec3(maxf(a.max.x, b.max.x), maxf(a.max.y, b.max.y), maxf(a.max.z, b.max.z));
+		return out;
+	}
+
+	/// <summary>
+	/// Bounds of a box and sphere after being transformed by an affine matrix. Only touches the 8 numbers
+	/// stored, not the vertices. The box stays axis aligned, so it grows under rotation (Arvo's method).
+	/// </summary>
+	AABB transformAABB(const AABB& box, const ew::Mat4& m);
+	BoundingSphere transformSphere(const BoundingSphere& sphere, const ew::Mat4& m);
+	Bounds transformBounds(const Bounds& bounds, const ew::Mat4& m);
+}
@@ -0,0 +1,347 @@
+#include "bvh.h"
+#include <algorithm>
+#include <float.h>
+
+namespace ew {
+	namespace {
+		constexpr int BIN_COUNT = 16;
+
+		struct Bin {
+			AABB bounds;
+			unsigned int count = 0;
+		};
+
+		enum class Overlap { OUTSIDE, INTERSECTING, INSIDE };
+
+		AABB emptyAABB() {
+			AABB b;
+			b.min = ew::Vec3(FLT_MAX);
+			b.max = ew::Vec3(-FLT_MAX);
+			return b;
+		}
+		float surfaceArea(const AABB& b) {
+			const ew::Vec3 d = b.max - b.min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+		float axis(const ew::Vec3& v, int a) {
+			return a == 0 ? v.x : (a == 1 ? v.y : v.z);
+		}
+		bool overlaps(const AABB& a, const AABB& b) {
+			return a.min.x <= b.max.x && a.max.x >= b.min.x
+				&& a.min.y <= b.max.y && a.max.y >= b.min.y
+				&& a.min.z <= b.max.z && a.max.z >= b.min.z;
+		}
+		//Like Frustum::intersectsAABB, but also reports boxes that are entirely inside
+		//so whole subtrees can be accepted without testing
+		Overlap classify(const Frustum& frustum, const AABB& box) {
+			const ew::Vec3 c = box.center();
+			const ew::Vec3 e = box.extents();
+			Overlap result = Overlap::INSIDE;
+			for (int i = 0; i < 6; i++)
+			{
+				const Plane& p = frustum.planes[i];
+				const float r = e.x * fabsf(p.normal.x) + e.y * fabsf(p.normal.y) + e.z * fabsf(p.normal.z);
+				const float d = p.distance(c);
+				if (d + r < 0.0f)
+					return Overlap::OUTSIDE;
+				if (d - r < 0.0f)
+					result = Overlap::INTERSECTING;
+			}
+			return result;
+		}
+	}
+
+	void BVH::build(const AABB* bounds, size_t count, unsigned int maxLeafSize)
+	{
+		clear();
+		if (count == 0)
+			return;
+		if (maxLeafSize < 1)
+			maxLeafSize = 1;
+
+		m_objectBounds.assign(bounds, bounds + count);
+		m_objectOrder.resize(count);
+		std::vector<ew::Vec3> centers(count);
+		BVHNode root;
+		root.bounds = emptyAABB();
+		for (size_t i = 0; i < count; i++)
+		{
+			m_objectOrder[i] = (unsigned int)i;
+			centers[i] = bounds[i].center();
+			root.bounds = combineAABB(root.bounds, bounds[i]);
+		}
+		root.first = 0;
+		root.count = (unsigned int)count;
+		m_nodes.reserve(count * 2 - 1);
+		m_nodes.push_back(root);
+
+		//Explicit stack, since degenerate inputs can make the tree deep
+		std::vector<unsigned int> stack;
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			const unsigned int nodeIndex = stack.back();
+			stack.pop_back();
+			const BVHNode node = m_nodes[nodeIndex];
+			if (node.count <= maxLeafSize)
+				continue;
+
+			//Bin by object centers, since those decide which side an object goes to
+			AABB centerBounds = emptyAABB();
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				const ew::Vec3& c = centers[m_objectOrder[i]];
+				AABB point;
+				point.min = point.max = c;
+				centerBounds = combineAABB(centerBounds, point);
+			}
+
+			float bestCost = FLT_MAX;
+			int bestAxis = -1;
+			int bestBin = 0;
+			AABB bestLeft, bestRight;
+			unsigned int bestLeftCount = 0;
+			for (int a = 0; a < 3; a++)
+			{
+				const float lo = axis(centerBounds.min, a);
+				const float extent = axis(centerBounds.max, a) - lo;
+				if (extent <= 0.0f)
+					continue;
+				const float scale = BIN_COUNT / extent;
+
+				Bin bins[BIN_COUNT];
+				for (int b = 0; b < BIN_COUNT; b++)
+					bins[b].bounds = emptyAABB();
+				for (unsigned int i = node.first; i < node.first + node.count; i++)
+				{
+					const unsigned int object = m_objectOrder[i];
+					const int b = std::min(BIN_COUNT - 1, (int)((axis(centers[object], a) - lo) * scale));
+					bins[b].count++;
+					bins[b].bounds = combineAABB(bins[b].bounds, m_objectBounds[object]);
+				}
+
+				//Sweep from the right so each split plane can be scored in one pass from the left
+				AABB rightBounds[BIN_COUNT - 1];
+				unsigned int rightCount[BIN_COUNT - 1];
+				AABB accum = emptyAABB();
+				unsigned int accumCount = 0;
+				for (int b = BIN_COUNT - 1; b > 0; b--)
+				{
+					accum = combineAABB(accum, bins[b].bounds);
+					accumCount += bins[b].count;
+					rightBounds[b - 1] = accum;
+					rightCount[b - 1] = accumCount;
+				}
+				accum = emptyAABB();
+				accumCount = 0;
+				for (int b = 0; b < BIN_COUNT - 1; b++)
+				{
+					accum = combineAABB(accum, bins[b].bounds);
+					accumCount += bins[b].count;
+					if (accumCount == 0 || rightCount[b] == 0)
+						continue;
+					const float cost = accumCount * surfaceArea(accum) + rightCount[b] * surfaceArea(rightBounds[b]);
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = a;
+						bestBin = b;
+						bestLeft = accum;
+						bestRight = rightBounds[b];
+						bestLeftCount = accumCount;
+					}
+				}
+			}
+			//All centers coincide, nothing to split on
+			if (bestAxis < 0)
+				continue;
+
+			const float lo = axis(centerBounds.min, bestAxis);
+			const float scale = BIN_COUNT / (axis(centerBounds.max, bestAxis) - lo);
+			unsigned int* begin = m_objectOrder.data() + node.first;
+			std::partition(begin, begin + node.count, [&](unsigned int object) {
+				return std::min(BIN_COUNT - 1, (int)((axis(centers[object], bestAxis) - lo) * scale)) <= bestBin;
+			});
+
+			BVHNode left, right;
+			left.bounds = bestLeft;
+			left.first = node.first;
+			left.count = bestLeftCount;
+			right.bounds = bestRight;
+			right.first = node.first + bestLeftCount;
+			right.count = node.count - bestLeftCount;
+
+			const unsigned int leftIndex = (unsigned int)m_nodes.size();
+			m_nodes.push_back(left);
+			m_nodes.push_back(right);
+			m_nodes[nodeIndex].first = leftIndex;
+			m_nodes[nodeIndex].count = 0;
+			stack.push_back(leftIndex);
+			stack.push_back(leftIndex + 1);
+		}
+	}
+
+	void BVH::refit(const AABB* bounds)
+	{
+		m_objectBounds.assign(bounds, bounds + m_objectBounds.size());
+		//Children are always stored after their parent, so walking backwards updates them first
+		for (size_t i = m_nodes.size(); i-- > 0;)
+		{
+			BVHNode& node = m_nodes[i];
+			if (node.isLeaf()) {
+				AABB b = emptyAABB();
+				for (unsigned int j = node.first; j < node.first + node.count; j++)
+					b = combineAABB(b, m_objectBounds[m_objectOrder[j]]);
+				node.bounds = b;
+			}
+			else {
+				node.bounds = combineAABB(m_nodes[node.first].bounds, m_nodes[node.first + 1].bounds);
+			}
+		}
+	}
+
+	void BVH::clear()
+	{
+		m_nodes.clear();
+		m_objectOrder.clear();
+		m_objectBounds.clear();
+	}
+
+	void BVH::appendAll(unsigned int node, std::vector<unsigned int>* results) const
+	{
+		std::vector<unsigned int> stack;
+		stack.push_back(node);
+		while (!stack.empty())
+		{
+			const BVHNode& n = m_nodes[stack.back()];
+			stack.pop_back();
+			if (n.isLeaf()) {
+				results->insert(results->end(), m_objectOrder.begin() + n.first, m_objectOrder.begin() + n.first + n.count);
+			}
+			else {
+				stack.push_back(n.first);
+				stack.push_back(n.first + 1);
+			}
+		}
+	}
+
+	void BVH::queryFrustum(const Frustum& frustum, std::vector<unsigned int>* results) const
+	{
+		if (m_nodes.empty())
+			return;
+		std::vector<unsigned int> stack;
+		stack.reserve(64);
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			const unsigned int nodeIndex = stack.back();
+			stack.pop_back();
+			const BVHNode& node = m_nodes[nodeIndex];
+			const Overlap overlap = classify(frustum, node.bounds);
+			if (overlap == Overlap::OUTSIDE)
+				continue;
+			if (overlap == Overlap::INSIDE) {
+				appendAll(nodeIndex, results);
+				continue;
+			}
+			if (node.isLeaf()) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++)
+				{
+					const AABB& b = m_objectBounds[m_objectOrder[i]];
+					if (frustum.intersectsAABB(b.min, b.max))
+						results->push_back(m_objectOrder[i]);
+				}
+			}
+			else {
+				stack.push_back(node.first);
+				stack.push_back(node.first + 1);
+			}
+		}
+	}
+
+	void BVH::queryAABB(const AABB& box, std::vector<unsigned int>* results) const
+	{
+		if (m_nodes.empty())
+			return;
+		std::vector<unsigned int> stack;
+		stack.reserve(64);
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			const BVHNode& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!overlaps(node.bounds, box))
+				continue;
+			if (node.isLeaf()) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++)
+				{
+					if (overlaps(m_objectBounds[m_objectOrder[i]], box))
+						results->push_back(m_objectOrder[i]);
+				}
+			}
+			else {
+				stack.push_back(node.first);
+				stack.push_back(node.first + 1);
+			}
+		}
+	}
+
+	bool BVH::raycast(const Ray& ray, RayHit* hit, float maxDistance) const
+	{
+		return raycast(ray, hit, nullptr, maxDistance);
+	}
+
+	bool BVH::raycast(const Ray& ray, RayHit* hit, const std::function<bool(unsigned int index, const Ray& ray, float* distance)>& intersect, float maxDistance) const
+	{
+		if (m_nodes.empty())
+			return false;
+		const ew::Vec3 invDir = ew::Vec3(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+		float best = maxDistance;
+		bool found = false;
+		float t;
+
+		std::vector<unsigned int> stack;
+		stack.reserve(64);
+		if (intersectRayAABB(ray.origin, invDir, m_nodes[0].bounds, 0.0f, best, &t))
+			stack.push_back(0);
+		while (!stack.empty())
+		{
+			const BVHNode& node = m_nodes[stack.back()];
+			stack.pop_back();
+			//Re-test, since a closer hit may have been found after this node was pushed
+			if (!intersectRayAABB(ray.origin, invDir, node.bounds, 0.0f, best, &t))
+				continue;
+			if (node.isLeaf()) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++)
+				{
+					const unsigned int object = m_objectOrder[i];
+					if (!intersectRayAABB(ray.origin, invDir, m_objectBounds[object], 0.0f, best, &t))
+						continue;
+					if (intersect && !(intersect(object, ray, &t) && t >= 0.0f && t < best))
+						continue;
+					best = t;
+					hit->index = object;
+					hit->distance = t;
+					found = true;
+				}
+				continue;
+			}
+			//Visit the nearer child first so the far one is more likely to be culled
+			float tLeft, tRight;
+			const bool hitLeft = intersectRayAABB(ray.origin, invDir, m_nodes[node.first].bounds, 0.0f, best, &tLeft);
+			const bool hitRight = intersectRayAABB(ray.origin, invDir, m_nodes[node.first + 1].bounds, 0.0f, best, &tRight);
+			const unsigned int leftIndex = node.first;
+			if (hitLeft && hitRight) {
+				const bool leftFirst = tLeft <= tRight;
+				stack.push_back(leftFirst ? leftIndex + 1 : leftIndex);
+				stack.push_back(leftFirst ? leftIndex : leftIndex + 1);
+			}
+			else if (hitLeft) {
+				stack.push_back(leftIndex);
+			}
+			else if (hitRight) {
+				stack.push_back(leftIndex + 1);
+			}
+		}
+		return found;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include "bounds.h"
+#include "culling.h"
+
+namespace ew {
+	//32 bytes. Leaves reference count objects starting at first in BVH::getObjectOrder(),
+	//interior nodes (count == 0) have their two children at first and first + 1.
+	struct BVHNode {
+		AABB bounds;
+		unsigned int first = 0;
+		unsigned int count = 0;
+		inline bool isLeaf()const { return count > 0; }
+	};
+
+	struct RayHit {
+		unsigned int index = 0; //Object index as passed to build()
+		float distance = 0.0f; //Along the ray
+	};
+
+	/// <summary>
+	/// Bounding volume hierarchy over world space object bounds, e.g. mesh.getWorldBounds(transform.getModelMatrix()).box.
+	/// Object indices are the positions of the boxes in the array passed to build().
+	/// </summary>
+	class BVH {
+	public:
+		/// <summary>
+		/// Builds the tree top down, choosing each split with a binned surface area heuristic.
+		/// </summary>
+		/// <param name="maxLeafSize">Leaves never hold more objects than this, unless their centers all coincide</param>
+		void build(const AABB* bounds, size_t count, unsigned int maxLeafSize = 4);
+		/// <summary>
+		/// Updates the node bounds for objects that moved, keeping the tree structure. Much cheaper than build(),
+		/// but queries slow down as objects drift far from where they were at build time. Rebuild then.
+		/// </summary>
+		/// <param name="bounds">Same count and order as the last build</param>
+		void refit(const AABB* bounds);
+		void clear();
+
+		//Appends the indices of objects whose boxes intersect the frustum
+		void queryFrustum(const Frustum& frustum, std::vector<unsigned int>* results)const;
+		//Appends the indices of objects whose boxes overlap the box
+		void queryAABB(const AABB& box, std::vector<unsigned int>* results)const;
+		/// <summary>
+		/// Finds the closest object box hit by the ray.
+		/// </summary>
+		/// <returns>False if nothing was hit within maxDistance</returns>
+		bool raycast(const Ray& ray, RayHit* hit, float maxDistance = INFINITY)const;
+		/// <summary>
+		/// Same as raycast, but candidates whose box is hit are passed to intersect for an exact test
+		/// (e.g. against the bounding sphere or triangles). It returns true and the distance on a hit.
+		/// </summary>
+		bool raycast(const Ray& ray, RayHit* hit, const std::function<bool(unsigned int index, const Ray& ray, float* distance)>& intersect,
+			float maxDistance = INFINITY)const;
+
+		inline size_t getObjectCount()const { return m_objectBounds.size(); }
+		inline const std::vector<BVHNode>& getNodes()const { return m_nodes; }
+		inline const std::vector<unsigned int>& getObjectOrder()const { return m_objectOrder; }
+	private:
+		//Appends every object under node without testing
+		void appendAll(unsigned int node, std::vector<unsigned int>* results)const;
+
+		std::vector<BVHNode> m_nodes;
+		std::vector<unsigned int> m_objectOrder;
+		std::vector<AABB> m_objectBounds;
+	};
+}
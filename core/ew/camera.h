@@ -1,6 +1,7 @@
 #pragma once
 #include "ewMath/transformations.h"
 #include "ewMath/ewMath.h"
+#include "bounds.h"
 namespace ew {
 
 	struct Camera {
@@ -26,6 +27,18 @@ namespace ew {
 				return ew::Perspective(ew::Radians(fov), aspectRatio, nearPlane, farPlane);
 			}
 		}
+		//Ray from the near plane through a point in normalized device coordinates (-1 to 1, +y up)
+		inline ew::Ray ScreenPointToRay(float ndcX, float ndcY)const {
+			const ew::Mat4 invViewProj = ew::Inverse(ProjectionMatrix() * ViewMatrix());
+			ew::Vec4 nearPoint = invViewProj * ew::Vec4(ndcX, ndcY, -1.0f, 1.0f);
+			ew::Vec4 farPoint = invViewProj * ew::Vec4(ndcX, ndcY, 1.0f, 1.0f);
+			const ew::Vec3 a = nearPoint.toVec3() / nearPoint.w;
+			const ew::Vec3 b = farPoint.toVec3() / farPoint.w;
+			ew::Ray ray;
+			ray.origin = a;
+			ray.direction = ew::Normalize(b - a);
+			return ray;
+		}
 	};
 
 }
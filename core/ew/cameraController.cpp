@@ -75,4 +75,14 @@ namespace ew {
 			camera->target = camera->position + forward;
 		}
 	}
+	ew::Ray CameraController::MouseRay(GLFWwindow* window, const ew::Camera& camera) const {
+		double mouseX, mouseY;
+		glfwGetCursorPos(window, &mouseX, &mouseY);
+		int width, height;
+		glfwGetWindowSize(window, &width, &height);
+		//Cursor is in screen coordinates from the top left
+		float ndcX = (float)(mouseX / width) * 2.0f - 1.0f;
+		float ndcY = 1.0f - (float)(mouseY / height) * 2.0f;
+		return camera.ScreenPointToRay(ndcX, ndcY);
+	}
 }
\ No newline at end of file
@@ -15,5 +15,7 @@ namespace ew {
 
 		//Using input from window, aim and rotate camera
 		void Move(GLFWwindow* window, ew::Camera* camera, float deltaTime);
+		//World space ray under the mouse cursor, for picking (see ew::BVH::raycast)
+		ew::Ray MouseRay(GLFWwindow* window, const ew::Camera& camera)const;
 	};
 }
\ No newline at end of file
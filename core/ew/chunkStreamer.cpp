@@ -0,0 +1,310 @@
+#include "chunkStreamer.h"
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+namespace ew {
+	namespace {
+		//Generated or staged chunks this far out (in chunk sizes, beyond loadRadius) are dropped instead of uploaded.
+		//The margin keeps a camera hovering at the edge from throwing away work.
+		constexpr float DROP_MARGIN = 1.0f;
+
+		struct MissingChunk {
+			float distanceSquared;
+			ChunkCoord coord;
+		};
+	}
+
+	ChunkStreamer::ChunkStreamer(MeshPool& pool, ChunkGenerator generator, const ChunkStreamerSettings& settings)
+		: m_pool(pool), m_generator(std::move(generator)), m_settings(settings)
+	{
+		if (m_settings.chunkSize <= 0.0f)
+			m_settings.chunkSize = 1.0f;
+		m_workers.reset(new WorkerPool(m_settings.workerCount));
+		if (m_settings.maxJobsInFlight == 0)
+			m_settings.maxJobsInFlight = m_workers->getThreadCount() * 2;
+	}
+
+	ChunkStreamer::~ChunkStreamer()
+	{
+		//Stop the workers before anything they write to goes away
+		m_workers.reset();
+		for (auto& it : m_chunks) {
+			if (it.second.handle >= 0)
+				m_pool.remove(it.second.handle);
+		}
+	}
+
+	uint64_t ChunkStreamer::chunkKey(ChunkCoord coord)
+	{
+		return ((uint64_t)(uint32_t)coord.x << 32) | (uint64_t)(uint32_t)coord.z;
+	}
+
+	ChunkCoord ChunkStreamer::chunkAt(const ew::Vec3& position)const
+	{
+		ChunkCoord coord;
+		coord.x = (int)floorf(position.x / m_settings.chunkSize);
+		coord.z = (int)floorf(position.z / m_settings.chunkSize);
+		return coord;
+	}
+
+	float ChunkStreamer::distanceSquared(ChunkCoord coord, const ew::Vec3& cameraPosition)const
+	{
+		const float dx = (float)coord.x + 0.5f - cameraPosition.x / m_settings.chunkSize;
+		const float dz = (float)coord.z + 0.5f - cameraPosition.z / m_settings.chunkSize;
+		return dx * dx + dz * dz;
+	}
+
+	void ChunkStreamer::update(const ew::Vec3& cameraPosition)
+	{
+		m_frame++;
+		m_stats.bytesUploaded = 0;
+		m_stats.chunksEvicted = 0;
+
+		requestChunks(cameraPosition);
+		stageCompleted(cameraPosition);
+		uploadStaged(cameraPosition);
+		while (m_lru.size() > m_settings.maxResidentChunks && evictOne()) {}
+
+		m_stats.residentChunks = m_lru.size();
+		m_stats.generatingChunks = m_generating;
+		m_stats.stagedChunks = m_staged.size() + (m_uploading ? 1 : 0);
+	}
+
+	void ChunkStreamer::requestChunks(const ew::Vec3& cameraPosition)
+	{
+		const float radiusSquared = m_settings.loadRadius * m_settings.loadRadius;
+		//Centers within the radius are at most radius + 1 chunks from the camera's chunk
+		const int reach = (int)ceilf(m_settings.loadRadius) + 1;
+		const ChunkCoord center = chunkAt(cameraPosition);
+		std::vector<MissingChunk> missing;
+		for (int dz = -reach; dz <= reach; dz++)
+		{
+			for (int dx = -reach; dx <= reach; dx++)
+			{
+				ChunkCoord coord;
+				coord.x = center.x + dx;
+				coord.z = center.z + dz;
+				const float d2 = distanceSquared(coord, cameraPosition);
+				if (d2 > radiusSquared)
+					continue;
+				auto it = m_chunks.find(chunkKey(coord));
+				if (it == m_chunks.end()) {
+					missing.push_back({ d2, coord });
+					continue;
+				}
+				Chunk& chunk = it->second;
+				chunk.lastUsedFrame = m_frame;
+				if (chunk.state == ChunkState::Resident)
+					m_lru.splice(m_lru.begin(), m_lru, chunk.lruPosition);
+			}
+		}
+
+		//Nearest first, as many as the job limit allows. The rest are picked up on later frames.
+		if (missing.empty() || m_generating >= m_settings.maxJobsInFlight)
+			return;
+		std::sort(missing.begin(), missing.end(), [](const MissingChunk& a, const MissingChunk& b) {
+			return a.distanceSquared < b.distanceSquared;
+		});
+		for (size_t i = 0; i < missing.size() && m_generating < m_settings.maxJobsInFlight; i++)
+		{
+			const ChunkCoord coord = missing[i].coord;
+			const uint64_t key = chunkKey(coord);
+			Chunk& chunk = m_chunks[key];
+			chunk.coord = coord;
+			chunk.lastUsedFrame = m_frame;
+			m_generating++;
+			m_workers->submit([this, key, coord]() {
+				MeshData mesh = m_generator(coord);
+				std::lock_guard<std::mutex> lock(m_completedMutex);
+				m_completed.push_back({ key, std::move(mesh) });
+			});
+		}
+	}
+
+	void ChunkStreamer::stageCompleted(const ew::Vec3& cameraPosition)
+	{
+		std::vector<Completed> completed;
+		{
+			std::lock_guard<std::mutex> lock(m_completedMutex);
+			completed.swap(m_completed);
+		}
+		const float dropRadius = m_settings.loadRadius + DROP_MARGIN;
+		for (Completed& result : completed) {
+			m_generating--;
+			auto it = m_chunks.find(result.key);
+			if (distanceSquared(it->second.coord, cameraPosition) > dropRadius * dropRadius) {
+				m_chunks.erase(it);
+				continue;
+			}
+			it->second.state = ChunkState::Staged;
+			it->second.mesh = std::move(result.mesh);
+			m_staged.push_back(result.key);
+		}
+	}
+
+	ChunkStreamer::Chunk* ChunkStreamer::nextUpload(const ew::Vec3& cameraPosition)
+	{
+		const float dropRadius = m_settings.loadRadius + DROP_MARGIN;
+		while (!m_staged.empty()) {
+			size_t nearest = 0;
+			float nearestDistance = distanceSquared(m_chunks[m_staged[0]].coord, cameraPosition);
+			for (size_t i = 1; i < m_staged.size(); i++)
+			{
+				const float d2 = distanceSquared(m_chunks[m_staged[i]].coord, cameraPosition);
+				if (d2 < nearestDistance) {
+					nearest = i;
+					nearestDistance = d2;
+				}
+			}
+			const uint64_t key = m_staged[nearest];
+			m_staged[nearest] = m_staged.back();
+			m_staged.pop_back();
+			if (nearestDistance > dropRadius * dropRadius) {
+				m_chunks.erase(key);
+				continue;
+			}
+
+			Chunk& chunk = m_chunks[key];
+			if (chunk.mesh.indices.empty())
+				return &chunk;
+			const unsigned int vertexCount = (unsigned int)chunk.mesh.vertices.size();
+			const unsigned int indexCount = (unsigned int)chunk.mesh.indices.size();
+			const Bounds bounds = chunk.mesh.hasBounds ? chunk.mesh.bounds : computeBounds(chunk.mesh.vertices.data(), vertexCount);
+			int handle = m_pool.reserve(vertexCount, indexCount, bounds);
+			while (handle < 0 && evictOne()) {
+				handle = m_pool.reserve(vertexCount, indexCount, bounds);
+			}
+			if (handle < 0) {
+				//Everything resident is in range. Try again once the camera has moved on.
+				if (!m_poolFull)
+					printf("Chunk pool is full, can't upload chunk (%d, %d)\n", chunk.coord.x, chunk.coord.z);
+				m_poolFull = true;
+				m_staged.push_back(key);
+				return nullptr;
+			}
+			m_poolFull = false;
+			chunk.handle = handle;
+			return &chunk;
+		}
+		return nullptr;
+	}
+
+	void ChunkStreamer::uploadStaged(const ew::Vec3& cameraPosition)
+	{
+		//At least one vertex per frame, so a tiny budget still makes progress
+		size_t budget = m_settings.uploadBytesPerFrame == 0 ? (size_t)-1 : std::max(m_settings.uploadBytesPerFrame, sizeof(Vertex));
+		const float dropRadius = m_settings.loadRadius + DROP_MARGIN;
+		while (true) {
+			if (m_uploading && distanceSquared(m_uploading->coord, cameraPosition) > dropRadius * dropRadius) {
+				if (m_uploading->handle >= 0)
+					m_pool.remove(m_uploading->handle);
+				m_chunks.erase(chunkKey(m_uploading->coord));
+				m_uploading = nullptr;
+			}
+			if (!m_uploading)
+				m_uploading = nextUpload(cameraPosition);
+			if (!m_uploading)
+				return;
+			Chunk& chunk = *m_uploading;
+			const unsigned int vertexCount = (unsigned int)chunk.mesh.vertices.size();
+			const unsigned int indexCount = (unsigned int)chunk.mesh.indices.size();
+			if (chunk.handle >= 0 && chunk.verticesUploaded < vertexCount) {
+				const unsigned int count = (unsigned int)std::min<size_t>(vertexCount - chunk.verticesUploaded, budget / sizeof(Vertex));
+				if (count == 0)
+					return;
+				m_pool.uploadVertices(chunk.handle, chunk.verticesUploaded, chunk.mesh.vertices.data() + chunk.verticesUploaded, count);
+				chunk.verticesUploaded += count;
+				budget -= count * sizeof(Vertex);
+				m_stats.bytesUploaded += count * sizeof(Vertex);
+				continue;
+			}
+			if (chunk.handle >= 0 && chunk.indicesUploaded < indexCount) {
+				const unsigned int count = (unsigned int)std::min<size_t>(indexCount - chunk.indicesUploaded, budget / sizeof(unsigned int));
+				if (count == 0)
+					return;
+				m_pool.uploadIndices(chunk.handle, chunk.indicesUploaded, chunk.mesh.indices.data() + chunk.indicesUploaded, count);
+				chunk.indicesUploaded += count;
+				budget -= count * sizeof(unsigned int);
+				m_stats.bytesUploaded += count * sizeof(unsigned int);
+				continue;
+			}
+
+			//Fully uploaded. The CPU copy is no longer needed.
+			chunk.state = ChunkState::Resident;
+			chunk.mesh = MeshData();
+			//Chunks that left the range while generating go to the back, so the front stays the chunks in range for addDraws
+			if (chunk.lastUsedFrame == m_frame) {
+				m_lru.push_front(chunkKey(chunk.coord));
+				chunk.lruPosition = m_lru.begin();
+			}
+			else {
+				m_lru.push_back(chunkKey(chunk.coord));
+				chunk.lruPosition = std::prev(m_lru.end());
+			}
+			m_uploading = nullptr;
+		}
+	}
+
+	bool ChunkStreamer::evictOne()
+	{
+		if (m_lru.empty())
+			return false;
+		const uint64_t key = m_lru.back();
+		if (m_chunks[key].lastUsedFrame == m_frame)
+			return false;
+		evict(key);
+		return true;
+	}
+
+	void ChunkStreamer::evict(uint64_t key)
+	{
+		auto it = m_chunks.find(key);
+		if (it->second.handle >= 0)
+			m_pool.remove(it->second.handle);
+		m_lru.erase(it->second.lruPosition);
+		m_chunks.erase(it);
+		m_stats.chunksEvicted++;
+	}
+
+	size_t ChunkStreamer::addDraws(const Frustum& frustum)
+	{
+		const ew::Mat4 identity = ew::IdentityMatrix();
+		size_t count = 0;
+		//Chunks in range are at the front of the LRU list
+		for (uint64_t key : m_lru) {
+			const Chunk& chunk = m_chunks[key];
+			if (chunk.lastUsedFrame != m_frame)
+				break;
+			if (chunk.handle < 0)
+				continue;
+			const AABB& box = m_pool.get(chunk.handle).bounds.box;
+			if (!frustum.intersectsAABB(box.min, box.max))
+				continue;
+			m_pool.addDraw(chunk.handle, identity, identity);
+			count++;
+		}
+		return count;
+	}
+
+	float terrainChunkSize(const TerrainParams& params)
+	{
+		const int tile = params.tileResolution < 1 ? 1 : params.tileResolution;
+		return terrainSpacing(params) * (float)tile;
+	}
+
+	ChunkGenerator terrainChunkGenerator(const TerrainParams& params)
+	{
+		//A two tile terrain centered on the origin has tile (1, 0) at chunk (0, 0): x in [0, size], z in [0, size].
+		//Tiles outside it continue the same grid, so chunk (x, z) is tile (x + 1, -z) and neighbors share their borders exactly.
+		TerrainParams grid = params;
+		grid.tileResolution = params.tileResolution < 1 ? 1 : params.tileResolution;
+		grid.resolution = grid.tileResolution * 2;
+		grid.size = terrainChunkSize(params) * 2.0f;
+		return [grid](ChunkCoord chunk) {
+			return createTerrainTile(grid, chunk.x + 1, -chunk.z, 1);
+		};
+	}
+}
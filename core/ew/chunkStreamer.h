@@ -0,0 +1,152 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "mesh.h"
+#include "meshPool.h"
+#include "culling.h"
+#include "parallel.h"
+#include "terrain.h"
+
+namespace ew {
+	//Chunk (x, z) covers [x, x + 1) * chunkSize on X and [z, z + 1) * chunkSize on Z
+	struct ChunkCoord {
+		int x = 0;
+		int z = 0;
+	};
+
+	struct ChunkStreamerSettings {
+		//World units per chunk side
+		float chunkSize = 64.0f;
+		//Chunks whose center is within loadRadius * chunkSize of the camera (on XZ) are loaded and drawn, nearest first
+		float loadRadius = 6.0f;
+		//Resident chunks kept in the pool. Beyond this the least recently used out of range chunks are evicted.
+		//Should exceed the number of chunks in range.
+		size_t maxResidentChunks = 256;
+		//Bytes of vertices and indices uploaded per update. Chunks larger than this are spread over several frames. 0 = no limit.
+		size_t uploadBytesPerFrame = 4 << 20;
+		//Generation threads. 0 = one less than the hardware threads.
+		unsigned int workerCount = 0;
+		//Chunks generating at once. Keeps the backlog short so it follows a moving camera. 0 = 2 per worker.
+		unsigned int maxJobsInFlight = 0;
+	};
+
+	//Builds one chunk's mesh in world space. Called on worker threads, so it must be thread safe.
+	using ChunkGenerator = std::function<MeshData(ChunkCoord chunk)>;
+
+	struct ChunkStreamerStats {
+		size_t residentChunks = 0;
+		size_t generatingChunks = 0;
+		//Generated and waiting for (or partway through) upload
+		size_t stagedChunks = 0;
+		//During the last update
+		size_t bytesUploaded = 0;
+		size_t chunksEvicted = 0;
+	};
+
+	/// <summary>
+	/// Keeps the chunks around the camera resident in a MeshPool. Missing chunks are generated on a worker pool,
+	/// finished meshes wait in a staging queue and are uploaded a bounded number of bytes per frame, and chunks
+	/// that fall out of range stay cached until the least recently used ones are evicted.
+	/// The per frame cost on the calling thread depends on the load radius and upload budget, not on how far the camera has gone.
+	/// </summary>
+	class ChunkStreamer {
+	public:
+		/// <param name="pool">Receives the chunk meshes. Must outlive the streamer.</param>
+		ChunkStreamer(MeshPool& pool, ChunkGenerator generator, const ChunkStreamerSettings& settings = ChunkStreamerSettings());
+		//Cancels pending generation and removes the streamer's meshes from the pool
+		~ChunkStreamer();
+		ChunkStreamer(const ChunkStreamer&) = delete;
+		ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+		/// <summary>
+		/// Call once per frame on the GL thread. Requests missing chunks around the camera, stages finished ones,
+		/// uploads within the byte budget and evicts beyond maxResidentChunks.
+		/// Eviction removes meshes from the pool, so call it before recording the frame's draws.
+		/// </summary>
+		void update(const ew::Vec3& cameraPosition);
+		inline void update(const ew::Camera& camera) { update(camera.position); }
+
+		/// <summary>
+		/// Records a pool draw (identity model matrix) for each resident chunk in range that intersects the frustum.
+		/// Call between pool.beginDraws() and pool.submit().
+		/// </summary>
+		/// <returns>Draws added</returns>
+		size_t addDraws(const Frustum& frustum);
+
+		inline const ChunkStreamerStats& getStats()const { return m_stats; }
+		inline const ChunkStreamerSettings& getSettings()const { return m_settings; }
+		//Chunk containing a world position
+		ChunkCoord chunkAt(const ew::Vec3& position)const;
+	private:
+		enum class ChunkState {
+			Generating,
+			Staged,
+			Resident
+		};
+		struct Chunk {
+			ChunkCoord coord;
+			ChunkState state = ChunkState::Generating;
+			//Pool handle once reserved. -1 for chunks without triangles.
+			int handle = -1;
+			//Held from generation until fully uploaded
+			MeshData mesh;
+			unsigned int verticesUploaded = 0;
+			unsigned int indicesUploaded = 0;
+			//Last update the chunk was in range
+			uint64_t lastUsedFrame = 0;
+			//Position in m_lru while resident
+			std::list<uint64_t>::iterator lruPosition;
+		};
+		struct Completed {
+			uint64_t key;
+			MeshData mesh;
+		};
+
+		static uint64_t chunkKey(ChunkCoord coord);
+		//Squared distance from the camera to the chunk center on XZ, in chunk sizes
+		float distanceSquared(ChunkCoord coord, const ew::Vec3& cameraPosition)const;
+		void requestChunks(const ew::Vec3& cameraPosition);
+		void stageCompleted(const ew::Vec3& cameraPosition);
+		void uploadStaged(const ew::Vec3& cameraPosition);
+		//Picks the nearest staged chunk in range and reserves its pool ranges. Drops staged chunks that left the range.
+		Chunk* nextUpload(const ew::Vec3& cameraPosition);
+		//Evicts the least recently used chunk that isn't in range. Returns false if there is none.
+		bool evictOne();
+		void evict(uint64_t key);
+
+		MeshPool& m_pool;
+		ChunkGenerator m_generator;
+		ChunkStreamerSettings m_settings;
+		ChunkStreamerStats m_stats;
+		uint64_t m_frame = 0;
+
+		std::unordered_map<uint64_t, Chunk> m_chunks;
+		//Resident chunks, most recently in range first
+		std::list<uint64_t> m_lru;
+		std::vector<uint64_t> m_staged;
+		//Staged chunk being uploaded over several frames, null if none
+		Chunk* m_uploading = nullptr;
+		size_t m_generating = 0;
+		//Reported once until an upload fits again
+		bool m_poolFull = false;
+
+		//Filled by workers, drained by update
+		std::mutex m_completedMutex;
+		std::vector<Completed> m_completed;
+		//Declared last so it is destroyed (joining its threads) before the members jobs write to
+		std::unique_ptr<WorkerPool> m_workers;
+	};
+
+	//Side of a terrain tile in world units, the chunk size to stream a terrain with
+	float terrainChunkSize(const TerrainParams& params);
+	/// <summary>
+	/// Generates chunks as tiles of an unbounded terrain with params' noise, spacing and tile resolution.
+	/// Use with chunkSize = terrainChunkSize(params). UVs repeat every 2 chunks.
+	/// </summary>
+	ChunkGenerator terrainChunkGenerator(const TerrainParams& params);
+}
@@ -0,0 +1,180 @@
+#include "culling.h"
+#include "ewMath/simdMath.h"
+
+namespace ew {
+	namespace {
+		Plane makePlane(const ew::Vec4& v) {
+			Plane p;
+			p.normal = v.toVec3();
+			float mag = ew::Magnitude(p.normal);
+			p.normal /= mag;
+			p.d = v.w / mag;
+			return p;
+		}
+		//Stored column major, so row i is the i-th element of each column
+		ew::Vec4 row(const ew::Mat4& m, int i) {
+			return ew::Vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+		}
+		float absf(float x) {
+			return x < 0.0f ? -x : x;
+		}
+
+#if EW_SIMD_X86
+		//Appends base + k for every set bit k of mask without branching. Returns the new count.
+		inline size_t appendMask(int mask, size_t base, unsigned int* out, size_t n) {
+			for (int k = 0; k < 8; k++)
+			{
+				out[n] = (unsigned int)(base + k);
+				n += (mask >> k) & 1;
+			}
+			return n;
+		}
+
+		EW_TARGET_AVX2 size_t cullSpheresAVX2(const Frustum& f, const float* x, const float* y, const float* z, const float* radius,
+			size_t count, unsigned int* out, size_t* processed) {
+			size_t n = 0;
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 px = _mm256_loadu_ps(x + i);
+				const __m256 py = _mm256_loadu_ps(y + i);
+				const __m256 pz = _mm256_loadu_ps(z + i);
+				const __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (int p = 0; p < 6; p++)
+				{
+					const Plane& pl = f.planes[p];
+					__m256 dist = _mm256_fmadd_ps(px, _mm256_set1_ps(pl.normal.x), _mm256_set1_ps(pl.d));
+					dist = _mm256_fmadd_ps(py, _mm256_set1_ps(pl.normal.y), dist);
+					dist = _mm256_fmadd_ps(pz, _mm256_set1_ps(pl.normal.z), dist);
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, negR, _CMP_GE_OQ));
+				}
+				n = appendMask(_mm256_movemask_ps(inside), i, out, n);
+			}
+			*processed = i;
+			return n;
+		}
+
+		EW_TARGET_AVX2 size_t cullAABBsAVX2(const Frustum& f, const float* cx, const float* cy, const float* cz,
+			const float* ex, const float* ey, const float* ez, size_t count, unsigned int* out, size_t* processed) {
+			const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+			size_t n = 0;
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 px = _mm256_loadu_ps(cx + i);
+				const __m256 py = _mm256_loadu_ps(cy + i);
+				const __m256 pz = _mm256_loadu_ps(cz + i);
+				const __m256 hx = _mm256_loadu_ps(ex + i);
+				const __m256 hy = _mm256_loadu_ps(ey + i);
+				const __m256 hz = _mm256_loadu_ps(ez + i);
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (int p = 0; p < 6; p++)
+				{
+					const Plane& pl = f.planes[p];
+					const __m256 nx = _mm256_set1_ps(pl.normal.x);
+					const __m256 ny = _mm256_set1_ps(pl.normal.y);
+					const __m256 nz = _mm256_set1_ps(pl.normal.z);
+					__m256 dist = _mm256_fmadd_ps(px, nx, _mm256_set1_ps(pl.d));
+					dist = _mm256_fmadd_ps(py, ny, dist);
+					dist = _mm256_fmadd_ps(pz, nz, dist);
+					//Projected radius of the box onto the plane normal
+					__m256 r = _mm256_mul_ps(hx, _mm256_and_ps(nx, absMask));
+					r = _mm256_fmadd_ps(hy, _mm256_and_ps(ny, absMask), r);
+					r = _mm256_fmadd_ps(hz, _mm256_and_ps(nz, absMask), r);
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(dist, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+				}
+				n = appendMask(_mm256_movemask_ps(inside), i, out, n);
+			}
+			*processed = i;
+			return n;
+		}
+#endif
+	}
+
+	bool Frustum::intersectsSphere(const ew::Vec3& center, float radius) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (planes[i].distance(center) < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::intersectsAABB(const ew::Vec3& min, const ew::Vec3& max) const
+	{
+		const ew::Vec3 center = (min + max) * 0.5f;
+		const ew::Vec3 extents = (max - min) * 0.5f;
+		for (int i = 0; i < 6; i++)
+		{
+			const ew::Vec3& n = planes[i].normal;
+			float r = extents.x * absf(n.x) + extents.y * absf(n.y) + extents.z * absf(n.z);
+			if (planes[i].distance(center) + r < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	Frustum extractFrustum(const ew::Mat4& viewProjection)
+	{
+		const ew::Vec4 r0 = row(viewProjection, 0);
+		const ew::Vec4 r1 = row(viewProjection, 1);
+		const ew::Vec4 r2 = row(viewProjection, 2);
+		const ew::Vec4 r3 = row(viewProjection, 3);
+		//Vec4 +=/-= leave w untouched, so add components explicitly
+		auto add = [](const ew::Vec4& a, const ew::Vec4& b) { return ew::Vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); };
+		auto sub = [](const ew::Vec4& a, const ew::Vec4& b) { return ew::Vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); };
+		Frustum f;
+		f.planes[0] = makePlane(add(r3, r0)); //Left
+		f.planes[1] = makePlane(sub(r3, r0)); //Right
+		f.planes[2] = makePlane(add(r3, r1)); //Bottom
+		f.planes[3] = makePlane(sub(r3, r1)); //Top
+		f.planes[4] = makePlane(add(r3, r2)); //Near
+		f.planes[5] = makePlane(sub(r3, r2)); //Far
+		return f;
+	}
+
+	Frustum extractFrustum(const ew::Camera& camera)
+	{
+		return extractFrustum(camera.ProjectionMatrix() * camera.ViewMatrix());
+	}
+
+	size_t cullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+		size_t count, unsigned int* visibleIndices)
+	{
+		size_t n = 0;
+		size_t i = 0;
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			n = cullSpheresAVX2(frustum, x, y, z, radius, count, visibleIndices, &i);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			if (frustum.intersectsSphere(ew::Vec3(x[i], y[i], z[i]), radius[i]))
+				visibleIndices[n++] = (unsigned int)i;
+		}
+		return n;
+	}
+
+	size_t cullAABBs(const Frustum& frustum, const float* cx, const float* cy, const float* cz,
+		const float* ex, const float* ey, const float* ez, size_t count, unsigned int* visibleIndices)
+	{
+		size_t n = 0;
+		size_t i = 0;
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			n = cullAABBsAVX2(frustum, cx, cy, cz, ex, ey, ez, count, visibleIndices, &i);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			const ew::Vec3 c = ew::Vec3(cx[i], cy[i], cz[i]);
+			const ew::Vec3 e = ew::Vec3(ex[i], ey[i], ez[i]);
+			if (frustum.intersectsAABB(c - e, c + e))
+				visibleIndices[n++] = (unsigned int)i;
+		}
+		return n;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "ewMath/ewMath.h"
+#include "camera.h"
+
+namespace ew {
+	//Plane in the form dot(normal, p) + d = 0. Points with a positive distance are in front.
+	struct Plane {
+		ew::Vec3 normal;
+		float d = 0.0f;
+		inline float distance(const ew::Vec3& p)const { return ew::Dot(normal, p) + d; }
+	};
+
+	//Six inward facing planes: left, right, bottom, top, near, far
+	struct Frustum {
+		Plane planes[6];
+
+		//True if any part of the sphere may be inside
+		bool intersectsSphere(const ew::Vec3& center, float radius)const;
+		//True if any part of the box may be inside. Conservative near frustum corners.
+		bool intersectsAABB(const ew::Vec3& min, const ew::Vec3& max)const;
+	};
+
+	/// <summary>
+	/// Extracts normalized frustum planes from a view projection matrix (Gribb/Hartmann).
+	/// Works with the OpenGL style -w..w clip space produced by ew::Perspective and ew::Orthographic.
+	/// </summary>
+	Frustum extractFrustum(const ew::Mat4& viewProjection);
+	Frustum extractFrustum(const ew::Camera& camera);
+
+	/// <summary>
+	/// Tests count bounding spheres, stored as separate x/y/z/radius arrays, against the frustum.
+	/// Writes the indices of the visible ones to visibleIndices, in ascending order.
+	/// Uses AVX2 when available.
+	/// </summary>
+	/// <param name="visibleIndices">Must have room for count indices</param>
+	/// <returns>Number of visible spheres</returns>
+	size_t cullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius,
+		size_t count, unsigned int* visibleIndices);
+
+	/// <summary>
+	/// Same as cullSpheres for axis aligned boxes stored as center (cx,cy,cz) and half extents (ex,ey,ez)
+	/// </summary>
+	size_t cullAABBs(const Frustum& frustum, const float* cx, const float* cy, const float* cz,
+		const float* ex, const float* ey, const float* ez, size_t count, unsigned int* visibleIndices);
+}
@@ -0,0 +1,7 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+//Nothing else in core includes constexprMath.h, so this translation unit is what
+//compiles its cx_checks static_asserts on every build.
+#include "constexprMath.h"
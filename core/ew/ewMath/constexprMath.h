@@ -0,0 +1,171 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+//Opt-in compile time versions of the trig based builders.
+//cosf/sinf/tanf/sqrtf can't run in constant expressions, so these use series approximations instead.
+//Use them for constant data (static transforms, fixed projections, lookup tables) that should be baked
+//into the binary. At runtime prefer the regular ew:: functions, which are faster and exact.
+
+#pragma once
+#include "mat4.h"
+#include "vec3.h"
+#include "ewMath.h"
+#include "transformations.h"
+
+namespace ew {
+	namespace cx {
+		/// <summary>
+		/// Sine accurate to float precision. Evaluated in double: range reduced to [-pi/2, pi/2],
+		/// then a Taylor series to x^15 (truncation error < 1e-9).
+		/// </summary>
+		inline constexpr float Sin(float radians) {
+			constexpr double pi = 3.14159265358979323846;
+			double x = radians;
+			//Reduce to [-pi, pi]
+			double k = x / (2.0 * pi);
+			long long whole = (long long)(k >= 0.0 ? k + 0.5 : k - 0.5);
+			x -= (double)whole * 2.0 * pi;
+			//sin(pi - x) == sin(x)
+			if (x > pi / 2.0)
+				x = pi - x;
+			else if (x < -pi / 2.0)
+				x = -pi - x;
+			const double x2 = x * x;
+			double term = x;
+			double sum = x;
+			for (int i = 1; i <= 7; i++)
+			{
+				term *= -x2 / ((2.0 * i) * (2.0 * i + 1.0));
+				sum += term;
+			}
+			return (float)sum;
+		}
+		inline constexpr float Cos(float radians) {
+			return Sin((float)((double)radians + 3.14159265358979323846 / 2.0));
+		}
+		inline constexpr float Tan(float radians) {
+			return Sin(radians) / Cos(radians);
+		}
+		//Newton's method in double. Returns 0 for x <= 0
+		inline constexpr float Sqrt(float x) {
+			if (x <= 0.0f)
+				return 0.0f;
+			double r = x > 1.0f ? (double)x : 1.0;
+			for (int i = 0; i < 64; i++)
+			{
+				double next = 0.5 * (r + (double)x / r);
+				if (next == r)
+					break;
+				r = next;
+			}
+			return (float)r;
+		}
+		inline constexpr float Radians(float degrees) {
+			return degrees * ew::DEG2RAD;
+		}
+
+		//Same matrices as ew::RotateX/Y/Z
+		inline constexpr ew::Mat4 RotateX(float rad) {
+			const float c = Cos(rad), s = Sin(rad);
+			return ew::Mat4(
+				1.0f, 0.0f, 0.0f, 0.0f,
+				0.0f, c, -s, 0.0f,
+				0.0f, s, c, 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
+		inline constexpr ew::Mat4 RotateY(float rad) {
+			const float c = Cos(rad), s = Sin(rad);
+			return ew::Mat4(
+				c, 0.0f, s, 0.0f,
+				0.0f, 1.0f, 0.0f, 0.0f,
+				-s, 0.0f, c, 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
+		inline constexpr ew::Mat4 RotateZ(float rad) {
+			const float c = Cos(rad), s = Sin(rad);
+			return ew::Mat4(
+				c, -s, 0.0f, 0.0f,
+				s, c, 0.0f, 0.0f,
+				0.0f, 0.0f, 1.0f, 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
+		//Same as ew::TRS with Euler rotation in radians
+		inline constexpr ew::Mat4 TRS(const ew::Vec3& t, const ew::Vec3& r, const ew::Vec3& s) {
+			const float cx = Cos(r.x), sx = Sin(r.x);
+			const float cy = Cos(r.y), sy = Sin(r.y);
+			const float cz = Cos(r.z), sz = Sin(r.z);
+			const float m[3][3] = {
+				{ cy * cz + sy * sx * sz, sy * sx * cz - cy * sz, sy * cx },
+				{ cx * sz, cx * cz, -sx },
+				{ cy * sx * sz - sy * cz, sy * sz + cy * sx * cz, cy * cx }
+			};
+			return ew::TRS(t, m, s);
+		}
+		//Same as ew::Perspective
+		inline constexpr ew::Mat4 Perspective(float fov, float a, float n, float f) {
+			const float c = Tan(fov / 2.0f);
+			return ew::Mat4(
+				1.0f / (c * a), 0.0f, 0.0f, 0.0f,
+				0.0f, 1.0f / c, 0.0f, 0.0f,
+				0.0f, 0.0f, (f + n) / (n - f), (2 * f * n) / (n - f),
+				0.0f, 0.0f, -1.0f, 0.0f
+			);
+		}
+		//Same as ew::LookAt
+		inline constexpr ew::Mat4 LookAt(const ew::Vec3& eyePos, const ew::Vec3& targetPos, const ew::Vec3& up) {
+			ew::Vec3 f = eyePos - targetPos;
+			f /= Sqrt(ew::Dot(f, f));
+			ew::Vec3 r = ew::Cross(up, f);
+			r /= Sqrt(ew::Dot(r, r));
+			const ew::Vec3 u = ew::Cross(f, r);
+			return ew::Mat4(
+				r.x, r.y, r.z, -ew::Dot(r, eyePos),
+				u.x, u.y, u.z, -ew::Dot(u, eyePos),
+				f.x, f.y, f.z, -ew::Dot(f, eyePos),
+				0.0f, 0.0f, 0.0f, 1.0f);
+		}
+
+		/// <summary>
+		/// Compile time lookup table of N+1 evenly spaced (cos, sin) pairs covering [0, TAU].
+		/// e.g. static constexpr auto ring = ew::cx::SinCosTable<64>();
+		/// </summary>
+		template<int N>
+		struct SinCosTable {
+			float cos[N + 1] = {};
+			float sin[N + 1] = {};
+			constexpr SinCosTable() {
+				for (int i = 0; i <= N; i++)
+				{
+					const float theta = (float)(6.283185307179586 * i / N);
+					cos[i] = Cos(theta);
+					sin[i] = Sin(theta);
+				}
+			}
+		};
+
+		inline constexpr bool NearlyEqual(float a, float b, float epsilon = 1e-5f) {
+			return (a > b ? a - b : b - a) <= epsilon;
+		}
+	}
+
+	//Compile time checks. These fail the build if any of the math above stops being constexpr.
+	namespace cx_checks {
+		constexpr ew::Mat4 translated = ew::MulScalar(ew::Translate(ew::Vec3(1, 2, 3)), ew::Scale(ew::Vec3(2)));
+		static_assert(translated.at(3, 0) == 1.0f && translated.at(3, 2) == 3.0f && translated.at(0, 0) == 2.0f, "Translate * Scale");
+		static_assert(ew::MulScalar(ew::IdentityMatrix(), ew::Vec4(1, 2, 3, 1)).y == 2.0f, "Identity * Vec4");
+		static_assert(ew::Cross(ew::Vec3(1, 0, 0), ew::Vec3(0, 1, 0)).z == 1.0f, "Cross");
+		static_assert(cx::NearlyEqual(cx::Sin(ew::PI / 6.0f), 0.5f) && cx::NearlyEqual(cx::Cos(ew::PI), -1.0f), "Sin/Cos");
+		static_assert(cx::NearlyEqual(cx::Sin(100.0f), -0.50636564f), "Sin range reduction");
+		static_assert(cx::Sqrt(16.0f) == 4.0f && cx::NearlyEqual(cx::Sqrt(2.0f), 1.41421356f), "Sqrt");
+		static_assert(cx::NearlyEqual(cx::RotateY(ew::PI / 2.0f).at(2, 0), 1.0f), "RotateY");
+		static_assert(cx::NearlyEqual(ew::AffineInverse(ew::Translate(ew::Vec3(1, 2, 3))).at(3, 1), -2.0f), "AffineInverse");
+		static_assert(cx::NearlyEqual(ew::Orthographic(2.0f, 1.0f, 0.1f, 100.0f).at(1, 1), 1.0f), "Orthographic");
+		static_assert(cx::NearlyEqual(cx::Perspective(ew::PI / 2.0f, 1.0f, 0.1f, 100.0f).at(1, 1), 1.0f), "Perspective");
+		static_assert(cx::NearlyEqual(cx::SinCosTable<4>().sin[1], 1.0f), "SinCosTable");
+		static_assert(cx::NearlyEqual(ew::ToMat4(ew::Quat(0, 0, 0, 1)).at(2, 2), 1.0f), "Quat ToMat4");
+	}
+}
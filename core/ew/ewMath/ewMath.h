@@ -9,6 +9,7 @@
 #include "vec2.h"
 #include "vec3.h"
 #include "mat4.h"
+#include "quat.h"
 
 namespace ew {
 	constexpr float PI = 3.14159265359f;
@@ -3,37 +3,56 @@
 */
 
 #pragma once
+#include "vec3.h"
 #include "vec4.h"
+#include "simd.h"
 #include <cstddef>
 
 namespace ew {
+	namespace simd {
+		//Kernels selected at startup from the CPU features (see simd.h).
+		//Matrices are 16 floats in column-major order. out may alias either input.
+		extern void (*Mat4Mul)(const float* l, const float* r, float* out);
+		extern void (*Mat4MulVec4)(const float* m, const float* v, float* out);
+		extern void (*Mat4Transpose)(const float* m, float* out);
+		//Returns the determinant. out is only valid when it is non-zero.
+		extern float (*Mat4Inverse)(const float* m, float* out);
+	}
 	struct Mat4 {
 	private:
 		float n[4][4];
 	public:
 		Mat4() = default;
-		Mat4(float n00)
-		{
-			n[0][0] = n00; n[1][0] = n00; n[2][0] = n00; n[3][0] = n00;
-			n[0][1] = n00; n[1][1] = n00; n[2][1] = n00; n[3][1] = n00;
-			n[0][2] = n00; n[1][2] = n00; n[2][2] = n00; n[3][2] = n00;
-			n[0][3] = n00; n[1][3] = n00; n[2][3] = n00; n[3][3] = n00;
-		};
-		Mat4(float n00, float n10, float n20, float n30,
+		constexpr Mat4(float n00)
+			:n{ { n00, n00, n00, n00 },
+				{ n00, n00, n00, n00 },
+				{ n00, n00, n00, n00 },
+				{ n00, n00, n00, n00 } }
+		{};
+		constexpr Mat4(float n00, float n10, float n20, float n30,
 			 float n01, float n11, float n21, float n31,
 			 float n02, float n12, float n22, float n32,
 			 float n03, float n13, float n23, float n33)
-		{
-			n[0][0] = n00; n[1][0] = n10; n[2][0] = n20; n[3][0] = n30;
-			n[0][1] = n01; n[1][1] = n11; n[2][1] = n21; n[3][1] = n31;
-			n[0][2] = n02; n[1][2] = n12; n[2][2] = n22; n[3][2] = n32;
-			n[0][3] = n03; n[1][3] = n13; n[2][3] = n23; n[3][3] = n33;
-		};
-		Mat4(const Vec4& a, const Vec4& b, const Vec4& c, const Vec4& d) {
-			n[0][0] = a.x; n[0][1] = a.y; n[0][2] = a.z; n[0][3] = a.w;
-			n[1][0] = b.x; n[1][1] = b.y; n[1][2] = b.z; n[1][3] = b.w;
-			n[2][0] = c.x; n[2][1] = c.y; n[2][2] = c.z; n[2][3] = c.w;
-			n[3][0] = d.x; n[3][1] = d.y; n[3][2] = d.z; n[3][3] = d.w;
+			:n{ { n00, n01, n02, n03 },
+				{ n10, n11, n12, n13 },
+				{ n20, n21, n22, n23 },
+				{ n30, n31, n32, n33 } }
+		{};
+		constexpr Mat4(const Vec4& a, const Vec4& b, const Vec4& c, const Vec4& d)
+			:n{ { a.x, a.y, a.z, a.w },
+				{ b.x, b.y, b.z, b.w },
+				{ c.x, c.y, c.z, c.w },
+				{ d.x, d.y, d.z, d.w } }
+		{}
+		//Element access usable in constant expressions. operator[] is not, because it reinterprets memory.
+		inline constexpr float& at(int col, int row) {
+			return n[col][row];
+		}
+		inline constexpr const float& at(int col, int row) const {
+			return n[col][row];
+		}
+		inline constexpr Vec4 column(int i) const {
+			return Vec4(n[i][0], n[i][1], n[i][2], n[i][3]);
 		}
 		inline Vec4& operator[](int i) {
 			return (*reinterpret_cast<Vec4*>(n[i]));
@@ -42,39 +61,50 @@ namespace ew {
 			return (*reinterpret_cast<const Vec4*>(n[i]));
 		}
 		inline friend Vec4 operator * (const Mat4& m, const Vec4& v) {
-			return Vec4(
-				m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0] * v.w,
-				m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1] * v.w,
-				m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2] * v.w,
-				m[0][3] * v.x + m[1][3] * v.y + m[2][3] * v.z + m[3][3] * v.w
-			);
+			Vec4 r;
+			simd::Mat4MulVec4(&m.n[0][0], &v.x, &r.x);
+			return r;
 		}
 		inline friend Mat4 operator * (const Mat4& l, const Mat4& r) {
 			Mat4 m;
-			//Row 0
-			m[0][0] = l[0][0] * r[0][0] + l[1][0] * r[0][1] + l[2][0] * r[0][2] + l[3][0] * r[0][3];//dot(l_row_0,r_col_0)
-			m[1][0] = l[0][0] * r[1][0] + l[1][0] * r[1][1] + l[2][0] * r[1][2] + l[3][0] * r[1][3];//dot(l_row_0,r_col_1)
-			m[2][0] = l[0][0] * r[2][0] + l[1][0] * r[2][1] + l[2][0] * r[2][2] + l[3][0] * r[2][3];//dot(l_row_0,r_col_2)
-			m[3][0] = l[0][0] * r[3][0] + l[1][0] * r[3][1] + l[2][0] * r[3][2] + l[3][0] * r[3][3];//dot(l_row_0,r_col_3)
-			// Row 1		  		    		  		    		  		    		  
-			m[0][1] = l[0][1] * r[0][0] + l[1][1] * r[0][1] + l[2][1] * r[0][2] + l[3][1] * r[0][3];//dot(l_row_1,r_col_0)
-			m[1][1] = l[0][1] * r[1][0] + l[1][1] * r[1][1] + l[2][1] * r[1][2] + l[3][1] * r[1][3];//dot(l_row_1,r_col_1)
-			m[2][1] = l[0][1] * r[2][0] + l[1][1] * r[2][1] + l[2][1] * r[2][2] + l[3][1] * r[2][3];//dot(l_row_1,r_col_2)
-			m[3][1] = l[0][1] * r[3][0] + l[1][1] * r[3][1] + l[2][1] * r[3][2] + l[3][1] * r[3][3];//dot(l_row_1,r_col_3)
-			// Row  2		  		    		  		    		  		    		  
-			m[0][2] = l[0][2] * r[0][0] + l[1][2] * r[0][1] + l[2][2] * r[0][2] + l[3][2] * r[0][3];//dot(l_row_2,r_col_0)
-			m[1][2] = l[0][2] * r[1][0] + l[1][2] * r[1][1] + l[2][2] * r[1][2] + l[3][2] * r[1][3];//dot(l_row_2,r_col_1)
-			m[2][2] = l[0][2] * r[2][0] + l[1][2] * r[2][1] + l[2][2] * r[2][2] + l[3][2] * r[2][3];//dot(l_row_2,r_col_2)
-			m[3][2] = l[0][2] * r[3][0] + l[1][2] * r[3][1] + l[2][2] * r[3][2] + l[3][2] * r[3][3];//dot(l_row_2,r_col_3)
-			// Row  3		 			 		 			 		 			 		    
-			m[0][3] = l[0][3] * r[0][0] + l[1][3] * r[0][1] + l[2][3] * r[0][2] + l[3][3] * r[0][3];//dot(l_row_3,r_col_0)
-			m[1][3] = l[0][3] * r[1][0] + l[1][3] * r[1][1] + l[2][3] * r[1][2] + l[3][3] * r[1][3];//dot(l_row_3,r_col_1)
-			m[2][3] = l[0][3] * r[2][0] + l[1][3] * r[2][1] + l[2][3] * r[2][2] + l[3][3] * r[2][3];//dot(l_row_3,r_col_2)
-			m[3][3] = l[0][3] * r[3][0] + l[1][3] * r[3][1] + l[2][3] * r[3][2] + l[3][3] * r[3][3];//dot(l_row_3,r_col_3)
-			return m;		  
+			simd::Mat4Mul(&l.n[0][0], &r.n[0][0], &m.n[0][0]);
+			return m;
 		}
 	};
-	inline Mat4 IdentityMatrix() {
+	//Reference implementations. Used as the fallback when no SIMD backend is available.
+	inline constexpr Vec4 MulScalar(const Mat4& m, const Vec4& v) {
+		return Vec4(
+			m.at(0, 0) * v.x + m.at(1, 0) * v.y + m.at(2, 0) * v.z + m.at(3, 0) * v.w,
+			m.at(0, 1) * v.x + m.at(1, 1) * v.y + m.at(2, 1) * v.z + m.at(3, 1) * v.w,
+			m.at(0, 2) * v.x + m.at(1, 2) * v.y + m.at(2, 2) * v.z + m.at(3, 2) * v.w,
+			m.at(0, 3) * v.x + m.at(1, 3) * v.y + m.at(2, 3) * v.z + m.at(3, 3) * v.w
+		);
+	}
+	inline constexpr Mat4 MulScalar(const Mat4& l, const Mat4& r) {
+		Mat4 m(0.0f);
+		//Row 0
+		m.at(0, 0) = l.at(0, 0) * r.at(0, 0) + l.at(1, 0) * r.at(0, 1) + l.at(2, 0) * r.at(0, 2) + l.at(3, 0) * r.at(0, 3);//dot(l_row_0,r_col_0)
+		m.at(1, 0) = l.at(0, 0) * r.at(1, 0) + l.at(1, 0) * r.at(1, 1) + l.at(2, 0) * r.at(1, 2) + l.at(3, 0) * r.at(1, 3);//dot(l_row_0,r_col_1)
+		m.at(2, 0) = l.at(0, 0) * r.at(2, 0) + l.at(1, 0) * r.at(2, 1) + l.at(2, 0) * r.at(2, 2) + l.at(3, 0) * r.at(2, 3);//dot(l_row_0,r_col_2)
+		m.at(3, 0) = l.at(0, 0) * r.at(3, 0) + l.at(1, 0) * r.at(3, 1) + l.at(2, 0) * r.at(3, 2) + l.at(3, 0) * r.at(3, 3);//dot(l_row_0,r_col_3)
+		// Row 1		  		    		  		    		  		    		  
+		m.at(0, 1) = l.at(0, 1) * r.at(0, 0) + l.at(1, 1) * r.at(0, 1) + l.at(2, 1) * r.at(0, 2) + l.at(3, 1) * r.at(0, 3);//dot(l_row_1,r_col_0)
+		m.at(1, 1) = l.at(0, 1) * r.at(1, 0) + l.at(1, 1) * r.at(1, 1) + l.at(2, 1) * r.at(1, 2) + l.at(3, 1) * r.at(1, 3);//dot(l_row_1,r_col_1)
+		m.at(2, 1) = l.at(0, 1) * r.at(2, 0) + l.at(1, 1) * r.at(2, 1) + l.at(2, 1) * r.at(2, 2) + l.at(3, 1) * r.at(2, 3);//dot(l_row_1,r_col_2)
+		m.at(3, 1) = l.at(0, 1) * r.at(3, 0) + l.at(1, 1) * r.at(3, 1) + l.at(2, 1) * r.at(3, 2) + l.at(3, 1) * r.at(3, 3);//dot(l_row_1,r_col_3)
+		// Row  2		  		    		  		    		  		    		  
+		m.at(0, 2) = l.at(0, 2) * r.at(0, 0) + l.at(1, 2) * r.at(0, 1) + l.at(2, 2) * r.at(0, 2) + l.at(3, 2) * r.at(0, 3);//dot(l_row_2,r_col_0)
+		m.at(1, 2) = l.at(0, 2) * r.at(1, 0) + l.at(1, 2) * r.at(1, 1) + l.at(2, 2) * r.at(1, 2) + l.at(3, 2) * r.at(1, 3);//dot(l_row_2,r_col_1)
+		m.at(2, 2) = l.at(0, 2) * r.at(2, 0) + l.at(1, 2) * r.at(2, 1) + l.at(2, 2) * r.at(2, 2) + l.at(3, 2) * r.at(2, 3);//dot(l_row_2,r_col_2)
+		m.at(3, 2) = l.at(0, 2) * r.at(3, 0) + l.at(1, 2) * r.at(3, 1) + l.at(2, 2) * r.at(3, 2) + l.at(3, 2) * r.at(3, 3);//dot(l_row_2,r_col_3)
+		// Row  3		 			 		 			 		 			 		    
+		m.at(0, 3) = l.at(0, 3) * r.at(0, 0) + l.at(1, 3) * r.at(0, 1) + l.at(2, 3) * r.at(0, 2) + l.at(3, 3) * r.at(0, 3);//dot(l_row_3,r_col_0)
+		m.at(1, 3) = l.at(0, 3) * r.at(1, 0) + l.at(1, 3) * r.at(1, 1) + l.at(2, 3) * r.at(1, 2) + l.at(3, 3) * r.at(1, 3);//dot(l_row_3,r_col_1)
+		m.at(2, 3) = l.at(0, 3) * r.at(2, 0) + l.at(1, 3) * r.at(2, 1) + l.at(2, 3) * r.at(2, 2) + l.at(3, 3) * r.at(2, 3);//dot(l_row_3,r_col_2)
+		m.at(3, 3) = l.at(0, 3) * r.at(3, 0) + l.at(1, 3) * r.at(3, 1) + l.at(2, 3) * r.at(3, 2) + l.at(3, 3) * r.at(3, 3);//dot(l_row_3,r_col_3)
+		return m;		  
+	}
+	inline constexpr Mat4 IdentityMatrix() {
 		return Mat4(
 			1.0f, 0.0f, 0.0f, 0.0f,
 			0.0f, 1.0f, 0.0f, 0.0f,
@@ -82,4 +112,59 @@ namespace ew {
 			0.0f, 0.0f, 0.0f, 1.0f
 		);
 	}
+	inline Mat4 Transpose(const Mat4& m) {
+		Mat4 r;
+		simd::Mat4Transpose(&m[0][0], &r[0][0]);
+		return r;
+	}
+	/// <summary>
+	/// General 4x4 inverse (Cramer's rule). Use AffineInverse when the bottom row is (0,0,0,1).
+	/// </summary>
+	/// <returns>Inverse of m, or all zeros when m is singular</returns>
+	inline Mat4 Inverse(const Mat4& m) {
+		Mat4 r;
+		if (simd::Mat4Inverse(&m[0][0], &r[0][0]) == 0.0f)
+			return Mat4(0.0f);
+		return r;
+	}
+	/// <summary>
+	/// Inverse of a matrix whose bottom row is (0,0,0,1), e.g. any model or view matrix.
+	/// Only inverts the upper 3x3, so it is much cheaper than Inverse.
+	/// </summary>
+	/// <returns>Inverse of m, or all zeros when the upper 3x3 is singular</returns>
+	inline constexpr Mat4 AffineInverse(const Mat4& m) {
+		const Vec3 a = m.column(0).toVec3(), b = m.column(1).toVec3(), c = m.column(2).toVec3(), t = m.column(3).toVec3();
+		//Rows of inverse(mat3(m)) are the cross products of its columns divided by the determinant
+		Vec3 r0 = Cross(b, c);
+		const float det = Dot(a, r0);
+		if (det == 0.0f)
+			return Mat4(0.0f);
+		const float invDet = 1.0f / det;
+		r0 *= invDet;
+		const Vec3 r1 = Cross(c, a) * invDet;
+		const Vec3 r2 = Cross(a, b) * invDet;
+		return Mat4(
+			r0.x, r0.y, r0.z, -Dot(r0, t),
+			r1.x, r1.y, r1.z, -Dot(r1, t),
+			r2.x, r2.y, r2.z, -Dot(r2, t),
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+	/// <summary>
+	/// transpose(inverse(mat3(model))), stored in the upper 3x3. Transforms normals to world space
+	/// so shaders don't have to invert the model matrix per vertex.
+	/// </summary>
+	/// <returns>Normal matrix, or all zeros when the upper 3x3 is singular</returns>
+	inline constexpr Mat4 NormalMatrix(const Mat4& model) {
+		const Vec3 a = model.column(0).toVec3(), b = model.column(1).toVec3(), c = model.column(2).toVec3();
+		Vec3 c0 = Cross(b, c);
+		const float det = Dot(a, c0);
+		if (det == 0.0f)
+			return Mat4(0.0f);
+		const float invDet = 1.0f / det;
+		c0 *= invDet;
+		const Vec3 c1 = Cross(c, a) * invDet;
+		const Vec3 c2 = Cross(a, b) * invDet;
+		return Mat4(Vec4(c0, 0.0f), Vec4(c1, 0.0f), Vec4(c2, 0.0f), Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
 }
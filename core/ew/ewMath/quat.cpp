@@ -0,0 +1,104 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+#include "quat.h"
+#include "simdMath.h"
+
+namespace ew {
+	namespace {
+#if EW_SIMD_X86
+		//Loads 8 consecutive quaternions and transposes them into x,y,z,w registers
+		EW_TARGET_AVX2 void loadQuats8(const Quat* q, __m256* x, __m256* y, __m256* z, __m256* w) {
+			const float* f = &q->x;
+			const __m256 r0 = _mm256_loadu_ps(f + 0);  //q0 q1
+			const __m256 r1 = _mm256_loadu_ps(f + 8);  //q2 q3
+			const __m256 r2 = _mm256_loadu_ps(f + 16); //q4 q5
+			const __m256 r3 = _mm256_loadu_ps(f + 24); //q6 q7
+			const __m256 a = _mm256_permute2f128_ps(r0, r2, 0x20); //q0 q4
+			const __m256 b = _mm256_permute2f128_ps(r0, r2, 0x31); //q1 q5
+			const __m256 c = _mm256_permute2f128_ps(r1, r3, 0x20); //q2 q6
+			const __m256 d = _mm256_permute2f128_ps(r1, r3, 0x31); //q3 q7
+			const __m256 t0 = _mm256_unpacklo_ps(a, b);
+			const __m256 t1 = _mm256_unpackhi_ps(a, b);
+			const __m256 t2 = _mm256_unpacklo_ps(c, d);
+			const __m256 t3 = _mm256_unpackhi_ps(c, d);
+			*x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			*y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			*z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			*w = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		EW_TARGET_AVX2 size_t toMat4AVX2(const Quat* q, Mat4* out, size_t count) {
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 two = _mm256_set1_ps(2.0f);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 x, y, z, w;
+				loadQuats8(q + i, &x, &y, &z, &w);
+				const __m256 x2 = _mm256_mul_ps(x, two), y2 = _mm256_mul_ps(y, two), z2 = _mm256_mul_ps(z, two);
+				const __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+				const __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+				const __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+				float* dst = reinterpret_cast<float*>(out + i);
+				//Columns of the matrix in QuatToRotation
+				simd::StoreTransposed4x8(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), _mm256_add_ps(xy, wz), _mm256_sub_ps(xz, wy), zero, dst + 0, 16);
+				simd::StoreTransposed4x8(_mm256_sub_ps(xy, wz), _mm256_sub_ps(one, _mm256_add_ps(xx, zz)), _mm256_add_ps(yz, wx), zero, dst + 4, 16);
+				simd::StoreTransposed4x8(_mm256_add_ps(xz, wy), _mm256_sub_ps(yz, wx), _mm256_sub_ps(one, _mm256_add_ps(xx, yy)), zero, dst + 8, 16);
+				simd::StoreTransposed4x8(zero, zero, zero, one, dst + 12, 16);
+			}
+			return i;
+		}
+
+		//Two quaternions per register. Dot products stay within each 128 bit lane.
+		EW_TARGET_AVX2 size_t nlerpAVX2(const Quat* a, const Quat* b, float t, Quat* out, size_t count) {
+			const __m256 tv = _mm256_set1_ps(t);
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m256 va = _mm256_loadu_ps(&a[i].x);
+				__m256 vb = _mm256_loadu_ps(&b[i].x);
+				//Flip b when dot(a,b) < 0 to take the shortest path
+				const __m256 d = _mm256_dp_ps(va, vb, 0xFF);
+				vb = _mm256_xor_ps(vb, _mm256_and_ps(d, signMask));
+				const __m256 r = _mm256_fmadd_ps(_mm256_sub_ps(vb, va), tv, va);
+				const __m256 len = _mm256_sqrt_ps(_mm256_dp_ps(r, r, 0xFF));
+				_mm256_storeu_ps(&out[i].x, _mm256_div_ps(r, len));
+			}
+			return i;
+		}
+#endif
+	}
+
+	void ToMat4(const Quat* q, Mat4* out, size_t count)
+	{
+		size_t i = 0;
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			i = toMat4AVX2(q, out, count);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			out[i] = ToMat4(q[i]);
+		}
+	}
+
+	void Nlerp(const Quat* a, const Quat* b, float t, Quat* out, size_t count)
+	{
+		size_t i = 0;
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			i = nlerpAVX2(a, b, t, out, count);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			out[i] = Nlerp(a[i], b[i], t);
+		}
+	}
+}
@@ -0,0 +1,139 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+#pragma once
+#include <math.h>
+#include <cstddef>
+#include "vec3.h"
+#include "mat4.h"
+
+namespace ew {
+	//Rotation quaternion. w is the scalar part. Identity by default.
+	struct Quat {
+		float x, y, z, w;
+
+		constexpr Quat() :x(0), y(0), z(0), w(1) {};
+		constexpr Quat(float x, float y, float z, float w) :x(x), y(y), z(z), w(w) {};
+		constexpr Quat(const Vec3& v, float w) :x(v.x), y(v.y), z(v.z), w(w) {};
+
+		inline constexpr Vec3 xyz() const { return ew::Vec3(x, y, z); }
+
+		friend constexpr Quat operator*(const Quat& a, const Quat& b);
+	};
+
+	//Hamilton product. Applies b first, then a (same as multiplying rotation matrices)
+	inline constexpr Quat operator*(const Quat& a, const Quat& b) {
+		return Quat(
+			a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+			a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+			a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+			a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+		);
+	}
+
+	inline constexpr float Dot(const Quat& a, const Quat& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	}
+
+	inline Quat Normalize(const Quat& q) {
+		float mag = sqrtf(Dot(q, q));
+		if (mag == 0)
+			return Quat();
+		float inv = 1.0f / mag;
+		return Quat(q.x * inv, q.y * inv, q.z * inv, q.w * inv);
+	}
+
+	//Inverse rotation of a unit quaternion
+	inline constexpr Quat Conjugate(const Quat& q) {
+		return Quat(-q.x, -q.y, -q.z, q.w);
+	}
+
+	//Rotation of rad radians around a unit length axis
+	inline Quat AxisAngle(const Vec3& axis, float rad) {
+		float s = sinf(rad * 0.5f);
+		return Quat(axis * s, cosf(rad * 0.5f));
+	}
+
+	//Same rotation as RotateY(r.y) * RotateX(r.x) * RotateZ(r.z). Radians
+	inline Quat FromEuler(const Vec3& r) {
+		const float cx = cosf(r.x * 0.5f), sx = sinf(r.x * 0.5f);
+		const float cy = cosf(r.y * 0.5f), sy = sinf(r.y * 0.5f);
+		const float cz = cosf(r.z * 0.5f), sz = sinf(r.z * 0.5f);
+		return Quat(
+			cy * sx * cz + sy * cx * sz,
+			sy * cx * cz - cy * sx * sz,
+			cy * cx * sz - sy * sx * cz,
+			cy * cx * cz + sy * sx * sz
+		);
+	}
+
+	//Rotates v by unit quaternion q
+	inline constexpr Vec3 Rotate(const Quat& q, const Vec3& v) {
+		//v + 2w(u x v) + 2(u x (u x v)), u = q.xyz
+		Vec3 u = q.xyz();
+		Vec3 t = Cross(u, v) * 2.0f;
+		return v + t * q.w + Cross(u, t);
+	}
+
+	//Normalized linear interpolation. Takes the shortest path. Cheap, but not constant angular speed.
+	inline Quat Nlerp(const Quat& a, const Quat& b, float t) {
+		float sign = Dot(a, b) < 0.0f ? -1.0f : 1.0f;
+		return Normalize(Quat(
+			a.x + (b.x * sign - a.x) * t,
+			a.y + (b.y * sign - a.y) * t,
+			a.z + (b.z * sign - a.z) * t,
+			a.w + (b.w * sign - a.w) * t
+		));
+	}
+
+	//Spherical linear interpolation. Takes the shortest path at constant angular speed.
+	inline Quat Slerp(const Quat& a, const Quat& b, float t) {
+		float cosTheta = Dot(a, b);
+		Quat end = b;
+		if (cosTheta < 0.0f) {
+			cosTheta = -cosTheta;
+			end = Quat(-b.x, -b.y, -b.z, -b.w);
+		}
+		//Nearly parallel. sin(theta) -> 0, so fall back to nlerp
+		if (cosTheta > 0.9995f) {
+			return Nlerp(a, end, t);
+		}
+		float theta = acosf(cosTheta);
+		float invSin = 1.0f / sinf(theta);
+		float wa = sinf((1.0f - t) * theta) * invSin;
+		float wb = sinf(t * theta) * invSin;
+		return Quat(
+			a.x * wa + end.x * wb,
+			a.y * wa + end.y * wb,
+			a.z * wa + end.z * wb,
+			a.w * wa + end.w * wb
+		);
+	}
+
+	//3x3 rotation matrix (row major) of a unit quaternion. No trig.
+	inline constexpr void QuatToRotation(const Quat& q, float m[3][3]) {
+		const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		m[0][0] = 1.0f - 2.0f * (yy + zz); m[0][1] = 2.0f * (xy - wz);        m[0][2] = 2.0f * (xz + wy);
+		m[1][0] = 2.0f * (xy + wz);        m[1][1] = 1.0f - 2.0f * (xx + zz); m[1][2] = 2.0f * (yz - wx);
+		m[2][0] = 2.0f * (xz - wy);        m[2][1] = 2.0f * (yz + wx);        m[2][2] = 1.0f - 2.0f * (xx + yy);
+	}
+
+	//Rotation matrix of a unit quaternion
+	inline constexpr Mat4 ToMat4(const Quat& q) {
+		float m[3][3] = {};
+		QuatToRotation(q, m);
+		return Mat4(
+			m[0][0], m[0][1], m[0][2], 0.0f,
+			m[1][0], m[1][1], m[1][2], 0.0f,
+			m[2][0], m[2][1], m[2][2], 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	//Batched versions. Use AVX2 when available (see simd.h). Nlerp output may alias a or b.
+	void ToMat4(const Quat* q, Mat4* out, size_t count);
+	void Nlerp(const Quat* a, const Quat* b, float t, Quat* out, size_t count);
+}
@@ -0,0 +1,323 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+#include "simd.h"
+#include "mat4.h"
+
+#if EW_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace ew {
+	namespace {
+		void mat4MulScalar(const float* l, const float* r, float* out) {
+			*reinterpret_cast<Mat4*>(out) = MulScalar(*reinterpret_cast<const Mat4*>(l), *reinterpret_cast<const Mat4*>(r));
+		}
+		void mat4MulVec4Scalar(const float* m, const float* v, float* out) {
+			*reinterpret_cast<Vec4*>(out) = MulScalar(*reinterpret_cast<const Mat4*>(m), *reinterpret_cast<const Vec4*>(v));
+		}
+		void mat4TransposeScalar(const float* m, float* out) {
+			float t[16];
+			for (int i = 0; i < 4; i++)
+			{
+				for (int j = 0; j < 4; j++)
+				{
+					t[j * 4 + i] = m[i * 4 + j];
+				}
+			}
+			for (int i = 0; i < 16; i++)
+			{
+				out[i] = t[i];
+			}
+		}
+		//Cofactor expansion using 2x2 sub-determinants of the top and bottom halves.
+		//Layout agnostic: inverse(transpose(m)) == transpose(inverse(m))
+		float mat4InverseScalar(const float* m, float* out) {
+			const float s0 = m[0] * m[5] - m[4] * m[1];
+			const float s1 = m[0] * m[6] - m[4] * m[2];
+			const float s2 = m[0] * m[7] - m[4] * m[3];
+			const float s3 = m[1] * m[6] - m[5] * m[2];
+			const float s4 = m[1] * m[7] - m[5] * m[3];
+			const float s5 = m[2] * m[7] - m[6] * m[3];
+
+			const float c5 = m[10] * m[15] - m[14] * m[11];
+			const float c4 = m[9] * m[15] - m[13] * m[11];
+			const float c3 = m[9] * m[14] - m[13] * m[10];
+			const float c2 = m[8] * m[15] - m[12] * m[11];
+			const float c1 = m[8] * m[14] - m[12] * m[10];
+			const float c0 = m[8] * m[13] - m[12] * m[9];
+
+			const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if (det == 0.0f)
+				return 0.0f;
+			const float invDet = 1.0f / det;
+			float t[16];
+			t[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * invDet;
+			t[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * invDet;
+			t[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * invDet;
+			t[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * invDet;
+
+			t[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * invDet;
+			t[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * invDet;
+			t[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * invDet;
+			t[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * invDet;
+
+			t[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * invDet;
+			t[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * invDet;
+			t[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * invDet;
+			t[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * invDet;
+
+			t[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * invDet;
+			t[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * invDet;
+			t[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * invDet;
+			t[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * invDet;
+			for (int i = 0; i < 16; i++)
+			{
+				out[i] = t[i];
+			}
+			return det;
+		}
+
+#if EW_SIMD_X86
+		//Adds are done in the same order as MulScalar and FMA is never used,
+		//so every backend produces bit-identical results to the scalar code.
+		void mat4MulSSE(const float* l, const float* r, float* out) {
+			const __m128 c0 = _mm_loadu_ps(l + 0);
+			const __m128 c1 = _mm_loadu_ps(l + 4);
+			const __m128 c2 = _mm_loadu_ps(l + 8);
+			const __m128 c3 = _mm_loadu_ps(l + 12);
+			__m128 result[4];
+			for (int j = 0; j < 4; j++)
+			{
+				const float* rc = r + j * 4;
+				__m128 acc = _mm_mul_ps(c0, _mm_set1_ps(rc[0]));
+				acc = _mm_add_ps(acc, _mm_mul_ps(c1, _mm_set1_ps(rc[1])));
+				acc = _mm_add_ps(acc, _mm_mul_ps(c2, _mm_set1_ps(rc[2])));
+				acc = _mm_add_ps(acc, _mm_mul_ps(c3, _mm_set1_ps(rc[3])));
+				result[j] = acc;
+			}
+			for (int j = 0; j < 4; j++)
+			{
+				_mm_storeu_ps(out + j * 4, result[j]);
+			}
+		}
+		void mat4MulVec4SSE(const float* m, const float* v, float* out) {
+			__m128 acc = _mm_mul_ps(_mm_loadu_ps(m + 0), _mm_set1_ps(v[0]));
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(v[1])));
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(v[2])));
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(m + 12), _mm_set1_ps(v[3])));
+			_mm_storeu_ps(out, acc);
+		}
+		void mat4TransposeSSE(const float* m, float* out) {
+			__m128 c0 = _mm_loadu_ps(m + 0);
+			__m128 c1 = _mm_loadu_ps(m + 4);
+			__m128 c2 = _mm_loadu_ps(m + 8);
+			__m128 c3 = _mm_loadu_ps(m + 12);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(out + 0, c0);
+			_mm_storeu_ps(out + 4, c1);
+			_mm_storeu_ps(out + 8, c2);
+			_mm_storeu_ps(out + 12, c3);
+		}
+		//Cramer's rule, after Intel's "Streaming SIMD Extensions - Inverse of 4x4 Matrix" (AP-928).
+		//Pairs of 2x2 determinants are computed 4 at a time with shuffles.
+		float mat4InverseSSE(const float* src, float* out) {
+			__m128 c0 = _mm_loadu_ps(src + 0);
+			__m128 c1 = _mm_loadu_ps(src + 4);
+			__m128 c2 = _mm_loadu_ps(src + 8);
+			__m128 c3 = _mm_loadu_ps(src + 12);
+			//Rows 0,1 and 2,3 are loaded in the interleaved order the algorithm expects
+			__m128 tmp = _mm_movelh_ps(c0, c1);
+			__m128 row1 = _mm_movelh_ps(c2, c3);
+			__m128 row0 = _mm_shuffle_ps(tmp, row1, 0x88);
+			row1 = _mm_shuffle_ps(row1, tmp, 0xDD);
+			tmp = _mm_movehl_ps(c1, c0);
+			__m128 row3 = _mm_movehl_ps(c3, c2);
+			__m128 row2 = _mm_shuffle_ps(tmp, row3, 0x88);
+			row3 = _mm_shuffle_ps(row3, tmp, 0xDD);
+
+			__m128 minor0, minor1, minor2, minor3;
+
+			tmp = _mm_mul_ps(row2, row3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor0 = _mm_mul_ps(row1, tmp);
+			minor1 = _mm_mul_ps(row0, tmp);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp), minor0);
+			minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor1);
+			minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+			tmp = _mm_mul_ps(row1, row2);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor0);
+			minor3 = _mm_mul_ps(row0, tmp);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp));
+			minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor3);
+			minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+			tmp = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+			minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor0);
+			minor2 = _mm_mul_ps(row0, tmp);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp));
+			minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor2);
+			minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+			tmp = _mm_mul_ps(row0, row1);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor2);
+			minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp), minor3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp), minor2);
+			minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp));
+
+			tmp = _mm_mul_ps(row0, row3);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp));
+			minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor2);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor1);
+			minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp));
+
+			tmp = _mm_mul_ps(row0, row2);
+			tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+			minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor1);
+			minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp));
+			tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+			minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp));
+			minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor3);
+
+			__m128 det = _mm_mul_ps(row0, minor0);
+			det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+			det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+			const float d = _mm_cvtss_f32(det);
+			if (d == 0.0f)
+				return 0.0f;
+			const __m128 invDet = _mm_set1_ps(1.0f / d);
+			_mm_storeu_ps(out + 0, _mm_mul_ps(invDet, minor0));
+			_mm_storeu_ps(out + 4, _mm_mul_ps(invDet, minor1));
+			_mm_storeu_ps(out + 8, _mm_mul_ps(invDet, minor2));
+			_mm_storeu_ps(out + 12, _mm_mul_ps(invDet, minor3));
+			return d;
+		}
+		//Computes two result columns per 256 bit register.
+		//Each 128 bit lane holds one column of l, shuffles broadcast the matching element of r within each lane.
+		EW_TARGET_AVX void mat4MulAVX(const float* l, const float* r, float* out) {
+			const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 0));
+			const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 4));
+			const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 8));
+			const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 12));
+			const __m256 r01 = _mm256_loadu_ps(r + 0);
+			const __m256 r23 = _mm256_loadu_ps(r + 8);
+
+			__m256 a = _mm256_mul_ps(c0, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(0, 0, 0, 0)));
+			a = _mm256_add_ps(a, _mm256_mul_ps(c1, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(1, 1, 1, 1))));
+			a = _mm256_add_ps(a, _mm256_mul_ps(c2, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(2, 2, 2, 2))));
+			a = _mm256_add_ps(a, _mm256_mul_ps(c3, _mm256_shuffle_ps(r01, r01, _MM_SHUFFLE(3, 3, 3, 3))));
+
+			__m256 b = _mm256_mul_ps(c0, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(0, 0, 0, 0)));
+			b = _mm256_add_ps(b, _mm256_mul_ps(c1, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(1, 1, 1, 1))));
+			b = _mm256_add_ps(b, _mm256_mul_ps(c2, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(2, 2, 2, 2))));
+			b = _mm256_add_ps(b, _mm256_mul_ps(c3, _mm256_shuffle_ps(r23, r23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+			_mm256_storeu_ps(out + 0, a);
+			_mm256_storeu_ps(out + 8, b);
+		}
+
+		SimdLevel detect() {
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			const bool sse41 = (info[2] & (1 << 19)) != 0;
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			const bool fma = (info[2] & (1 << 12)) != 0;
+			const bool f16c = (info[2] & (1 << 29)) != 0;
+			//OS must save the upper halves of ymm registers on context switch
+			const bool ymmEnabled = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+			__cpuidex(info, 7, 0);
+			const bool avx2 = (info[1] & (1 << 5)) != 0;
+			if (ymmEnabled && avx && avx2 && fma && f16c)
+				return SimdLevel::AVX2;
+			if (ymmEnabled && avx)
+				return SimdLevel::AVX;
+			return sse41 ? SimdLevel::SSE : SimdLevel::SCALAR;
+#else
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))
+				return SimdLevel::AVX2;
+			if (__builtin_cpu_supports("avx"))
+				return SimdLevel::AVX;
+			if (__builtin_cpu_supports("sse4.1"))
+				return SimdLevel::SSE;
+			return SimdLevel::SCALAR;
+#endif
+		}
+#else
+		SimdLevel detect() {
+			return SimdLevel::SCALAR;
+		}
+#endif
+
+		SimdLevel s_level = SimdLevel::SCALAR;
+	}
+
+	namespace simd {
+		//Scalar until SetSimdLevel runs during static initialization below
+		void (*Mat4Mul)(const float* l, const float* r, float* out) = mat4MulScalar;
+		void (*Mat4MulVec4)(const float* m, const float* v, float* out) = mat4MulVec4Scalar;
+		void (*Mat4Transpose)(const float* m, float* out) = mat4TransposeScalar;
+		float (*Mat4Inverse)(const float* m, float* out) = mat4InverseScalar;
+	}
+
+	SimdLevel DetectSimdLevel() {
+		static const SimdLevel detected = detect();
+		return detected;
+	}
+
+	SimdLevel GetSimdLevel() {
+		return s_level;
+	}
+
+	SimdLevel SetSimdLevel(SimdLevel level) {
+		SimdLevel supported = DetectSimdLevel();
+		if (level > supported)
+			level = supported;
+		s_level = level;
+		simd::Mat4Mul = mat4MulScalar;
+		simd::Mat4MulVec4 = mat4MulVec4Scalar;
+		simd::Mat4Transpose = mat4TransposeScalar;
+		simd::Mat4Inverse = mat4InverseScalar;
+#if EW_SIMD_X86
+		if (level >= SimdLevel::SSE) {
+			simd::Mat4Mul = mat4MulSSE;
+			simd::Mat4MulVec4 = mat4MulVec4SSE;
+			simd::Mat4Transpose = mat4TransposeSSE;
+			simd::Mat4Inverse = mat4InverseSSE;
+		}
+		if (level >= SimdLevel::AVX) {
+			simd::Mat4Mul = mat4MulAVX;
+		}
+#endif
+		return level;
+	}
+
+	const char* SimdLevelName(SimdLevel level) {
+		switch (level) {
+		case SimdLevel::SSE: return "SSE4.1";
+		case SimdLevel::AVX: return "AVX";
+		case SimdLevel::AVX2: return "AVX2";
+		default: return "Scalar";
+		}
+	}
+
+	//Pick the best backend before main() runs
+	static const SimdLevel s_initialLevel = SetSimdLevel(SimdLevel::AVX2);
+}
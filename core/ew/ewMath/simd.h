@@ -0,0 +1,47 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+#pragma once
+
+//x86 builds get SSE/AVX kernels, everything else uses the scalar code paths
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define EW_SIMD_X86 1
+#else
+#define EW_SIMD_X86 0
+#endif
+
+//GCC/Clang need per-function target attributes to emit AVX instructions without -mavx.
+//MSVC allows intrinsics from any instruction set without flags.
+#if EW_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define EW_TARGET_AVX __attribute__((target("avx")))
+#define EW_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#else
+#define EW_TARGET_AVX
+#define EW_TARGET_AVX2
+#endif
+
+namespace ew {
+	//Instruction set used by the dispatched math kernels
+	enum class SimdLevel {
+		SCALAR = 0,
+		SSE = 1,
+		AVX = 2,
+		AVX2 = 3 //Also requires FMA and F16C
+	};
+
+	/// <summary>
+	/// Queries the CPU (and OS register support) for the highest usable instruction set.
+	/// </summary>
+	SimdLevel DetectSimdLevel();
+	/// <summary>
+	/// Returns the instruction set currently used by dispatched kernels.
+	/// </summary>
+	SimdLevel GetSimdLevel();
+	/// <summary>
+	/// Forces dispatched kernels to a given instruction set. Clamped to what the CPU supports.
+	/// Useful for comparing backends. Returns the level actually selected.
+	/// </summary>
+	SimdLevel SetSimdLevel(SimdLevel level);
+	const char* SimdLevelName(SimdLevel level);
+}
@@ -0,0 +1,110 @@
+/*
+	Author: Eric Winebrenner
+*/
+
+//AVX2 helpers shared by the batched kernels. Only include this from .cpp files,
+//and only call these functions from functions marked EW_TARGET_AVX2.
+
+#pragma once
+#include "simd.h"
+
+#if EW_SIMD_X86
+#include <immintrin.h>
+
+namespace ew {
+	namespace simd {
+		/// <summary>
+		/// Computes sin and cos of 8 floats at once (Cephes style polynomial, ~1e-7 max error for |x| < 8192).
+		/// </summary>
+		EW_TARGET_AVX2 inline void SinCos8(__m256 x, __m256* s, __m256* c) {
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			__m256 signSin = _mm256_and_ps(x, signMask);
+			x = _mm256_andnot_ps(signMask, x);
+
+			//Reduce to [-pi/4, pi/4] and track which octant we were in
+			__m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(1.27323954473516f)));
+			j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+			__m256 y = _mm256_cvtepi32_ps(j);
+
+			__m256 swapSignSin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+			__m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+			__m256 signCos = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+			signSin = _mm256_xor_ps(signSin, swapSignSin);
+
+			//Extended precision modular arithmetic
+			x = _mm256_fmadd_ps(y, _mm256_set1_ps(-0.78515625f), x);
+			x = _mm256_fmadd_ps(y, _mm256_set1_ps(-2.4187564849853515625e-4f), x);
+			x = _mm256_fmadd_ps(y, _mm256_set1_ps(-3.77489497744594108e-8f), x);
+
+			const __m256 z = _mm256_mul_ps(x, x);
+			__m256 cosPoly = _mm256_set1_ps(2.443315711809948e-5f);
+			cosPoly = _mm256_fmadd_ps(cosPoly, z, _mm256_set1_ps(-1.388731625493765e-3f));
+			cosPoly = _mm256_fmadd_ps(cosPoly, z, _mm256_set1_ps(4.166664568298827e-2f));
+			cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+			cosPoly = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), cosPoly);
+			cosPoly = _mm256_add_ps(cosPoly, _mm256_set1_ps(1.0f));
+
+			__m256 sinPoly = _mm256_set1_ps(-1.9515295891e-4f);
+			sinPoly = _mm256_fmadd_ps(sinPoly, z, _mm256_set1_ps(8.3321608736e-3f));
+			sinPoly = _mm256_fmadd_ps(sinPoly, z, _mm256_set1_ps(-1.6666654611e-1f));
+			sinPoly = _mm256_fmadd_ps(_mm256_mul_ps(sinPoly, z), x, x);
+
+			//Octants 1,2,5,6 swap the sin and cos polynomials
+			__m256 sinResult = _mm256_blendv_ps(cosPoly, sinPoly, polyMask);
+			__m256 cosResult = _mm256_blendv_ps(sinPoly, cosPoly, polyMask);
+			*s = _mm256_xor_ps(sinResult, signSin);
+			*c = _mm256_xor_ps(cosResult, signCos);
+		}
+
+		/// <summary>
+		/// Transposes 4 SoA registers (a,b,c,d) of 8 lanes into 8 float4 (a[i],b[i],c[i],d[i]).
+		/// Lane i is stored at dst + i * stride floats. Unaligned stores.
+		/// </summary>
+		EW_TARGET_AVX2 inline void StoreTransposed4x8(__m256 a, __m256 b, __m256 c, __m256 d, float* dst, size_t stride) {
+			const __m256 t0 = _mm256_unpacklo_ps(a, b);
+			const __m256 t1 = _mm256_unpackhi_ps(a, b);
+			const __m256 t2 = _mm256_unpacklo_ps(c, d);
+			const __m256 t3 = _mm256_unpackhi_ps(c, d);
+			const __m256 v0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 v1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 v2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 v3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			_mm_storeu_ps(dst + 0 * stride, _mm256_castps256_ps128(v0));
+			_mm_storeu_ps(dst + 1 * stride, _mm256_castps256_ps128(v1));
+			_mm_storeu_ps(dst + 2 * stride, _mm256_castps256_ps128(v2));
+			_mm_storeu_ps(dst + 3 * stride, _mm256_castps256_ps128(v3));
+			_mm_storeu_ps(dst + 4 * stride, _mm256_extractf128_ps(v0, 1));
+			_mm_storeu_ps(dst + 5 * stride, _mm256_extractf128_ps(v1, 1));
+			_mm_storeu_ps(dst + 6 * stride, _mm256_extractf128_ps(v2, 1));
+			_mm_storeu_ps(dst + 7 * stride, _mm256_extractf128_ps(v3, 1));
+		}
+
+		/// <summary>
+		/// Loads 8 structs of 8 floats (src + i * stride floats) and transposes them so out[j] holds field j of all 8.
+		/// Unaligned loads.
+		/// </summary>
+		EW_TARGET_AVX2 inline void LoadTransposed8x8(const float* src, size_t stride, __m256 out[8]) {
+			//Pair rows i and i + 4 so each 128 bit half holds one struct
+			__m256 r[8];
+			for (int i = 0; i < 4; i++)
+			{
+				const __m256 lo = _mm256_loadu_ps(src + i * stride);
+				const __m256 hi = _mm256_loadu_ps(src + (i + 4) * stride);
+				r[i] = _mm256_permute2f128_ps(lo, hi, 0x20);
+				r[i + 4] = _mm256_permute2f128_ps(lo, hi, 0x31);
+			}
+			for (int h = 0; h < 8; h += 4)
+			{
+				const __m256 t0 = _mm256_unpacklo_ps(r[h + 0], r[h + 1]);
+				const __m256 t1 = _mm256_unpackhi_ps(r[h + 0], r[h + 1]);
+				const __m256 t2 = _mm256_unpacklo_ps(r[h + 2], r[h + 3]);
+				const __m256 t3 = _mm256_unpackhi_ps(r[h + 2], r[h + 3]);
+				out[h + 0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+				out[h + 1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+				out[h + 2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				out[h + 3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			}
+		}
+	}
+}
+#endif
@@ -8,7 +8,7 @@
 
 namespace ew {
 	//Identity matrix
-	inline ew::Mat4 Identity() {
+	inline constexpr ew::Mat4 Identity() {
 		return ew::Mat4(
 			1, 0, 0, 0,
 			0, 1, 0, 0,
@@ -17,7 +17,7 @@ namespace ew {
 		);
 	};
 	//Scale on x,y,z axes
-	inline ew::Mat4 Scale(const ew::Vec3& s) {
+	inline constexpr ew::Mat4 Scale(const ew::Vec3& s) {
 		return ew::Mat4(
 			s.x, 0, 0, 0,
 			0, s.y, 0, 0,
@@ -59,7 +59,7 @@ namespace ew {
 		);
 	};
 	//Translate x,y,z
-	inline ew::Mat4 Translate(const ew::Vec3& t) {
+	inline constexpr ew::Mat4 Translate(const ew::Vec3& t) {
 		return Mat4(
 			1.0f, 0.0f, 0.0f, t.x,
 			0.0f, 1.0f, 0.0f, t.y,
@@ -68,6 +68,66 @@ namespace ew {
 		);
 	};
 
+	//Rotation matrix equal to RotateY(r.y) * RotateX(r.x) * RotateZ(r.z), in radians.
+	//Written out in closed form so only 3 sin/cos pairs are needed. Row major.
+	inline void EulerYXZ(const ew::Vec3& r, float m[3][3]) {
+		const float cx = cosf(r.x), sx = sinf(r.x);
+		const float cy = cosf(r.y), sy = sinf(r.y);
+		const float cz = cosf(r.z), sz = sinf(r.z);
+		m[0][0] = cy * cz + sy * sx * sz; m[0][1] = sy * sx * cz - cy * sz; m[0][2] = sy * cx;
+		m[1][0] = cx * sz;                m[1][1] = cx * cz;                m[1][2] = -sx;
+		m[2][0] = cy * sx * sz - sy * cz; m[2][1] = sy * sz + cy * sx * cz; m[2][2] = cy * cx;
+	}
+	//Translate(t) * R * Scale(s) without any matrix multiplies. R is a row major 3x3 rotation.
+	inline constexpr ew::Mat4 TRS(const ew::Vec3& t, const float m[3][3], const ew::Vec3& s) {
+		return ew::Mat4(
+			m[0][0] * s.x, m[0][1] * s.y, m[0][2] * s.z, t.x,
+			m[1][0] * s.x, m[1][1] * s.y, m[1][2] * s.z, t.y,
+			m[2][0] * s.x, m[2][1] * s.y, m[2][2] * s.z, t.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+	//Inverse of TRS(t,R,s) = Scale(1/s) * transpose(R) * Translate(-t). Scale must be non-zero.
+	inline constexpr ew::Mat4 InverseTRS(const ew::Vec3& t, const float m[3][3], const ew::Vec3& s) {
+		const ew::Vec3 is = ew::Vec3(1.0f / s.x, 1.0f / s.y, 1.0f / s.z);
+		const ew::Vec3 r0 = ew::Vec3(m[0][0], m[1][0], m[2][0]) * is.x;
+		const ew::Vec3 r1 = ew::Vec3(m[0][1], m[1][1], m[2][1]) * is.y;
+		const ew::Vec3 r2 = ew::Vec3(m[0][2], m[1][2], m[2][2]) * is.z;
+		return ew::Mat4(
+			r0.x, r0.y, r0.z, -ew::Dot(r0, t),
+			r1.x, r1.y, r1.z, -ew::Dot(r1, t),
+			r2.x, r2.y, r2.z, -ew::Dot(r2, t),
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+	//transpose(inverse(mat3(TRS(t,R,s)))) = R * Scale(1/s). Used to transform normals.
+	//Returned in the upper 3x3 of a Mat4. Scale must be non-zero.
+	inline constexpr ew::Mat4 NormalMatrixTRS(const float m[3][3], const ew::Vec3& s) {
+		const ew::Vec3 is = ew::Vec3(1.0f / s.x, 1.0f / s.y, 1.0f / s.z);
+		return ew::Mat4(
+			m[0][0] * is.x, m[0][1] * is.y, m[0][2] * is.z, 0.0f,
+			m[1][0] * is.x, m[1][1] * is.y, m[1][2] * is.z, 0.0f,
+			m[2][0] * is.x, m[2][1] * is.y, m[2][2] * is.z, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+	//Euler versions. Rotation r is in radians, applied as RotateY * RotateX * RotateZ
+	inline ew::Mat4 TRS(const ew::Vec3& t, const ew::Vec3& r, const ew::Vec3& s) {
+		float m[3][3];
+		EulerYXZ(r, m);
+		return TRS(t, m, s);
+	}
+	inline ew::Mat4 InverseTRS(const ew::Vec3& t, const ew::Vec3& r, const ew::Vec3& s) {
+		float m[3][3];
+		EulerYXZ(r, m);
+		return InverseTRS(t, m, s);
+	}
+	inline ew::Mat4 NormalMatrixTRS(const ew::Vec3& r, const ew::Vec3& s) {
+		float m[3][3];
+		EulerYXZ(r, m);
+		return NormalMatrixTRS(m, s);
+	}
+
 	inline ew::Mat4 LookAt(const ew::Vec3& eyePos, const ew::Vec3& targetPos, const ew::Vec3& up) {
 		ew::Vec3 f = ew::Normalize(eyePos - targetPos);
 		ew::Vec3 r = ew::Normalize(ew::Cross(up, f));
@@ -91,21 +151,17 @@ namespace ew {
 		return m;
 	}
 
-	inline ew::Mat4 Orthographic(float height, float a, float n, float f) {
+	inline constexpr ew::Mat4 Orthographic(float height, float a, float n, float f) {
 		//Symmetrical bounds based on aspect ratio
-		float t = height / 2;
-		float b = -t;
-		float r = (height * a) / 2;
-		float l = -r;
-
-		Mat4 m = Mat4(0);
-		m[0][0] = 2 / (r - l);
-		m[1][1] = 2 / (t - b);
-		m[2][2] = -2 / (f - n);
-		m[3][0] = -(r + l) / (r - l);
-		m[3][1] = -(t + b) / (t - b);
-		m[3][2] = -(f + n) / (f - n);
-		m[3][3] = 1.0f;
-		return m;
+		const float t = height / 2;
+		const float b = -t;
+		const float r = (height * a) / 2;
+		const float l = -r;
+		return Mat4(
+			2 / (r - l), 0.0f, 0.0f, -(r + l) / (r - l),
+			0.0f, 2 / (t - b), 0.0f, -(t + b) / (t - b),
+			0.0f, 0.0f, -2 / (f - n), -(f + n) / (f - n),
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
 	}
 }
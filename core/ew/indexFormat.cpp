@@ -0,0 +1,97 @@
+#include "indexFormat.h"
+#include "external/glad.h"
+#include <cstdint>
+#include <cstring>
+
+namespace ew {
+	namespace {
+		template<typename T>
+		void narrow(const unsigned int* indices, size_t count, unsigned int baseVertex, T* out) {
+			for (size_t i = 0; i < count; i++)
+			{
+				out[i] = (T)(indices[i] - baseVertex);
+			}
+		}
+
+		//Greedily grows runs of whole triangles while their index span fits in 16 bits
+		std::vector<IndexRange> splitRanges(const unsigned int* indices, size_t count) {
+			std::vector<IndexRange> ranges;
+			IndexRange current;
+			unsigned int lo = 0, hi = 0;
+			for (size_t i = 0; i + 3 <= count; i += 3)
+			{
+				unsigned int triLo = indices[i], triHi = indices[i];
+				for (size_t j = 1; j < 3; j++)
+				{
+					triLo = indices[i + j] < triLo ? indices[i + j] : triLo;
+					triHi = indices[i + j] > triHi ? indices[i + j] : triHi;
+				}
+				const unsigned int newLo = current.count > 0 && lo < triLo ? lo : triLo;
+				const unsigned int newHi = current.count > 0 && hi > triHi ? hi : triHi;
+				if (current.count > 0 && newHi - newLo > 0xffff) {
+					current.baseVertex = (int)lo;
+					ranges.push_back(current);
+					current.firstIndex = (unsigned int)i;
+					current.count = 0;
+					lo = triLo;
+					hi = triHi;
+				}
+				else {
+					lo = newLo;
+					hi = newHi;
+				}
+				current.count += 3;
+			}
+			if (current.count > 0) {
+				current.baseVertex = (int)lo;
+				ranges.push_back(current);
+			}
+			return ranges;
+		}
+	}
+
+	unsigned int GLIndexType(IndexType type)
+	{
+		switch (type) {
+		case IndexType::UINT8:
+			return GL_UNSIGNED_BYTE;
+		case IndexType::UINT16:
+			return GL_UNSIGNED_SHORT;
+		default:
+			return GL_UNSIGNED_INT;
+		}
+	}
+
+	PackedIndices packIndices(const unsigned int* indices, size_t count, size_t vertexCount, bool allowSplit)
+	{
+		PackedIndices packed;
+		packed.type = IndexTypeForVertexCount(vertexCount);
+		if (allowSplit && packed.type == IndexType::UINT32 && count % 3 == 0) {
+			std::vector<IndexRange> ranges = splitRanges(indices, count);
+			if (ranges.size() > 0 && ranges.size() * MIN_INDICES_PER_RANGE <= count) {
+				packed.type = IndexType::UINT16;
+				packed.ranges = ranges;
+			}
+		}
+		packed.data.resize(count * IndexSize(packed.type));
+		switch (packed.type) {
+		case IndexType::UINT8:
+			narrow(indices, count, 0, (uint8_t*)packed.data.data());
+			break;
+		case IndexType::UINT16:
+			if (packed.ranges.empty()) {
+				narrow(indices, count, 0, (uint16_t*)packed.data.data());
+				break;
+			}
+			for (const IndexRange& r : packed.ranges)
+			{
+				narrow(indices + r.firstIndex, r.count, (unsigned int)r.baseVertex, (uint16_t*)packed.data.data() + r.firstIndex);
+			}
+			break;
+		case IndexType::UINT32:
+			memcpy(packed.data.data(), indices, count * sizeof(unsigned int));
+			break;
+		}
+		return packed;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace ew {
+	enum class IndexType {
+		//Still drawn and loaded (e.g. from older .ewmesh files), but never chosen by packIndices
+		UINT8 = 0,
+		UINT16 = 1,
+		UINT32 = 2
+	};
+
+	//Smallest index type that can address vertexCount vertices, at least 16 bit.
+	//Many desktop drivers emulate 8 bit indices, which costs more than the bytes saved.
+	inline constexpr IndexType IndexTypeForVertexCount(size_t vertexCount) {
+		return vertexCount <= 0x10000 ? IndexType::UINT16 : IndexType::UINT32;
+	}
+	//In bytes
+	inline constexpr unsigned int IndexSize(IndexType type) {
+		return type == IndexType::UINT8 ? 1 : (type == IndexType::UINT16 ? 2 : 4);
+	}
+	//GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	unsigned int GLIndexType(IndexType type);
+
+	//A part of an index buffer drawn with its own base vertex
+	struct IndexRange {
+		unsigned int firstIndex = 0;
+		unsigned int count = 0;
+		int baseVertex = 0;
+	};
+
+	//Meshes over 64K vertices are only split into 16 bit ranges if the ranges average at least this many indices,
+	//so the saved bandwidth outweighs the extra draw calls
+	constexpr size_t MIN_INDICES_PER_RANGE = 16384;
+
+	struct PackedIndices {
+		IndexType type = IndexType::UINT32;
+		std::vector<unsigned char> data;
+		//Empty when the whole buffer is drawn at once with base vertex 0
+		std::vector<IndexRange> ranges;
+	};
+
+	/// <summary>
+	/// Converts triangle list indices to the smallest type the vertex count allows (see IndexTypeForVertexCount).
+	/// Meshes with more than 64K vertices are split into runs of whole triangles that each span under 64K vertices,
+	/// stored as 16 bit offsets from a base vertex, when that takes few enough ranges. 32 bit indices are kept otherwise.
+	/// </summary>
+	/// <param name="allowSplit">False keeps the buffer in one index type with base vertex 0, e.g. when parts of it are drawn separately</param>
+	PackedIndices packIndices(const unsigned int* indices, size_t count, size_t vertexCount, bool allowSplit = true);
+}
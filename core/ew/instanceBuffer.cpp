@@ -0,0 +1,91 @@
+#include "instanceBuffer.h"
+#include "external/glad.h"
+
+namespace ew {
+	InstanceBuffer::InstanceBuffer(bool includeNormalMatrix)
+		:m_includeNormalMatrix(includeNormalMatrix)
+	{
+		m_stride = sizeof(float) * (16 + (includeNormalMatrix ? 9 : 0));
+		glGenBuffers(1, &m_vbo);
+	}
+
+	InstanceBuffer::~InstanceBuffer()
+	{
+		glDeleteBuffers(1, &m_vbo);
+	}
+
+	void InstanceBuffer::pushInstance(const ew::Mat4& model, const ew::Mat4& normalMatrix)
+	{
+		m_staging.insert(m_staging.end(), &model[0][0], &model[0][0] + 16);
+		if (m_includeNormalMatrix) {
+			for (int col = 0; col < 3; col++)
+			{
+				m_staging.insert(m_staging.end(), &normalMatrix[col][0], &normalMatrix[col][0] + 3);
+			}
+		}
+	}
+
+	void InstanceBuffer::update(const ew::Mat4* models, size_t count)
+	{
+		m_staging.clear();
+		m_staging.reserve(count * m_stride / sizeof(float));
+		for (size_t i = 0; i < count; i++)
+		{
+			pushInstance(models[i], m_includeNormalMatrix ? ew::NormalMatrix(models[i]) : models[i]);
+		}
+		m_count = count;
+		upload();
+	}
+
+	void InstanceBuffer::update(const ew::Transform* transforms, size_t count)
+	{
+		m_staging.clear();
+		m_staging.reserve(count * m_stride / sizeof(float));
+		for (size_t i = 0; i < count; i++)
+		{
+			const ew::Mat4& model = transforms[i].getModelMatrix();
+			pushInstance(model, m_includeNormalMatrix ? transforms[i].getNormalMatrix() : model);
+		}
+		m_count = count;
+		upload();
+	}
+
+	void InstanceBuffer::upload()
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		const size_t bytes = m_count * m_stride;
+		if (m_count > m_capacity) {
+			m_capacity = m_count > m_capacity * 2 ? m_count : m_capacity * 2;
+		}
+		//Reallocating every update orphans the old storage, so we don't wait on draws still reading it.
+		//The buffer name stays the same, so VAOs using it stay valid.
+		glBufferData(GL_ARRAY_BUFFER, m_capacity * m_stride, NULL, GL_STREAM_DRAW);
+		if (bytes > 0) {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_staging.data());
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void InstanceBuffer::setAttributes() const
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		//A mat4 attribute takes 4 consecutive locations, one per column
+		for (unsigned int col = 0; col < 4; col++)
+		{
+			const unsigned int location = INSTANCE_MODEL_LOCATION + col;
+			glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, m_stride, (const void*)(sizeof(float) * 4 * col));
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1);
+		}
+		if (m_includeNormalMatrix) {
+			for (unsigned int col = 0; col < 3; col++)
+			{
+				const unsigned int location = INSTANCE_NORMAL_MATRIX_LOCATION + col;
+				glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, m_stride, (const void*)(sizeof(float) * (16 + 3 * col)));
+				glEnableVertexAttribArray(location);
+				glVertexAttribDivisor(location, 1);
+			}
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "ewMath/ewMath.h"
+#include "transform.h"
+
+namespace ew {
+	//Attribute locations used by instanced shaders. 0-2 are the Vertex attributes.
+	//layout(location = 3) in mat4 _Model;        (uses locations 3-6)
+	//layout(location = 7) in mat3 _NormalMatrix; (uses locations 7-9, optional)
+	constexpr unsigned int INSTANCE_MODEL_LOCATION = 3;
+	constexpr unsigned int INSTANCE_NORMAL_MATRIX_LOCATION = 7;
+
+	/// <summary>
+	/// GPU buffer of per instance matrices, read as vertex attributes that advance once per instance.
+	/// Attach to a mesh with Mesh::setInstanceBuffer, then draw with Mesh::drawInstanced.
+	/// </summary>
+	class InstanceBuffer {
+	public:
+		/// <param name="includeNormalMatrix">Also stream a mat3 normal matrix per instance</param>
+		InstanceBuffer(bool includeNormalMatrix = false);
+		~InstanceBuffer();
+		InstanceBuffer(const InstanceBuffer&) = delete;
+		InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+		//Uploads model matrices. Normal matrices (if enabled) are derived from them.
+		void update(const ew::Mat4* models, size_t count);
+		//Uploads cached model and normal matrices from transforms
+		void update(const ew::Transform* transforms, size_t count);
+
+		//Sets up instanced attributes on the currently bound VAO. Called by Mesh::setInstanceBuffer.
+		void setAttributes()const;
+
+		inline size_t getCount()const { return m_count; }
+		inline bool hasNormalMatrix()const { return m_includeNormalMatrix; }
+	private:
+		void upload();
+		void pushInstance(const ew::Mat4& model, const ew::Mat4& normalMatrix);
+
+		bool m_includeNormalMatrix;
+		unsigned int m_vbo = 0;
+		size_t m_count = 0;
+		size_t m_capacity = 0; //In instances
+		unsigned int m_stride; //In bytes
+		std::vector<float> m_staging;
+	};
+}
@@ -0,0 +1,79 @@
+#include "lod.h"
+#include "simplify.h"
+#include "meshOptimizer.h"
+
+namespace ew {
+	void generateLODChain(MeshData& mesh, const std::vector<float>& ratios, float maxError)
+	{
+		if (mesh.vertices.empty() || mesh.indices.size() < 3)
+			return;
+		const float radius = mesh.hasBounds ? mesh.bounds.sphere.radius
+			: computeBounds(mesh.vertices.data(), mesh.vertices.size()).sphere.radius;
+		if (mesh.lods.empty()) {
+			MeshLOD full;
+			full.indexCount = (unsigned int)mesh.indices.size();
+			mesh.lods.push_back(full);
+		}
+		const size_t triangleCount = mesh.lods[0].indexCount / 3;
+		for (float ratio : ratios)
+		{
+			//Copied since appending to mesh.indices can reallocate
+			const MeshLOD previous = mesh.lods.back();
+			const size_t target = (size_t)(triangleCount * ratio) * 3;
+			if (target >= previous.indexCount)
+				continue;
+			float error = 0.0f;
+			std::vector<unsigned int> indices = simplifyMesh(mesh.vertices.data(), mesh.vertices.size(),
+				mesh.indices.data() + previous.firstIndex, previous.indexCount, target, &error);
+			if (indices.empty() || indices.size() >= previous.indexCount)
+				continue;
+			//Errors add up since each level is simplified from the last
+			const float lodError = previous.error + (radius > 0.0f ? error / radius : 0.0f);
+			//Coarser levels would only be worse
+			if (lodError > maxError)
+				break;
+			optimizeVertexCache(indices.data(), indices.size(), mesh.vertices.size());
+
+			MeshLOD lod;
+			lod.firstIndex = (unsigned int)mesh.indices.size();
+			lod.indexCount = (unsigned int)indices.size();
+			lod.error = lodError;
+			mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+			mesh.lods.push_back(lod);
+		}
+	}
+
+	void generateLODChain(MeshData& mesh)
+	{
+		generateLODChain(mesh, { 0.5f, 0.25f, 0.1f, 1.0f / 30.0f });
+	}
+
+	float projectedRadius(const ew::Camera& camera, const BoundingSphere& sphere, float screenHeight)
+	{
+		if (camera.orthographic) {
+			return sphere.radius / (camera.orthoHeight * 0.5f) * (screenHeight * 0.5f);
+		}
+		const float distance = ew::Magnitude(sphere.center - camera.position);
+		//Inside the sphere it covers the whole screen
+		if (distance <= sphere.radius)
+			return screenHeight;
+		const float tanHalfFov = tanf(ew::Radians(camera.fov) * 0.5f);
+		return sphere.radius / (distance * tanHalfFov) * (screenHeight * 0.5f);
+	}
+
+	int selectLOD(const Mesh& mesh, const ew::Mat4& model, const ew::Camera& camera, float screenHeight, float maxPixelError)
+	{
+		const std::vector<MeshLOD>& lods = mesh.getLODs();
+		if (lods.size() < 2)
+			return 0;
+		const float radiusPixels = projectedRadius(camera, transformSphere(mesh.getBoundingSphere(), model), screenHeight);
+		int lod = 0;
+		for (int i = 1; i < (int)lods.size(); i++)
+		{
+			if (lods[i].error * radiusPixels > maxPixelError)
+				break;
+			lod = i;
+		}
+		return lod;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "camera.h"
+
+namespace ew {
+	//Default bound on a level's error, relative to the bounding sphere radius. Past this a mesh no longer keeps its shape
+	//(a 64 segment sphere at 1/30 of its triangles is a blob with its centroid 0.9 radii off).
+	constexpr float LOD_MAX_ERROR = 0.25f;
+
+	/// <summary>
+	/// Simplifies the mesh to each ratio of its triangle count and appends the results to mesh.indices,
+	/// filling mesh.lods with the ranges (full detail first). Each level is simplified from the one before
+	/// and cache optimized. Levels that fail to get smaller than the previous one are dropped.
+	/// </summary>
+	/// <param name="ratios">Target fraction of the original triangles per level, decreasing, e.g. 0.5, 0.25, 0.1</param>
+	/// <param name="maxError">The chain stops at the first level whose error (see MeshLOD::error) would exceed this</param>
+	void generateLODChain(MeshData& mesh, const std::vector<float>& ratios, float maxError = LOD_MAX_ERROR);
+	//Default chain of 1/2, 1/4, 1/10 and 1/30 of the triangles, within LOD_MAX_ERROR
+	void generateLODChain(MeshData& mesh);
+
+	/// <summary>
+	/// Radius in pixels of a world space sphere drawn by camera on a viewport screenHeight pixels tall
+	/// </summary>
+	float projectedRadius(const ew::Camera& camera, const BoundingSphere& sphere, float screenHeight);
+
+	/// <summary>
+	/// Picks the coarsest level whose error covers at most maxPixelError pixels on screen,
+	/// from the projected size of the mesh's bounding sphere under model.
+	/// </summary>
+	int selectLOD(const Mesh& mesh, const ew::Mat4& model, const ew::Camera& camera, float screenHeight, float maxPixelError = 1.0f);
+}
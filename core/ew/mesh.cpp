@@ -4,14 +4,44 @@
 
 #include "mesh.h"
 #include "ewMath/ewMath.h"
+#include "instanceBuffer.h"
 #include "external/glad.h"
 
 namespace ew {
-	Mesh::Mesh(const MeshData& meshData)
+	Mesh::Mesh(const MeshData& meshData, const VertexLayout& layout)
 	{
-		load(meshData);
+		load(meshData, layout);
 	}
-	void Mesh::load(const MeshData& meshData)
+	void Mesh::load(const MeshData& meshData, const VertexLayout& layout)
+	{
+		MeshView view;
+		view.layout = layout;
+		view.bounds = meshData.hasBounds ? meshData.bounds : computeBounds(meshData.vertices.data(), meshData.vertices.size());
+		view.vertexCount = meshData.vertices.size();
+		view.indexCount = meshData.indices.size();
+
+		std::vector<unsigned char> packedVertices;
+		if (layout.isDefault()) {
+			view.vertexData = meshData.vertices.data();
+		}
+		else {
+			packedVertices = packVertices(meshData.vertices, layout, view.bounds.box);
+			view.vertexData = packedVertices.data();
+		}
+		//LODs and meshlets are drawn as plain ranges of the buffer, so it can't be split into base vertex ranges
+		const bool allowSplit = meshData.lods.empty() && meshData.meshlets.empty();
+		PackedIndices packedIndices = packIndices(meshData.indices.data(), meshData.indices.size(), meshData.vertices.size(), allowSplit);
+		view.indexData = packedIndices.data.data();
+		view.indexType = packedIndices.type;
+		view.indexRanges = packedIndices.ranges.data();
+		view.indexRangeCount = packedIndices.ranges.size();
+		view.lods = meshData.lods.data();
+		view.lodCount = meshData.lods.size();
+		view.meshlets = meshData.meshlets.data();
+		view.meshletCount = meshData.meshlets.size();
+		load(view);
+	}
+	void Mesh::load(const MeshView& view)
 	{
 		if (!m_initialized) {
 			glGenVertexArrays(1, &m_vao);
@@ -22,17 +52,6 @@ namespace ew {
 
 			glGenBuffers(1, &m_ebo);
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-			//Position attribute
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
-			glEnableVertexAttribArray(0);
-
-			//Normal attribute
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
-			glEnableVertexAttribArray(1);
-
-			//UV attribute
-			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, uv)));
-			glEnableVertexAttribArray(2);
 
 			m_initialized = true;
 		}
@@ -40,29 +59,117 @@ namespace ew {
 		glBindVertexArray(m_vao);
 		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		//Layout can change between loads
+		setVertexAttributes(view.layout);
 
-		if (meshData.vertices.size() > 0) {
-			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * meshData.vertices.size(), meshData.vertices.data(), GL_STATIC_DRAW);
+		if (view.vertexCount > 0) {
+			glBufferData(GL_ARRAY_BUFFER, view.vertexCount * view.layout.stride(), view.vertexData, GL_STATIC_DRAW);
 		}
-		if (meshData.indices.size() > 0) {
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * meshData.indices.size(), meshData.indices.data(), GL_STATIC_DRAW);
+		if (view.indexCount > 0) {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, view.indexCount * IndexSize(view.indexType), view.indexData, GL_STATIC_DRAW);
 		}
-		m_numVertices = meshData.vertices.size();
-		m_numIndices = meshData.indices.size();
+		m_layout = view.layout;
+		m_bounds = view.bounds;
+		m_indexType = view.indexType;
+		m_indexRanges.assign(view.indexRanges, view.indexRanges + view.indexRangeCount);
+		m_lods.assign(view.lods, view.lods + view.lodCount);
+		m_meshlets.assign(view.meshlets, view.meshlets + view.meshletCount);
+		m_numVertices = (int)view.vertexCount;
+		m_numIndices = (int)view.indexCount;
 
 		glBindVertexArray(0);
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
+	void Mesh::unload()
+	{
+		if (!m_initialized)
+			return;
+		const unsigned int buffers[] = { m_vbo, m_ebo };
+		glDeleteBuffers(2, buffers);
+		glDeleteVertexArrays(1, &m_vao);
+		m_vao = m_vbo = m_ebo = 0;
+		m_initialized = false;
+		m_numVertices = 0;
+		m_numIndices = 0;
+		m_indexRanges.clear();
+		m_lods.clear();
+		m_meshlets.clear();
+	}
 	void Mesh::draw(ew::DrawMode drawMode) const
+	{
+		drawLOD(0, drawMode);
+	}
+	void Mesh::drawLOD(int lod, ew::DrawMode drawMode) const
 	{
 		glBindVertexArray(m_vao);
 		if (drawMode == DrawMode::TRIANGLES) {
-			glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, NULL);
+			drawElements(lod, false, 0);
 		}
 		else {
 			glDrawArrays(GL_POINTS, 0, m_numVertices);
 		}
-		
+	}
+	void Mesh::drawInstanced(int instanceCount, ew::DrawMode drawMode, int lod) const
+	{
+		if (instanceCount <= 0)
+			return;
+		glBindVertexArray(m_vao);
+		if (drawMode == DrawMode::TRIANGLES) {
+			drawElements(lod, true, instanceCount);
+		}
+		else {
+			glDrawArraysInstanced(GL_POINTS, 0, m_numVertices, instanceCount);
+		}
+	}
+	void Mesh::drawElements(int lod, bool instanced, int instanceCount) const
+	{
+		const GLenum indexType = GLIndexType(m_indexType);
+		const unsigned int indexSize = IndexSize(m_indexType);
+		if (!m_indexRanges.empty()) {
+			for (const IndexRange& r : m_indexRanges)
+			{
+				const void* offset = (const void*)((size_t)r.firstIndex * indexSize);
+				if (instanced)
+					glDrawElementsInstancedBaseVertex(GL_TRIANGLES, r.count, indexType, offset, instanceCount, r.baseVertex);
+				else
+					glDrawElementsBaseVertex(GL_TRIANGLES, r.count, indexType, offset, r.baseVertex);
+			}
+			return;
+		}
+		unsigned int first = 0;
+		unsigned int count = m_numIndices;
+		if (!m_lods.empty()) {
+			lod = lod < 0 ? 0 : (lod >= (int)m_lods.size() ? (int)m_lods.size() - 1 : lod);
+			first = m_lods[lod].firstIndex;
+			count = m_lods[lod].indexCount;
+		}
+		const void* offset = (const void*)((size_t)first * indexSize);
+		if (instanced)
+			glDrawElementsInstanced(GL_TRIANGLES, count, indexType, offset, instanceCount);
+		else
+			glDrawElements(GL_TRIANGLES, count, indexType, offset);
+	}
+	void Mesh::drawMeshlets(const unsigned int* meshletIndices, size_t count) const
+	{
+		if (count == 0)
+			return;
+		const unsigned int indexSize = IndexSize(m_indexType);
+		m_drawCounts.resize(count);
+		m_drawOffsets.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const Meshlet& m = m_meshlets[meshletIndices[i]];
+			m_drawCounts[i] = (int)m.indexCount;
+			m_drawOffsets[i] = (const void*)((size_t)m.firstIndex * indexSize);
+		}
+		glBindVertexArray(m_vao);
+		glMultiDrawElements(GL_TRIANGLES, m_drawCounts.data(), GLIndexType(m_indexType), m_drawOffsets.data(), (GLsizei)count);
+	}
+	void Mesh::setInstanceBuffer(const InstanceBuffer& buffer)
+	{
+		glBindVertexArray(m_vao);
+		buffer.setAttributes();
+		glBindVertexArray(0);
 	}
 }
\ No newline at end of file
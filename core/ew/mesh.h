@@ -4,6 +4,9 @@
 
 #pragma once
 #include "ewMath/ewMath.h"
+#include "bounds.h"
+#include "vertexLayout.h"
+#include "indexFormat.h"
 
 namespace ew {
 	struct Vertex {
@@ -12,11 +15,63 @@ namespace ew {
 		ew::Vec2 uv;
 	};
 
+	//Level of detail stored as a range of MeshData::indices
+	struct MeshLOD {
+		unsigned int firstIndex = 0;
+		unsigned int indexCount = 0;
+		//Geometric error relative to the bounding sphere radius. 0 for the full detail mesh.
+		float error = 0.0f;
+	};
+
+	//Limits of a meshlet, sized for mesh shader style workgroups
+	constexpr unsigned int MESHLET_MAX_VERTICES = 64;
+	constexpr unsigned int MESHLET_MAX_TRIANGLES = 124;
+
+	//Cluster of nearby triangles stored as a range of MeshData::indices (see meshlet.h)
+	struct Meshlet {
+		unsigned int firstIndex = 0;
+		unsigned int indexCount = 0;
+		//Bounding sphere
+		ew::Vec3 center = ew::Vec3(0.0f);
+		float radius = 0.0f;
+		//Every triangle normal is within the cone around axis. Cutoff is the sine of the cone's half angle,
+		//1 when the cone is too wide to ever cull.
+		ew::Vec3 coneAxis = ew::Vec3(0.0f, 0.0f, 1.0f);
+		float coneCutoff = 1.0f;
+	};
+
 	struct MeshData {
 		std::vector<Vertex> vertices;
 		std::vector<unsigned int> indices;
+		//Optional precomputed bounds (e.g. closed form from procGen). Computed from vertices on load otherwise.
+		//Reset hasBounds if vertices are modified afterwards.
+		Bounds bounds;
+		bool hasBounds = false;
+		//Optional LOD chain from generateLODChain, finest first. Empty means all indices are one level.
+		std::vector<MeshLOD> lods;
+		//Optional cluster table from buildMeshlets, covering the full detail triangles
+		std::vector<Meshlet> meshlets;
 	};
 
+	//Mesh data already in its GPU format, e.g. mapped from a .ewmesh file (see meshFile.h). Does not own its memory.
+	struct MeshView {
+		VertexLayout layout;
+		Bounds bounds;
+		const void* vertexData = nullptr; //vertexCount * layout.stride() bytes
+		size_t vertexCount = 0;
+		const void* indexData = nullptr; //indexCount * IndexSize(indexType) bytes
+		size_t indexCount = 0;
+		IndexType indexType = IndexType::UINT32;
+		const MeshLOD* lods = nullptr;
+		size_t lodCount = 0;
+		const IndexRange* indexRanges = nullptr;
+		size_t indexRangeCount = 0;
+		const Meshlet* meshlets = nullptr;
+		size_t meshletCount = 0;
+	};
+
+	class InstanceBuffer;
+
 	enum class DrawMode {
 		TRIANGLES = 0,
 		POINTS = 1
@@ -25,17 +80,64 @@ namespace ew {
 	class Mesh {
 	public:
 		Mesh() {};
-		Mesh(const MeshData& meshData);
-		void load(const MeshData& meshData);
+		Mesh(const MeshData& meshData, const VertexLayout& layout = VertexLayout());
+		//Uploads the vertices converted to layout. Positions are quantized against the mesh bounds.
+		//Indices are stored as 16 bit when the vertex count allows (see packIndices).
+		void load(const MeshData& meshData, const VertexLayout& layout = VertexLayout());
+		//Uploads packed data as is
+		void load(const MeshView& view);
+		//Deletes the GL objects. Meshes are copyable handles, so this is never done automatically.
+		void unload();
+		//Draws the full detail level
 		void draw(DrawMode drawMode = DrawMode::TRIANGLES)const;
+		//Draws one level of detail, e.g. from selectLOD. Clamped to the available levels.
+		void drawLOD(int lod, DrawMode drawMode = DrawMode::TRIANGLES)const;
+		//Draws instanceCount copies in one call, or nothing when it is 0. Per instance data comes from the buffer passed to setInstanceBuffer.
+		void drawInstanced(int instanceCount, DrawMode drawMode = DrawMode::TRIANGLES, int lod = 0)const;
+		/// <summary>
+		/// Draws a subset of meshlets, e.g. the output of cullMeshlets, in one glMultiDrawElements call.
+		/// </summary>
+		/// <param name="meshletIndices">Indices into getMeshlets()</param>
+		void drawMeshlets(const unsigned int* meshletIndices, size_t count)const;
+		//Streams attributes from buffer into instanced shaders (see instanceBuffer.h). Call after load.
+		void setInstanceBuffer(const InstanceBuffer& buffer);
 		inline int getNumVertices()const { return m_numVertices; }
 		inline int getNumIndices()const { return m_numIndices; }
+		inline IndexType getIndexType()const { return m_indexType; }
+		inline int getLODCount()const { return m_lods.empty() ? 1 : (int)m_lods.size(); }
+		//Empty if the mesh was loaded without an LOD chain
+		inline const std::vector<MeshLOD>& getLODs()const { return m_lods; }
+		//Empty if the mesh was loaded without meshlets
+		inline const std::vector<Meshlet>& getMeshlets()const { return m_meshlets; }
+		//Sub ranges drawn separately when a large mesh uses 16 bit indices. Empty otherwise.
+		inline const std::vector<IndexRange>& getIndexRanges()const { return m_indexRanges; }
+		//Local space bounds of the loaded vertices
+		inline const Bounds& getBounds()const { return m_bounds; }
+		inline const AABB& getAABB()const { return m_bounds.box; }
+		inline const BoundingSphere& getBoundingSphere()const { return m_bounds.sphere; }
+		//Bounds after applying a model matrix
+		inline Bounds getWorldBounds(const ew::Mat4& model)const { return transformBounds(m_bounds, model); }
+		inline const VertexLayout& getVertexLayout()const { return m_layout; }
+		//Multiply into the model matrix (model * dequantize) when drawing quantized positions. Identity otherwise.
+		inline ew::Mat4 getDequantizeMatrix()const { return m_layout.isQuantized() ? DequantizeMatrix(m_bounds.box) : ew::IdentityMatrix(); }
 	private:
+		//instanceCount is only used when instanced
+		void drawElements(int lod, bool instanced, int instanceCount)const;
+
 		bool m_initialized = false;
 		unsigned int m_vao = 0;
 		unsigned int m_vbo = 0;
 		unsigned int m_ebo = 0;
 		int m_numVertices = 0;
 		int m_numIndices = 0;
+		IndexType m_indexType = IndexType::UINT32;
+		std::vector<IndexRange> m_indexRanges;
+		std::vector<MeshLOD> m_lods;
+		std::vector<Meshlet> m_meshlets;
+		//Per draw arguments reused by drawMeshlets
+		mutable std::vector<int> m_drawCounts;
+		mutable std::vector<const void*> m_drawOffsets;
+		Bounds m_bounds;
+		VertexLayout m_layout;
 	};
 }
\ No newline at end of file
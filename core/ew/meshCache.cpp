@@ -0,0 +1,101 @@
+#include "meshCache.h"
+#include <stdio.h>
+
+namespace ew {
+	namespace {
+		//Deletes the GL objects along with the last handle
+		void deleteMesh(Mesh* mesh) {
+			mesh->unload();
+			delete mesh;
+		}
+	}
+
+	ProceduralMeshCache::ProceduralMeshCache(const std::string& directory)
+	{
+		if (!directory.empty())
+			m_disk.reset(new MeshFileCache(directory));
+	}
+
+	SharedMesh ProceduralMeshCache::get(const CubeParams& params, const VertexLayout& layout)
+	{
+		return get(MeshFileCache::makeKey("cube", CubeParams::VERSION, { params.size }), [&]() { return createMesh(params); }, layout);
+	}
+
+	SharedMesh ProceduralMeshCache::get(const PlaneParams& params, const VertexLayout& layout)
+	{
+		return get(MeshFileCache::makeKey("plane", PlaneParams::VERSION, { params.width, params.height, (float)params.subdivisions }),
+			[&]() { return createMesh(params, 0u); }, layout);
+	}
+
+	SharedMesh ProceduralMeshCache::get(const SphereParams& params, const VertexLayout& layout)
+	{
+		return get(MeshFileCache::makeKey("sphere", SphereParams::VERSION, { params.radius, (float)params.subdivisions }),
+			[&]() { return createMesh(params, 0u); }, layout);
+	}
+
+	SharedMesh ProceduralMeshCache::get(const CylinderParams& params, const VertexLayout& layout)
+	{
+		return get(MeshFileCache::makeKey("cylinder", CylinderParams::VERSION, { params.radius, params.height, (float)params.subdivisions }),
+			[&]() { return createMesh(params, 0u); }, layout);
+	}
+
+	SharedMesh ProceduralMeshCache::get(const IcosphereParams& params, const VertexLayout& layout)
+	{
+		return get(MeshFileCache::makeKey("icosphere", IcosphereParams::VERSION, { params.radius, (float)params.subdivisions, (float)params.targetTriangles }),
+			[&]() { return createMesh(params, 0u); }, layout);
+	}
+
+	SharedMesh ProceduralMeshCache::get(const CubeSphereParams& params, const VertexLayout& layout)
+	{
+		return get(MeshFileCache::makeKey("cubeSphere", CubeSphereParams::VERSION, { params.radius, (float)params.subdivisions, (float)params.targetTriangles }),
+			[&]() { return createMesh(params, 0u); }, layout);
+	}
+
+	SharedMesh ProceduralMeshCache::get(const std::string& key, const std::function<MeshData()>& generate, const VertexLayout& layout)
+	{
+		//The same shape packed into another layout is a different mesh
+		char layoutSuffix[32];
+		snprintf(layoutSuffix, sizeof(layoutSuffix), "_p%d_n%d_u%d", (int)layout.position, (int)layout.normal, (int)layout.uv);
+		const std::string fullKey = key + layoutSuffix;
+		auto it = m_meshes.find(fullKey);
+		if (it != m_meshes.end()) {
+			m_stats.memoryHits++;
+			return it->second;
+		}
+
+		Mesh* mesh = new Mesh();
+		if (m_disk) {
+			if (m_disk->loadOrGenerate(fullKey, *mesh, generate, layout))
+				m_stats.diskHits++;
+			else
+				m_stats.generated++;
+		}
+		else {
+			mesh->load(generate(), layout);
+			m_stats.generated++;
+		}
+		SharedMesh shared(mesh, deleteMesh);
+		m_meshes.emplace(fullKey, shared);
+		return shared;
+	}
+
+	size_t ProceduralMeshCache::trim()
+	{
+		size_t freed = 0;
+		for (auto it = m_meshes.begin(); it != m_meshes.end();) {
+			if (it->second.use_count() == 1) {
+				it = m_meshes.erase(it);
+				freed++;
+			}
+			else {
+				++it;
+			}
+		}
+		return freed;
+	}
+
+	void ProceduralMeshCache::clear()
+	{
+		m_meshes.clear();
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "mesh.h"
+#include "meshFile.h"
+#include "procGen.h"
+
+namespace ew {
+	//Mesh shared by everyone who asked for the same generator and parameters. The GL objects are deleted when
+	//the last handle is released, so release handles while the context is current. Don't set an instance buffer
+	//on a shared mesh; load a separate Mesh for that.
+	using SharedMesh = std::shared_ptr<const Mesh>;
+
+	struct ProceduralMeshCacheStats {
+		//Returned an already loaded mesh
+		size_t memoryHits = 0;
+		//Mapped from the disk tier without generating
+		size_t diskHits = 0;
+		size_t generated = 0;
+	};
+
+	/// <summary>
+	/// Memoizes procedural meshes by generator, parameters and vertex layout, so identical calls share one
+	/// GPU mesh instead of each generating and uploading their own.
+	/// With a directory, generated meshes are also written as .ewmesh files (see MeshFileCache),
+	/// and later runs map them instead of generating.
+	/// </summary>
+	class ProceduralMeshCache {
+	public:
+		//Empty directory = memory only
+		explicit ProceduralMeshCache(const std::string& directory = "");
+		ProceduralMeshCache(const ProceduralMeshCache&) = delete;
+		ProceduralMeshCache& operator=(const ProceduralMeshCache&) = delete;
+
+		SharedMesh get(const CubeParams& params, const VertexLayout& layout = VertexLayout());
+		SharedMesh get(const PlaneParams& params, const VertexLayout& layout = VertexLayout());
+		SharedMesh get(const SphereParams& params, const VertexLayout& layout = VertexLayout());
+		SharedMesh get(const CylinderParams& params, const VertexLayout& layout = VertexLayout());
+		SharedMesh get(const IcosphereParams& params, const VertexLayout& layout = VertexLayout());
+		SharedMesh get(const CubeSphereParams& params, const VertexLayout& layout = VertexLayout());
+		/// <summary>
+		/// Entry point for any other generator.
+		/// </summary>
+		/// <param name="key">Generator name and parameters, e.g. MeshFileCache::makeKey("terrain", 1, {...}).
+		/// Must change whenever the output would.</param>
+		/// <param name="generate">Only called on a miss in both tiers</param>
+		SharedMesh get(const std::string& key, const std::function<MeshData()>& generate, const VertexLayout& layout = VertexLayout());
+
+		//Drops the cache's reference to meshes no one else holds, freeing them. Returns how many were freed.
+		size_t trim();
+		//Drops every reference the cache holds. Handles given out stay valid.
+		void clear();
+		inline size_t size()const { return m_meshes.size(); }
+		inline const ProceduralMeshCacheStats& getStats()const { return m_stats; }
+	private:
+		std::unique_ptr<MeshFileCache> m_disk;
+		std::unordered_map<std::string, SharedMesh> m_meshes;
+		ProceduralMeshCacheStats m_stats;
+	};
+}
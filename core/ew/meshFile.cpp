@@ -0,0 +1,356 @@
+#include "meshFile.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ew {
+	static_assert(sizeof(MeshFileHeader) == 120, "MeshFileHeader must not have padding");
+	static_assert(sizeof(MeshLOD) == 12 && sizeof(IndexRange) == 12 && sizeof(Meshlet) == 40, "LOD, index range and meshlet records are stored as is");
+	static_assert(alignof(MeshLOD) <= MESH_FILE_ALIGNMENT && alignof(IndexRange) <= MESH_FILE_ALIGNMENT && alignof(Meshlet) <= MESH_FILE_ALIGNMENT,
+		"Mapped records are used in place");
+
+	namespace {
+		uint64_t alignUp(uint64_t offset) {
+			return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+		}
+
+		void writePadded(std::ofstream& file, const void* data, size_t size, uint64_t* offset) {
+			static const char zeros[MESH_FILE_ALIGNMENT] = {};
+			const uint64_t aligned = alignUp(*offset);
+			file.write(zeros, (std::streamsize)(aligned - *offset));
+			file.write((const char*)data, (std::streamsize)size);
+			*offset = aligned + size;
+		}
+
+		//Next to the target, so the rename stays on one file system. Unique per process and call, so concurrent writers
+		//of the same target don't share a temp file.
+		std::string tempPathFor(const std::string& filePath) {
+			static std::atomic<unsigned int> s_counter(0);
+#ifdef _WIN32
+			const unsigned long pid = (unsigned long)GetCurrentProcessId();
+#else
+			const unsigned long pid = (unsigned long)getpid();
+#endif
+			char suffix[48];
+			snprintf(suffix, sizeof(suffix), ".%lu_%u.tmp", pid, s_counter++);
+			return filePath + suffix;
+		}
+
+		//Replaces target with source in one step, so readers see either the old file or the new one
+		bool replaceFile(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+			return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			return rename(source.c_str(), target.c_str()) == 0;
+#endif
+		}
+
+		//Also requires the offset to be aligned. Mappings start on a page, so aligned offsets make aligned pointers.
+		bool inFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+			return offset % MESH_FILE_ALIGNMENT == 0 && offset <= fileSize && size <= fileSize - offset;
+		}
+
+		//True if [first, first + count) lies within indexCount indices
+		bool inIndices(uint64_t first, uint64_t count, uint64_t indexCount) {
+			return first <= indexCount && count <= indexCount - first;
+		}
+
+		//True if every index in [first, first + count) plus baseVertex addresses one of vertexCount vertices
+		template<typename T>
+		bool indicesAddressVertices(const T* indices, uint64_t first, uint64_t count, int64_t baseVertex, uint64_t vertexCount) {
+			if (count == 0)
+				return true;
+			//Min and max in one branch free pass, which vectorizes
+			T minIndex = indices[first];
+			T maxIndex = indices[first];
+			for (uint64_t i = first; i < first + count; i++)
+			{
+				minIndex = indices[i] < minIndex ? indices[i] : minIndex;
+				maxIndex = indices[i] > maxIndex ? indices[i] : maxIndex;
+			}
+			return (int64_t)minIndex + baseVertex >= 0 && (int64_t)maxIndex + baseVertex < (int64_t)vertexCount;
+		}
+		bool indicesAddressVertices(const void* indices, IndexType type, uint64_t first, uint64_t count, int64_t baseVertex, uint64_t vertexCount) {
+			switch (type) {
+			case IndexType::UINT8: return indicesAddressVertices((const uint8_t*)indices, first, count, baseVertex, vertexCount);
+			case IndexType::UINT16: return indicesAddressVertices((const uint16_t*)indices, first, count, baseVertex, vertexCount);
+			default: return indicesAddressVertices((const uint32_t*)indices, first, count, baseVertex, vertexCount);
+			}
+		}
+	}
+
+	bool writeMeshFile(const std::string& filePath, const MeshData& meshData, const VertexLayout& layout)
+	{
+		const Bounds bounds = meshData.hasBounds ? meshData.bounds : computeBounds(meshData.vertices.data(), meshData.vertices.size());
+		std::vector<unsigned char> vertices(meshData.vertices.size() * layout.stride());
+		packVertices(meshData.vertices.data(), meshData.vertices.size(), layout, bounds.box, vertices.data());
+		const PackedIndices indices = packIndices(meshData.indices.data(), meshData.indices.size(), meshData.vertices.size(), meshData.lods.empty() && meshData.meshlets.empty());
+
+		MeshFileHeader header = {};
+		header.magic = MESH_FILE_MAGIC;
+		header.version = MESH_FILE_VERSION;
+		header.positionFormat = (uint8_t)layout.position;
+		header.normalFormat = (uint8_t)layout.normal;
+		header.uvFormat = (uint8_t)layout.uv;
+		header.indexType = (uint8_t)indices.type;
+		header.vertexCount = (uint32_t)meshData.vertices.size();
+		header.indexCount = (uint32_t)meshData.indices.size();
+		header.lodCount = (uint32_t)meshData.lods.size();
+		header.indexRangeCount = (uint32_t)indices.ranges.size();
+		header.meshletCount = (uint32_t)meshData.meshlets.size();
+		memcpy(header.boundsMin, &bounds.box.min, sizeof(header.boundsMin));
+		memcpy(header.boundsMax, &bounds.box.max, sizeof(header.boundsMax));
+		memcpy(header.sphereCenter, &bounds.sphere.center, sizeof(header.sphereCenter));
+		header.sphereRadius = bounds.sphere.radius;
+
+		//Offsets follow the same order as the writes below
+		uint64_t offset = sizeof(MeshFileHeader);
+		header.lodOffset = alignUp(offset);
+		offset = header.lodOffset + sizeof(MeshLOD) * meshData.lods.size();
+		header.indexRangeOffset = alignUp(offset);
+		offset = header.indexRangeOffset + sizeof(IndexRange) * indices.ranges.size();
+		header.meshletOffset = alignUp(offset);
+		offset = header.meshletOffset + sizeof(Meshlet) * meshData.meshlets.size();
+		header.vertexOffset = alignUp(offset);
+		offset = header.vertexOffset + vertices.size();
+		header.indexOffset = alignUp(offset);
+		header.fileSize = header.indexOffset + indices.data.size();
+
+		//Written to a temp file and renamed over the target, so a crash or a concurrent open never sees a partial file
+		const std::string tempPath = tempPathFor(filePath);
+		bool written;
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				printf("Failed to write mesh file %s\n", filePath.c_str());
+				return false;
+			}
+			offset = 0;
+			writePadded(file, &header, sizeof(header), &offset);
+			writePadded(file, meshData.lods.data(), sizeof(MeshLOD) * meshData.lods.size(), &offset);
+			writePadded(file, indices.ranges.data(), sizeof(IndexRange) * indices.ranges.size(), &offset);
+			writePadded(file, meshData.meshlets.data(), sizeof(Meshlet) * meshData.meshlets.size(), &offset);
+			writePadded(file, vertices.data(), vertices.size(), &offset);
+			writePadded(file, indices.data.data(), indices.data.size(), &offset);
+			file.close();
+			written = !file.fail();
+		}
+		if (!written || !replaceFile(tempPath, filePath)) {
+			printf("Failed to write mesh file %s\n", filePath.c_str());
+			remove(tempPath.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	MappedMeshFile::~MappedMeshFile()
+	{
+		close();
+	}
+
+	bool MappedMeshFile::open(const std::string& filePath)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size;
+		HANDLE mapping = NULL;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			CloseHandle(file);
+			return false;
+		}
+		m_file = file;
+		m_mapping = mapping;
+		m_data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		m_size = (size_t)size.QuadPart;
+#else
+		const int fd = ::open(filePath.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+			::close(fd);
+			return false;
+		}
+		void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		//The mapping stays valid after the descriptor is closed
+		::close(fd);
+		if (data == MAP_FAILED)
+			return false;
+		m_data = (const unsigned char*)data;
+		m_size = (size_t)info.st_size;
+#endif
+		if (!m_data || !validate()) {
+			printf("Invalid mesh file %s\n", filePath.c_str());
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	bool MappedMeshFile::validate()
+	{
+		if (m_size < sizeof(MeshFileHeader))
+			return false;
+		MeshFileHeader header;
+		memcpy(&header, m_data, sizeof(header));
+		if (header.magic != MESH_FILE_MAGIC || header.version != MESH_FILE_VERSION || header.fileSize != m_size)
+			return false;
+		if (header.positionFormat > (uint8_t)PositionFormat::UNORM16 || header.normalFormat > (uint8_t)NormalFormat::OCT_SNORM16
+			|| header.uvFormat > (uint8_t)UVFormat::UNORM16 || header.indexType > (uint8_t)IndexType::UINT32)
+			return false;
+
+		MeshView& view = m_view;
+		view.layout = VertexLayout((PositionFormat)header.positionFormat, (NormalFormat)header.normalFormat, (UVFormat)header.uvFormat);
+		view.indexType = (IndexType)header.indexType;
+		memcpy(&view.bounds.box.min, header.boundsMin, sizeof(header.boundsMin));
+		memcpy(&view.bounds.box.max, header.boundsMax, sizeof(header.boundsMax));
+		memcpy(&view.bounds.sphere.center, header.sphereCenter, sizeof(header.sphereCenter));
+		view.bounds.sphere.radius = header.sphereRadius;
+		view.vertexCount = header.vertexCount;
+		view.indexCount = header.indexCount;
+		view.lodCount = header.lodCount;
+		view.indexRangeCount = header.indexRangeCount;
+		view.meshletCount = header.meshletCount;
+
+		const uint64_t vertexBytes = (uint64_t)header.vertexCount * view.layout.stride();
+		const uint64_t indexBytes = (uint64_t)header.indexCount * IndexSize(view.indexType);
+		if (!inFile(header.lodOffset, sizeof(MeshLOD) * (uint64_t)header.lodCount, m_size)
+			|| !inFile(header.indexRangeOffset, sizeof(IndexRange) * (uint64_t)header.indexRangeCount, m_size)
+			|| !inFile(header.meshletOffset, sizeof(Meshlet) * (uint64_t)header.meshletCount, m_size)
+			|| !inFile(header.vertexOffset, vertexBytes, m_size)
+			|| !inFile(header.indexOffset, indexBytes, m_size))
+			return false;
+		view.lods = (const MeshLOD*)(m_data + header.lodOffset);
+		view.indexRanges = (const IndexRange*)(m_data + header.indexRangeOffset);
+		view.meshlets = (const Meshlet*)(m_data + header.meshletOffset);
+		view.vertexData = m_data + header.vertexOffset;
+		view.indexData = m_data + header.indexOffset;
+
+		//Every draw must stay inside the index buffer and every index it reads must address a vertex,
+		//or a stale or corrupt file would make the GPU read past the buffers
+		for (size_t i = 0; i < view.lodCount; i++)
+		{
+			if (!inIndices(view.lods[i].firstIndex, view.lods[i].indexCount, view.indexCount))
+				return false;
+		}
+		for (size_t i = 0; i < view.meshletCount; i++)
+		{
+			if (!inIndices(view.meshlets[i].firstIndex, view.meshlets[i].indexCount, view.indexCount))
+				return false;
+		}
+		if (view.indexRangeCount == 0)
+			return indicesAddressVertices(view.indexData, view.indexType, 0, view.indexCount, 0, view.vertexCount);
+		//Ranges replace the LOD and meshlet draws, which don't apply a base vertex. writeMeshFile never stores both.
+		if (view.lodCount > 0 || view.meshletCount > 0)
+			return false;
+		for (size_t i = 0; i < view.indexRangeCount; i++)
+		{
+			const IndexRange& r = view.indexRanges[i];
+			if (!inIndices(r.firstIndex, r.count, view.indexCount)
+				|| !indicesAddressVertices(view.indexData, view.indexType, r.firstIndex, r.count, r.baseVertex, view.vertexCount))
+				return false;
+		}
+		return true;
+	}
+
+	void MappedMeshFile::close()
+	{
+#ifdef _WIN32
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping)
+			CloseHandle((HANDLE)m_mapping);
+		if (m_file)
+			CloseHandle((HANDLE)m_file);
+		m_mapping = nullptr;
+		m_file = nullptr;
+#else
+		if (m_data)
+			munmap((void*)m_data, m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+		m_view = MeshView();
+	}
+
+	bool loadMeshFile(const std::string& filePath, Mesh& mesh)
+	{
+		MappedMeshFile file;
+		if (!file.open(filePath))
+			return false;
+		mesh.load(file.getView());
+		return true;
+	}
+
+	MeshFileCache::MeshFileCache(const std::string& directory)
+		:m_directory(directory)
+	{
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+	}
+
+	std::string MeshFileCache::makeKey(const char* generator, unsigned int version, std::initializer_list<float> params)
+	{
+		std::string key = generator;
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "_v%u", version);
+		key += buffer;
+		for (float p : params)
+		{
+			//Enough digits to round trip any float
+			snprintf(buffer, sizeof(buffer), "_%.9g", p);
+			key += buffer;
+		}
+		return key;
+	}
+
+	std::string MeshFileCache::getFilePath(const std::string& key) const
+	{
+		std::string name = key;
+		for (char& c : name)
+		{
+			const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+			if (!safe)
+				c = '_';
+		}
+		return m_directory + "/" + name + ".ewmesh";
+	}
+
+	bool MeshFileCache::loadOrGenerate(const std::string& key, Mesh& mesh, const std::function<MeshData()>& generate, const VertexLayout& layout)
+	{
+		const std::string filePath = getFilePath(key);
+		MappedMeshFile file;
+		//Entries written with another layout are rebuilt
+		if (file.open(filePath) && file.getView().layout.position == layout.position
+			&& file.getView().layout.normal == layout.normal && file.getView().layout.uv == layout.uv) {
+			mesh.load(file.getView());
+			return true;
+		}
+		file.close();
+		const MeshData meshData = generate();
+		writeMeshFile(filePath, meshData, layout);
+		mesh.load(meshData, layout);
+		return false;
+	}
+}
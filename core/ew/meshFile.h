@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include "mesh.h"
+
+namespace ew {
+	constexpr uint32_t MESH_FILE_MAGIC = 0x48534d45; //"EMSH" read as little endian bytes
+	constexpr uint32_t MESH_FILE_VERSION = 2;
+	//Every blob starts on a multiple of this, so mapped pointers can be used directly
+	constexpr uint64_t MESH_FILE_ALIGNMENT = 64;
+
+	/// <summary>
+	/// Start of a .ewmesh file. Offsets are in bytes from the start of the file. Little endian.
+	/// Layout: header, LODs (MeshLOD[lodCount]), index ranges (IndexRange[indexRangeCount]),
+	/// meshlets (Meshlet[meshletCount]), vertices (packed in the stored VertexLayout), indices (stored IndexType).
+	/// </summary>
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint8_t positionFormat;
+		uint8_t normalFormat;
+		uint8_t uvFormat;
+		uint8_t indexType;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t lodCount;
+		uint32_t indexRangeCount;
+		float boundsMin[3];
+		float boundsMax[3];
+		float sphereCenter[3];
+		float sphereRadius;
+		uint32_t meshletCount;
+		uint64_t lodOffset;
+		uint64_t indexRangeOffset;
+		uint64_t meshletOffset;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t fileSize;
+	};
+
+	/// <summary>
+	/// Packs the mesh into layout and writes it as a .ewmesh file. The file is written next to filePath and renamed over it,
+	/// so other processes never open a partly written file, and existing mappings of the old file stay valid (except on Windows,
+	/// where replacing a mapped file fails).
+	/// </summary>
+	/// <returns>False if the file could not be written</returns>
+	bool writeMeshFile(const std::string& filePath, const MeshData& meshData, const VertexLayout& layout = VertexLayout());
+
+	/// <summary>
+	/// Read only memory mapping of a .ewmesh file. The view points straight into the mapped pages,
+	/// so nothing is parsed or copied until Mesh::load uploads it.
+	/// </summary>
+	class MappedMeshFile {
+	public:
+		MappedMeshFile() {};
+		~MappedMeshFile();
+		MappedMeshFile(const MappedMeshFile&) = delete;
+		MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+
+		//Returns false if the file is missing, truncated, from another version, or has draws reaching outside its buffers
+		bool open(const std::string& filePath);
+		void close();
+		inline bool isOpen()const { return m_data != nullptr; }
+		//Valid until close
+		inline const MeshView& getView()const { return m_view; }
+	private:
+		bool validate();
+
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		MeshView m_view;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+
+	//Maps the file, uploads it to mesh and unmaps it. Returns false if the file could not be opened.
+	bool loadMeshFile(const std::string& filePath, Mesh& mesh);
+
+	/// <summary>
+	/// Directory of .ewmesh files keyed by generator name and parameters, so procedural meshes
+	/// are built once and mapped on later runs.
+	/// </summary>
+	class MeshFileCache {
+	public:
+		//The directory is created if it doesn't exist
+		MeshFileCache(const std::string& directory);
+		/// <summary>
+		/// e.g. makeKey("sphere", 1, { 0.5f, 64 }). Changing any parameter changes the file.
+		/// </summary>
+		/// <param name="version">Bump whenever the generator's output changes, so files it wrote before are no longer used</param>
+		static std::string makeKey(const char* generator, unsigned int version, std::initializer_list<float> params);
+		std::string getFilePath(const std::string& key)const;
+		//Loads the cached mesh, or generates, stores and loads it. Returns true if the cache was hit.
+		bool loadOrGenerate(const std::string& key, Mesh& mesh, const std::function<MeshData()>& generate, const VertexLayout& layout = VertexLayout());
+	private:
+		std::string m_directory;
+	};
+}
@@ -0,0 +1,319 @@
+#include "meshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+
+namespace ew {
+	namespace {
+		//Triangles using each vertex, stored as one array with per vertex offsets
+		struct Adjacency {
+			std::vector<unsigned int> offsets; //vertexCount + 1
+			std::vector<unsigned int> triangles;
+		};
+
+		void buildAdjacency(const unsigned int* indices, size_t indexCount, size_t vertexCount, Adjacency* adj) {
+			adj->offsets.assign(vertexCount + 1, 0);
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				adj->offsets[indices[i] + 1]++;
+			}
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				adj->offsets[v + 1] += adj->offsets[v];
+			}
+			adj->triangles.resize(indexCount);
+			std::vector<unsigned int> fill(adj->offsets.begin(), adj->offsets.end() - 1);
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				adj->triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+			}
+		}
+
+		//Counts FIFO cache misses. A vertex is cached if it was one of the last cacheSize misses.
+		struct FifoCache {
+			std::vector<unsigned int> timestamps;
+			unsigned int time;
+			unsigned int size;
+
+			FifoCache(size_t vertexCount, unsigned int cacheSize)
+				:timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+			void clear() {
+				//Everything inserted before now is evicted
+				time += size + 1;
+			}
+			//Returns true on a miss
+			bool access(unsigned int v) {
+				if (time - timestamps[v] <= size)
+					return false;
+				timestamps[v] = time++;
+				return true;
+			}
+		};
+
+		//Sum of unnormalized triangle normals (area weighted) and area weighted centroid of a run of triangles
+		void clusterSurface(const unsigned int* indices, size_t begin, size_t end, const Vertex* vertices, ew::Vec3* centroid, ew::Vec3* normal, float* area) {
+			ew::Vec3 c = ew::Vec3(0.0f), n = ew::Vec3(0.0f);
+			float a = 0.0f;
+			for (size_t i = begin; i < end; i += 3)
+			{
+				const ew::Vec3& p0 = vertices[indices[i]].pos;
+				const ew::Vec3& p1 = vertices[indices[i + 1]].pos;
+				const ew::Vec3& p2 = vertices[indices[i + 2]].pos;
+				const ew::Vec3 cross = ew::Cross(p1 - p0, p2 - p0);
+				const float triArea = ew::Magnitude(cross);
+				c += (p0 + p1 + p2) * (triArea / 3.0f);
+				n += cross;
+				a += triArea;
+			}
+			*centroid = a > 0.0f ? c / a : ew::Vec3(0.0f);
+			*normal = n;
+			*area = a;
+		}
+	}
+
+	VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize)
+	{
+		VertexCacheStats stats;
+		if (indexCount < 3)
+			return stats;
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> referenced(vertexCount, false);
+		size_t misses = 0, unique = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			misses += cache.access(indices[i]);
+			if (!referenced[indices[i]]) {
+				referenced[indices[i]] = true;
+				unique++;
+			}
+		}
+		stats.acmr = (float)misses / (float)(indexCount / 3);
+		stats.atvr = (float)misses / (float)unique;
+		return stats;
+	}
+
+	void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize, std::vector<unsigned int>* clusters)
+	{
+		if (clusters)
+			clusters->clear();
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || vertexCount == 0)
+			return;
+		Adjacency adj;
+		buildAdjacency(indices, triangleCount * 3, vertexCount, &adj);
+
+		//Triangles still to be emitted per vertex
+		std::vector<unsigned int> live(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			live[v] = adj.offsets[v + 1] - adj.offsets[v];
+		}
+		std::vector<unsigned int> cacheTime(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<unsigned int> deadEnd;
+		std::vector<unsigned int> candidates;
+		std::vector<unsigned int> out;
+		out.reserve(triangleCount * 3);
+		unsigned int time = cacheSize + 1;
+		size_t cursor = 0;
+		const unsigned int k = cacheSize;
+
+		//Fanning vertex, -1 when every triangle is emitted
+		long long fan = 0;
+		if (clusters)
+			clusters->push_back(0);
+		while (fan >= 0)
+		{
+			candidates.clear();
+			//Emit every remaining triangle around the fanning vertex
+			for (unsigned int a = adj.offsets[fan]; a < adj.offsets[fan + 1]; a++)
+			{
+				const unsigned int t = adj.triangles[a];
+				if (emitted[t])
+					continue;
+				for (int j = 0; j < 3; j++)
+				{
+					const unsigned int v = indices[t * 3 + j];
+					out.push_back(v);
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					live[v]--;
+					if (time - cacheTime[v] > k) {
+						cacheTime[v] = time++;
+					}
+				}
+				emitted[t] = true;
+			}
+
+			//Next fan: the candidate that stays in cache longest after emitting its triangles
+			long long next = -1;
+			int bestPriority = -1;
+			for (unsigned int v : candidates)
+			{
+				if (live[v] == 0)
+					continue;
+				int priority = 0;
+				if (time - cacheTime[v] + 2 * live[v] <= k)
+					priority = (int)(time - cacheTime[v]);
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					next = v;
+				}
+			}
+			if (next < 0) {
+				//Dead end. Back up through recently used vertices, then scan for any vertex with triangles left.
+				while (!deadEnd.empty() && next < 0)
+				{
+					const unsigned int v = deadEnd.back();
+					deadEnd.pop_back();
+					if (live[v] > 0)
+						next = v;
+				}
+				if (next < 0) {
+					while (cursor < vertexCount && live[cursor] == 0)
+						cursor++;
+					if (cursor < vertexCount) {
+						next = (long long)cursor;
+						//Starting over from an unrelated vertex, so nothing useful is cached
+						if (clusters && clusters->back() != out.size())
+							clusters->push_back((unsigned int)out.size());
+					}
+				}
+			}
+			fan = next;
+		}
+		std::copy(out.begin(), out.end(), indices);
+	}
+
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, const std::vector<unsigned int>& clusters, unsigned int cacheSize, float threshold)
+	{
+		indexCount -= indexCount % 3;
+		if (indexCount == 0 || clusters.empty())
+			return;
+
+		//Soft boundaries: split each cluster where the ACMR so far is already as good as the whole cluster's
+		std::vector<unsigned int> bounds;
+		FifoCache cache(vertexCount, cacheSize);
+		for (size_t c = 0; c < clusters.size(); c++)
+		{
+			const size_t begin = clusters[c];
+			const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : indexCount;
+			cache.clear();
+			size_t misses = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				misses += cache.access(indices[i]);
+			}
+			const float clusterAcmr = (float)misses / (float)((end - begin) / 3);
+
+			cache.clear();
+			bounds.push_back((unsigned int)begin);
+			size_t runStart = begin, runMisses = 0;
+			for (size_t i = begin; i < end; i += 3)
+			{
+				runMisses += cache.access(indices[i]) + cache.access(indices[i + 1]) + cache.access(indices[i + 2]);
+				const size_t runTriangles = (i + 3 - runStart) / 3;
+				if (i + 3 < end && (float)runMisses <= clusterAcmr * threshold * (float)runTriangles) {
+					bounds.push_back((unsigned int)(i + 3));
+					runStart = i + 3;
+					runMisses = 0;
+					cache.clear();
+				}
+			}
+		}
+		bounds.push_back((unsigned int)indexCount);
+
+		//Sort by how far each cluster faces away from the mesh center. Outer surfaces draw first.
+		const size_t count = bounds.size() - 1;
+		std::vector<ew::Vec3> centroids(count), normals(count);
+		ew::Vec3 meshCentroid = ew::Vec3(0.0f);
+		float meshArea = 0.0f;
+		for (size_t c = 0; c < count; c++)
+		{
+			float area;
+			clusterSurface(indices, bounds[c], bounds[c + 1], vertices, &centroids[c], &normals[c], &area);
+			meshCentroid += centroids[c] * area;
+			meshArea += area;
+		}
+		if (meshArea > 0.0f)
+			meshCentroid = meshCentroid / meshArea;
+		std::vector<float> sortKey(count);
+		std::vector<unsigned int> order(count);
+		for (size_t c = 0; c < count; c++)
+		{
+			const float length = ew::Magnitude(normals[c]);
+			sortKey[c] = length > 0.0f ? ew::Dot(centroids[c] - meshCentroid, normals[c]) / length : 0.0f;
+			order[c] = (unsigned int)c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+			return sortKey[a] > sortKey[b];
+		});
+
+		std::vector<unsigned int> out;
+		out.reserve(indexCount);
+		for (unsigned int c : order)
+		{
+			out.insert(out.end(), indices + bounds[c], indices + bounds[c + 1]);
+		}
+		std::copy(out.begin(), out.end(), indices);
+	}
+
+	void optimizeVertexFetch(MeshData& mesh)
+	{
+		const size_t vertexCount = mesh.vertices.size();
+		const unsigned int unassigned = ~0u;
+		std::vector<unsigned int> remap(vertexCount, unassigned);
+		std::vector<Vertex> vertices;
+		vertices.reserve(vertexCount);
+		for (unsigned int& index : mesh.indices)
+		{
+			if (remap[index] == unassigned) {
+				remap[index] = (unsigned int)vertices.size();
+				vertices.push_back(mesh.vertices[index]);
+			}
+			index = remap[index];
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			if (remap[v] == unassigned)
+				vertices.push_back(mesh.vertices[v]);
+		}
+		mesh.vertices.swap(vertices);
+	}
+
+	MeshOptimizeStats optimizeMesh(MeshData& mesh, const MeshOptimizeOptions& options)
+	{
+		MeshOptimizeStats stats;
+		const auto start = std::chrono::high_resolution_clock::now();
+		unsigned int* indices = mesh.indices.data();
+		const size_t indexCount = mesh.indices.size() - mesh.indices.size() % 3;
+		const size_t vertexCount = mesh.vertices.size();
+		stats.before = analyzeVertexCache(indices, indexCount, vertexCount, options.cacheSize);
+
+		//Reordering breaks meshlet ranges, rebuild them afterwards
+		mesh.meshlets.clear();
+		//Each LOD is its own triangle list
+		std::vector<MeshLOD> lists = mesh.lods;
+		if (lists.empty()) {
+			lists.push_back(MeshLOD());
+			lists[0].indexCount = (unsigned int)indexCount;
+		}
+		std::vector<unsigned int> clusters;
+		for (const MeshLOD& lod : lists)
+		{
+			unsigned int* lodIndices = indices + lod.firstIndex;
+			optimizeVertexCache(lodIndices, lod.indexCount, vertexCount, options.cacheSize, &clusters);
+			if (options.optimizeOverdraw) {
+				optimizeOverdraw(lodIndices, lod.indexCount, mesh.vertices.data(), vertexCount, clusters, options.cacheSize, options.overdrawThreshold);
+			}
+		}
+		if (options.optimizeVertexFetch) {
+			optimizeVertexFetch(mesh);
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		stats.after = analyzeVertexCache(mesh.indices.data(), indexCount, vertexCount, options.cacheSize);
+		stats.seconds = elapsed.count();
+		stats.trianglesPerSecond = stats.seconds > 0.0 ? (double)(indexCount / 3) / stats.seconds : 0.0;
+		return stats;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	//Post-transform vertex cache efficiency of a triangle list under a FIFO cache
+	struct VertexCacheStats {
+		float acmr = 0.0f; //Average cache miss ratio: transformed vertices per triangle. 0.5 is ideal for large grids, 3 is worst
+		float atvr = 0.0f; //Average transform to vertex ratio: transformed vertices per referenced vertex. 1 is ideal
+	};
+
+	struct MeshOptimizeOptions {
+		//Simulated post-transform cache size. 16 is a safe lower bound for current GPUs.
+		unsigned int cacheSize = 16;
+		//Clusters for overdraw sorting are split wherever their ACMR stays within this factor of the cache optimized order.
+		//1 keeps only the cache flush boundaries, larger values give smaller clusters and better overdraw.
+		float overdrawThreshold = 1.05f;
+		bool optimizeOverdraw = true;
+		bool optimizeVertexFetch = true;
+	};
+
+	struct MeshOptimizeStats {
+		VertexCacheStats before;
+		VertexCacheStats after;
+		double seconds = 0.0; //Time spent in optimizeMesh
+		double trianglesPerSecond = 0.0;
+	};
+
+	/// <summary>
+	/// Simulates a FIFO post-transform cache over a triangle list.
+	/// </summary>
+	VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16);
+
+	/// <summary>
+	/// Reorders triangles for the post-transform cache with Tipsify (Sander, Nehab and Barczak 2007). Linear time.
+	/// </summary>
+	/// <param name="clusters">Optional. Receives the first index of every run that starts with a cold cache</param>
+	void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = 16, std::vector<unsigned int>* clusters = nullptr);
+
+	/// <summary>
+	/// Reorders the clusters of a cache optimized triangle list so outward facing ones draw first and occlude the rest.
+	/// Clusters are split further wherever their ACMR stays within threshold of the cluster's own, then sorted by
+	/// how far their surface faces away from the mesh center. Only whole clusters move, so cache efficiency is kept.
+	/// </summary>
+	/// <param name="clusters">First index of every cluster, as returned by optimizeVertexCache</param>
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, const std::vector<unsigned int>& clusters, unsigned int cacheSize = 16, float threshold = 1.05f);
+
+	/// <summary>
+	/// Reorders vertices in the order triangles first use them and remaps indices, so vertex fetch reads memory linearly.
+	/// Unreferenced vertices are kept at the end.
+	/// </summary>
+	void optimizeVertexFetch(MeshData& mesh);
+
+	/// <summary>
+	/// Runs the vertex cache, overdraw and vertex fetch passes on a triangle list mesh, e.g. from procGen or a file.
+	/// Call once at load time or offline. Bounds stay valid since vertices only move. LODs are optimized separately.
+	/// </summary>
+	MeshOptimizeStats optimizeMesh(MeshData& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions());
+}
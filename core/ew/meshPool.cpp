@@ -0,0 +1,217 @@
+#include "meshPool.h"
+#include "external/glad.h"
+
+namespace ew {
+	void MeshPool::RangeAllocator::reset(unsigned int size)
+	{
+		capacity = size;
+		freeRanges.clear();
+		freeRanges.push_back({ 0, size });
+	}
+
+	bool MeshPool::RangeAllocator::allocate(unsigned int size, unsigned int* offset)
+	{
+		for (size_t i = 0; i < freeRanges.size(); i++)
+		{
+			Range& r = freeRanges[i];
+			if (r.size < size)
+				continue;
+			*offset = r.offset;
+			r.offset += size;
+			r.size -= size;
+			if (r.size == 0)
+				freeRanges.erase(freeRanges.begin() + i);
+			return true;
+		}
+		return false;
+	}
+
+	void MeshPool::RangeAllocator::release(unsigned int offset, unsigned int size)
+	{
+		if (size == 0)
+			return;
+		//Insert sorted by offset, then merge with neighbors
+		size_t i = 0;
+		while (i < freeRanges.size() && freeRanges[i].offset < offset)
+			i++;
+		freeRanges.insert(freeRanges.begin() + i, { offset, size });
+		if (i + 1 < freeRanges.size() && freeRanges[i].offset + freeRanges[i].size == freeRanges[i + 1].offset) {
+			freeRanges[i].size += freeRanges[i + 1].size;
+			freeRanges.erase(freeRanges.begin() + i + 1);
+		}
+		if (i > 0 && freeRanges[i - 1].offset + freeRanges[i - 1].size == freeRanges[i].offset) {
+			freeRanges[i - 1].size += freeRanges[i].size;
+			freeRanges.erase(freeRanges.begin() + i);
+		}
+	}
+
+	MeshPool::MeshPool(unsigned int vertexCapacity, unsigned int indexCapacity)
+	{
+		m_vertexAllocator.reset(vertexCapacity);
+		m_indexAllocator.reset(indexCapacity);
+
+		glGenVertexArrays(1, &m_vao);
+		glBindVertexArray(m_vao);
+
+		glGenBuffers(1, &m_vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertexCapacity, NULL, GL_DYNAMIC_DRAW);
+		//Float layout, same as a default Mesh
+		setVertexAttributes(VertexLayout());
+
+		glGenBuffers(1, &m_ebo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indexCapacity, NULL, GL_DYNAMIC_DRAW);
+
+		//0, 1, 2... read once per instance. Each draw's baseInstance selects its own index.
+		glGenBuffers(1, &m_drawIdBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+		glVertexAttribIPointer(POOL_DRAW_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (const void*)0);
+		glEnableVertexAttribArray(POOL_DRAW_ID_LOCATION);
+		glVertexAttribDivisor(POOL_DRAW_ID_LOCATION, 1);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		glGenBuffers(1, &m_indirectBuffer);
+		glGenBuffers(1, &m_drawDataBuffer);
+	}
+
+	MeshPool::~MeshPool()
+	{
+		const unsigned int buffers[] = { m_vbo, m_ebo, m_drawIdBuffer, m_indirectBuffer, m_drawDataBuffer };
+		glDeleteBuffers(5, buffers);
+		glDeleteVertexArrays(1, &m_vao);
+	}
+
+	int MeshPool::add(const MeshData& meshData)
+	{
+		const unsigned int vertexCount = (unsigned int)meshData.vertices.size();
+		const unsigned int indexCount = (unsigned int)meshData.indices.size();
+		const Bounds bounds = meshData.hasBounds ? meshData.bounds : computeBounds(meshData.vertices.data(), vertexCount);
+		const int handle = reserve(vertexCount, indexCount, bounds);
+		if (handle < 0)
+			return -1;
+		uploadVertices(handle, 0, meshData.vertices.data(), vertexCount);
+		uploadIndices(handle, 0, meshData.indices.data(), indexCount);
+		return handle;
+	}
+
+	int MeshPool::reserve(unsigned int vertexCount, unsigned int indexCount, const Bounds& bounds)
+	{
+		PoolMesh mesh;
+		if (!m_vertexAllocator.allocate(vertexCount, &mesh.baseVertex))
+			return -1;
+		if (!m_indexAllocator.allocate(indexCount, &mesh.firstIndex)) {
+			m_vertexAllocator.release(mesh.baseVertex, vertexCount);
+			return -1;
+		}
+		mesh.vertexCount = vertexCount;
+		mesh.indexCount = indexCount;
+		mesh.bounds = bounds;
+
+		int handle;
+		if (!m_freeHandles.empty()) {
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+			m_meshes[handle] = mesh;
+			m_live[handle] = true;
+		}
+		else {
+			handle = (int)m_meshes.size();
+			m_meshes.push_back(mesh);
+			m_live.push_back(true);
+		}
+		return handle;
+	}
+
+	void MeshPool::uploadVertices(int handle, unsigned int first, const Vertex* vertices, unsigned int count)
+	{
+		const PoolMesh& mesh = m_meshes[handle];
+		if (count == 0 || first + count > mesh.vertexCount)
+			return;
+		//Copy target, so uploading doesn't disturb whatever VAO is bound
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * (mesh.baseVertex + first), sizeof(Vertex) * count, vertices);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void MeshPool::uploadIndices(int handle, unsigned int first, const unsigned int* indices, unsigned int count)
+	{
+		const PoolMesh& mesh = m_meshes[handle];
+		if (count == 0 || first + count > mesh.indexCount)
+			return;
+		//Indices stay relative to the mesh. Draws add baseVertex.
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * (mesh.firstIndex + first), sizeof(unsigned int) * count, indices);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void MeshPool::remove(int handle)
+	{
+		if (handle < 0 || handle >= (int)m_meshes.size() || !m_live[handle])
+			return;
+		const PoolMesh& mesh = m_meshes[handle];
+		m_vertexAllocator.release(mesh.baseVertex, mesh.vertexCount);
+		m_indexAllocator.release(mesh.firstIndex, mesh.indexCount);
+		m_live[handle] = false;
+		m_freeHandles.push_back(handle);
+	}
+
+	void MeshPool::beginDraws()
+	{
+		m_commands.clear();
+		m_drawData.clear();
+	}
+
+	void MeshPool::addDraw(int handle, const ew::Mat4& model, const ew::Mat4& normalMatrix)
+	{
+		const PoolMesh& mesh = m_meshes[handle];
+		DrawCommand cmd;
+		cmd.count = mesh.indexCount;
+		cmd.instanceCount = 1;
+		cmd.firstIndex = mesh.firstIndex;
+		cmd.baseVertex = (int)mesh.baseVertex;
+		cmd.baseInstance = (unsigned int)m_commands.size();
+		m_commands.push_back(cmd);
+		PoolDrawData data;
+		data.model = model;
+		data.normalMatrix = normalMatrix;
+		m_drawData.push_back(data);
+	}
+
+	void MeshPool::addDraw(int handle, const ew::Mat4& model)
+	{
+		addDraw(handle, model, ew::NormalMatrix(model));
+	}
+
+	void MeshPool::submit()
+	{
+		if (m_commands.empty())
+			return;
+		const unsigned int drawCount = (unsigned int)m_commands.size();
+		if (drawCount > m_drawIdCapacity) {
+			m_drawIdCapacity = drawCount > m_drawIdCapacity * 2 ? drawCount : m_drawIdCapacity * 2;
+			std::vector<unsigned int> ids(m_drawIdCapacity);
+			for (unsigned int i = 0; i < m_drawIdCapacity; i++)
+				ids[i] = i;
+			glBindBuffer(GL_ARRAY_BUFFER, m_drawIdBuffer);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(unsigned int) * m_drawIdCapacity, ids.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PoolDrawData) * m_drawData.size(), m_drawData.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, POOL_DRAW_DATA_BINDING, m_drawDataBuffer);
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawCommand) * m_commands.size(), m_commands.data(), GL_STREAM_DRAW);
+
+		glBindVertexArray(m_vao);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)0, drawCount, sizeof(DrawCommand));
+		glBindVertexArray(0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	//Draw index attribute read by pooled shaders. It is fed through baseInstance, which works on GL 4.3
+	//(and llvmpipe) without ARB_shader_draw_parameters. With #version 460, gl_DrawID holds the same value.
+	constexpr unsigned int POOL_DRAW_ID_LOCATION = 3;
+	//Shader storage binding of the per draw data
+	constexpr unsigned int POOL_DRAW_DATA_BINDING = 0;
+
+	//Per draw data, laid out for std430:
+	//struct DrawData { mat4 model; mat4 normalMatrix; };
+	//layout(std430, binding = 0) readonly buffer DrawBuffer { DrawData _Draws[]; };
+	//layout(location = 3) in uint _DrawID;
+	struct PoolDrawData {
+		ew::Mat4 model;
+		ew::Mat4 normalMatrix; //Upper 3x3 is used
+	};
+
+	//Where a mesh lives inside the pool
+	struct PoolMesh {
+		unsigned int baseVertex = 0;
+		unsigned int vertexCount = 0;
+		unsigned int firstIndex = 0;
+		unsigned int indexCount = 0;
+		Bounds bounds;
+	};
+
+	/// <summary>
+	/// Many meshes suballocated from one vertex buffer and one index buffer behind a single VAO.
+	/// Draws are recorded into an indirect command buffer and submitted with one glMultiDrawElementsIndirect.
+	/// Requires OpenGL 4.3.
+	/// </summary>
+	class MeshPool {
+	public:
+		/// <param name="vertexCapacity">Total vertices that can be stored at once</param>
+		/// <param name="indexCapacity">Total indices that can be stored at once</param>
+		MeshPool(unsigned int vertexCapacity, unsigned int indexCapacity);
+		~MeshPool();
+		MeshPool(const MeshPool&) = delete;
+		MeshPool& operator=(const MeshPool&) = delete;
+
+		/// <summary>
+		/// Copies the mesh into the pool.
+		/// </summary>
+		/// <returns>Handle for addDraw, or -1 if there isn't a large enough free range</returns>
+		int add(const MeshData& meshData);
+		/// <summary>
+		/// Allocates ranges for a mesh without uploading anything, so large meshes can be filled over several frames
+		/// with uploadVertices/uploadIndices. Don't draw it until every range has been written.
+		/// </summary>
+		/// <returns>Handle, or -1 if there isn't a large enough free range</returns>
+		int reserve(unsigned int vertexCount, unsigned int indexCount, const Bounds& bounds);
+		//Writes vertices [first, first + count) of a reserved mesh
+		void uploadVertices(int handle, unsigned int first, const Vertex* vertices, unsigned int count);
+		//Writes indices [first, first + count) of a reserved mesh. Indices are relative to the mesh.
+		void uploadIndices(int handle, unsigned int first, const unsigned int* indices, unsigned int count);
+		//Frees the mesh's ranges for reuse. Draws recorded with it must be submitted first.
+		void remove(int handle);
+		inline const PoolMesh& get(int handle)const { return m_meshes[handle]; }
+
+		//Clears recorded draws
+		void beginDraws();
+		//Records one draw of a mesh
+		void addDraw(int handle, const ew::Mat4& model, const ew::Mat4& normalMatrix);
+		void addDraw(int handle, const ew::Mat4& model);
+		//Uploads the recorded draws and issues them in a single call. Bind the shader first.
+		void submit();
+
+		inline size_t getDrawCount()const { return m_commands.size(); }
+		inline unsigned int getVertexCapacity()const { return m_vertexAllocator.capacity; }
+		inline unsigned int getIndexCapacity()const { return m_indexAllocator.capacity; }
+	private:
+		//Layout defined by GL for indirect draws
+		struct DrawCommand {
+			unsigned int count;
+			unsigned int instanceCount;
+			unsigned int firstIndex;
+			int baseVertex;
+			unsigned int baseInstance;
+		};
+
+		//First fit allocator over [0, capacity). Free ranges are sorted and merged on release.
+		struct RangeAllocator {
+			struct Range {
+				unsigned int offset;
+				unsigned int size;
+			};
+			unsigned int capacity = 0;
+			std::vector<Range> freeRanges;
+
+			void reset(unsigned int size);
+			//Returns false if no free range is large enough
+			bool allocate(unsigned int size, unsigned int* offset);
+			void release(unsigned int offset, unsigned int size);
+		};
+
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+		unsigned int m_drawIdBuffer = 0;
+		unsigned int m_indirectBuffer = 0;
+		unsigned int m_drawDataBuffer = 0;
+		unsigned int m_drawIdCapacity = 0;
+
+		RangeAllocator m_vertexAllocator;
+		RangeAllocator m_indexAllocator;
+		std::vector<PoolMesh> m_meshes;
+		std::vector<bool> m_live;
+		std::vector<int> m_freeHandles;
+
+		std::vector<DrawCommand> m_commands;
+		std::vector<PoolDrawData> m_drawData;
+	};
+}
@@ -0,0 +1,203 @@
+#include "meshlet.h"
+#include "culling.h"
+#include "parallel.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace ew {
+	namespace {
+		//Triangles per independently built chunk. Large enough that chunk borders rarely matter.
+		constexpr size_t MESHLET_CHUNK_TRIANGLES = 16384;
+
+		//Greedy clustering of one chunk. Appends the reordered indices to out and meshlets with ranges relative to out.
+		void buildChunk(const unsigned int* indices, size_t triangleCount, std::vector<unsigned int>* out, std::vector<Meshlet>* meshlets) {
+			//Chunk local vertex ids so the adjacency only spans this chunk
+			std::unordered_map<unsigned int, unsigned int> localIds;
+			std::vector<unsigned int> local(triangleCount * 3);
+			for (size_t i = 0; i < triangleCount * 3; i++)
+			{
+				auto it = localIds.emplace(indices[i], (unsigned int)localIds.size()).first;
+				local[i] = it->second;
+			}
+			const size_t vertexCount = localIds.size();
+			std::vector<unsigned int> offsets(vertexCount + 1, 0), adjacency(triangleCount * 3);
+			for (unsigned int v : local)
+				offsets[v + 1]++;
+			for (size_t v = 0; v < vertexCount; v++)
+				offsets[v + 1] += offsets[v];
+			std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < local.size(); i++)
+				adjacency[fill[local[i]]++] = (unsigned int)(i / 3);
+
+			std::vector<bool> emitted(triangleCount, false);
+			//Id of the last meshlet that used each vertex
+			std::vector<int> stamp(vertexCount, -1);
+			std::vector<unsigned int> meshletVertices;
+			meshletVertices.reserve(MESHLET_MAX_VERTICES);
+			size_t cursor = 0;
+			int id = 0;
+			while (true)
+			{
+				while (cursor < triangleCount && emitted[cursor])
+					cursor++;
+				if (cursor == triangleCount)
+					break;
+				Meshlet meshlet;
+				meshlet.firstIndex = (unsigned int)out->size();
+				meshletVertices.clear();
+				size_t triangle = cursor;
+				while (true)
+				{
+					for (int j = 0; j < 3; j++)
+					{
+						const unsigned int v = local[triangle * 3 + j];
+						if (stamp[v] != id) {
+							stamp[v] = id;
+							meshletVertices.push_back(v);
+						}
+						out->push_back(indices[triangle * 3 + j]);
+					}
+					emitted[triangle] = true;
+					meshlet.indexCount += 3;
+					if (meshlet.indexCount == MESHLET_MAX_TRIANGLES * 3)
+						break;
+
+					//Next: the neighbor that adds the fewest new vertices
+					long long best = -1;
+					size_t bestNew = 4;
+					for (unsigned int v : meshletVertices)
+					{
+						for (unsigned int a = offsets[v]; a < offsets[v + 1] && bestNew > 0; a++)
+						{
+							const unsigned int t = adjacency[a];
+							if (emitted[t])
+								continue;
+							size_t newVertices = 0;
+							for (int j = 0; j < 3; j++)
+								newVertices += stamp[local[t * 3 + j]] != id;
+							if (meshletVertices.size() + newVertices <= MESHLET_MAX_VERTICES && newVertices < bestNew) {
+								best = t;
+								bestNew = newVertices;
+							}
+						}
+						if (bestNew == 0)
+							break;
+					}
+					if (best < 0)
+						break;
+					triangle = (size_t)best;
+				}
+				meshlets->push_back(meshlet);
+				id++;
+			}
+		}
+
+		void computeMeshletBounds(const std::vector<Vertex>& vertices, const unsigned int* indices, Meshlet* m) {
+			const unsigned int* tri = indices + m->firstIndex;
+			ew::Vec3 mn = vertices[tri[0]].pos, mx = mn;
+			for (unsigned int i = 1; i < m->indexCount; i++)
+			{
+				const ew::Vec3& p = vertices[tri[i]].pos;
+				mn = ew::Vec3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+				mx = ew::Vec3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+			}
+			m->center = (mn + mx) * 0.5f;
+			float radiusSq = 0.0f;
+			for (unsigned int i = 0; i < m->indexCount; i++)
+			{
+				const ew::Vec3 d = vertices[tri[i]].pos - m->center;
+				radiusSq = std::max(radiusSq, ew::Dot(d, d));
+			}
+			m->radius = sqrtf(radiusSq);
+
+			//Cone around the average face normal, as wide as the furthest normal
+			std::vector<ew::Vec3> normals;
+			normals.reserve(m->indexCount / 3);
+			ew::Vec3 sum = ew::Vec3(0.0f);
+			for (unsigned int i = 0; i < m->indexCount; i += 3)
+			{
+				const ew::Vec3& p0 = vertices[tri[i]].pos;
+				const ew::Vec3 n = ew::Cross(vertices[tri[i + 1]].pos - p0, vertices[tri[i + 2]].pos - p0);
+				const float length = ew::Magnitude(n);
+				if (length <= 0.0f)
+					continue;
+				normals.push_back(n / length);
+				sum += normals.back();
+			}
+			const float sumLength = ew::Magnitude(sum);
+			m->coneAxis = sumLength > 0.0f ? sum / sumLength : ew::Vec3(0.0f, 0.0f, 1.0f);
+			float minDot = sumLength > 0.0f ? 1.0f : -1.0f;
+			for (const ew::Vec3& n : normals)
+				minDot = std::min(minDot, ew::Dot(n, m->coneAxis));
+			m->coneCutoff = minDot > 0.0f ? sqrtf(1.0f - minDot * minDot) : 1.0f;
+		}
+	}
+
+	void buildMeshlets(MeshData& mesh, unsigned int threadCount)
+	{
+		mesh.meshlets.clear();
+		const size_t first = mesh.lods.empty() ? 0 : mesh.lods[0].firstIndex;
+		const size_t count = mesh.lods.empty() ? mesh.indices.size() - mesh.indices.size() % 3 : mesh.lods[0].indexCount;
+		const size_t triangleCount = count / 3;
+		if (triangleCount == 0)
+			return;
+		unsigned int* indices = mesh.indices.data() + first;
+
+		const size_t chunkCount = (triangleCount + MESHLET_CHUNK_TRIANGLES - 1) / MESHLET_CHUNK_TRIANGLES;
+		std::vector<std::vector<unsigned int>> chunkIndices(chunkCount);
+		std::vector<std::vector<Meshlet>> chunkMeshlets(chunkCount);
+		ew::parallelFor(chunkCount, threadCount, 1, [&](size_t begin, size_t end) {
+			for (size_t c = begin; c < end; c++)
+			{
+				const size_t start = c * MESHLET_CHUNK_TRIANGLES;
+				const size_t size = std::min(MESHLET_CHUNK_TRIANGLES, triangleCount - start);
+				chunkIndices[c].reserve(size * 3);
+				buildChunk(indices + start * 3, size, &chunkIndices[c], &chunkMeshlets[c]);
+			}
+		});
+
+		//Chunks keep their place in the index order, so only meshlet offsets change
+		for (size_t c = 0; c < chunkCount; c++)
+		{
+			const size_t start = first + c * MESHLET_CHUNK_TRIANGLES * 3;
+			std::copy(chunkIndices[c].begin(), chunkIndices[c].end(), mesh.indices.begin() + start);
+			for (Meshlet& m : chunkMeshlets[c])
+			{
+				m.firstIndex += (unsigned int)start;
+				mesh.meshlets.push_back(m);
+			}
+		}
+		ew::parallelFor(mesh.meshlets.size(), threadCount, 256, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+				computeMeshletBounds(mesh.vertices, mesh.indices.data(), &mesh.meshlets[i]);
+		});
+	}
+
+	size_t cullMeshlets(const Meshlet* meshlets, size_t count, const ew::Mat4& model, const ew::Camera& camera, unsigned int* visibleIndices)
+	{
+		//Planes and camera in the mesh's local space. Facing is preserved by affine transforms.
+		const Frustum frustum = extractFrustum(camera.ProjectionMatrix() * camera.ViewMatrix() * model);
+		const ew::Mat4 invModel = ew::AffineInverse(model);
+		const ew::Vec3 eye = (invModel * ew::Vec4(camera.position, 1.0f)).toVec3();
+		const ew::Vec3 viewDirection = ew::Normalize((invModel * ew::Vec4(camera.target - camera.position, 0.0f)).toVec3());
+		size_t visible = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			const Meshlet& m = meshlets[i];
+			if (!frustum.intersectsSphere(m.center, m.radius))
+				continue;
+			//Back facing if every view ray into the sphere is within the cone's complement
+			if (camera.orthographic) {
+				if (ew::Dot(viewDirection, m.coneAxis) >= m.coneCutoff)
+					continue;
+			}
+			else {
+				const ew::Vec3 toCenter = m.center - eye;
+				if (ew::Dot(toCenter, m.coneAxis) >= m.coneCutoff * ew::Magnitude(toCenter) + m.radius)
+					continue;
+			}
+			visibleIndices[visible++] = (unsigned int)i;
+		}
+		return visible;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "camera.h"
+
+namespace ew {
+	/// <summary>
+	/// Splits the full detail triangles into meshlets of at most MESHLET_MAX_VERTICES vertices and
+	/// MESHLET_MAX_TRIANGLES triangles, reordering them so each meshlet is a contiguous index range,
+	/// and fills mesh.meshlets with their bounds and normal cones.
+	/// Triangles are grouped greedily by shared vertices, so run optimizeMesh first (it clears meshlets).
+	/// The index order is split into chunks built in parallel on threadCount threads (0 = one per hardware thread).
+	/// </summary>
+	void buildMeshlets(MeshData& mesh, unsigned int threadCount = 0);
+
+	/// <summary>
+	/// Tests meshlets against the camera frustum and their normal cones against the camera position,
+	/// dropping clusters that are off screen or entirely back facing. Done in the mesh's local space,
+	/// so it works for any model matrix.
+	/// </summary>
+	/// <param name="visibleIndices">Must have room for count indices. Receives the visible meshlets in ascending order</param>
+	/// <returns>Number of visible meshlets</returns>
+	size_t cullMeshlets(const Meshlet* meshlets, size_t count, const ew::Mat4& model, const ew::Camera& camera, unsigned int* visibleIndices);
+}
@@ -0,0 +1,177 @@
+#include "noise.h"
+#include "ewMath/simdMath.h"
+#include <cmath>
+#include <cstdint>
+
+namespace ew {
+	namespace {
+		//Unit gradients: 4 axis aligned, 4 diagonal
+		constexpr float DIAGONAL = 0.70710678f;
+		alignas(32) constexpr float GRADIENT_X[8] = { 1.0f, -1.0f, 0.0f, 0.0f, DIAGONAL, -DIAGONAL, DIAGONAL, -DIAGONAL };
+		alignas(32) constexpr float GRADIENT_Y[8] = { 0.0f, 0.0f, 1.0f, -1.0f, DIAGONAL, DIAGONAL, -DIAGONAL, -DIAGONAL };
+		//Unit gradients reach at most sqrt(2)/2, scale to [-1,1]
+		constexpr float NOISE_SCALE = 1.41421356f;
+		constexpr uint32_t OCTAVE_SEED_STEP = 0x9E3779B9u;
+
+		//Written with the same operations and order as the AVX2 lanes, so both paths agree
+		uint32_t hashLattice(int32_t x, int32_t y, uint32_t seed) {
+			uint32_t h = seed ^ ((uint32_t)x * 0x8DA6B343u) ^ ((uint32_t)y * 0xD8163841u);
+			h ^= h >> 15;
+			h *= 0x2C1B3C6Du;
+			h ^= h >> 12;
+			h *= 0x297A2D39u;
+			h ^= h >> 15;
+			return h;
+		}
+
+		float cornerDot(int32_t x, int32_t y, uint32_t seed, float dx, float dy) {
+			const uint32_t g = hashLattice(x, y, seed) & 7;
+			return GRADIENT_X[g] * dx + GRADIENT_Y[g] * dy;
+		}
+
+#if EW_SIMD_X86
+		EW_TARGET_AVX2 __m256i hashLattice8(__m256i x, __m256i y, __m256i seed) {
+			__m256i h = _mm256_xor_si256(seed, _mm256_xor_si256(_mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x8DA6B343u)), _mm256_mullo_epi32(y, _mm256_set1_epi32((int)0xD8163841u))));
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+			h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x2C1B3C6D));
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+			h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x297A2D39));
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+			return h;
+		}
+
+		EW_TARGET_AVX2 __m256 cornerDot8(__m256i x, __m256i y, __m256i seed, __m256 dx, __m256 dy, __m256 gx, __m256 gy) {
+			const __m256i g = _mm256_and_si256(hashLattice8(x, y, seed), _mm256_set1_epi32(7));
+			return _mm256_add_ps(_mm256_mul_ps(_mm256_permutevar8x32_ps(gx, g), dx), _mm256_mul_ps(_mm256_permutevar8x32_ps(gy, g), dy));
+		}
+
+		//Mirrors gradientNoise. Plain mul/add instead of FMA to match the scalar rounding.
+		EW_TARGET_AVX2 __m256 gradientNoise8(__m256 x, __m256 y, __m256i seed) {
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 gx = _mm256_load_ps(GRADIENT_X);
+			const __m256 gy = _mm256_load_ps(GRADIENT_Y);
+			const __m256 fx0 = _mm256_floor_ps(x);
+			const __m256 fy0 = _mm256_floor_ps(y);
+			const __m256i ix = _mm256_cvttps_epi32(fx0);
+			const __m256i iy = _mm256_cvttps_epi32(fy0);
+			const __m256i ix1 = _mm256_add_epi32(ix, _mm256_set1_epi32(1));
+			const __m256i iy1 = _mm256_add_epi32(iy, _mm256_set1_epi32(1));
+			const __m256 fx = _mm256_sub_ps(x, fx0);
+			const __m256 fy = _mm256_sub_ps(y, fy0);
+			const __m256 fx1 = _mm256_sub_ps(fx, one);
+			const __m256 fy1 = _mm256_sub_ps(fy, one);
+
+			const __m256 n00 = cornerDot8(ix, iy, seed, fx, fy, gx, gy);
+			const __m256 n10 = cornerDot8(ix1, iy, seed, fx1, fy, gx, gy);
+			const __m256 n01 = cornerDot8(ix, iy1, seed, fx, fy1, gx, gy);
+			const __m256 n11 = cornerDot8(ix1, iy1, seed, fx1, fy1, gx, gy);
+
+			//Quintic fade t^3 * (t * (6t - 15) + 10)
+			const __m256 six = _mm256_set1_ps(6.0f);
+			const __m256 fifteen = _mm256_set1_ps(15.0f);
+			const __m256 ten = _mm256_set1_ps(10.0f);
+			const __m256 u = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(fx, fx), fx), _mm256_add_ps(_mm256_mul_ps(fx, _mm256_sub_ps(_mm256_mul_ps(fx, six), fifteen)), ten));
+			const __m256 v = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(fy, fy), fy), _mm256_add_ps(_mm256_mul_ps(fy, _mm256_sub_ps(_mm256_mul_ps(fy, six), fifteen)), ten));
+
+			const __m256 nx0 = _mm256_add_ps(n00, _mm256_mul_ps(u, _mm256_sub_ps(n10, n00)));
+			const __m256 nx1 = _mm256_add_ps(n01, _mm256_mul_ps(u, _mm256_sub_ps(n11, n01)));
+			const __m256 n = _mm256_add_ps(nx0, _mm256_mul_ps(v, _mm256_sub_ps(nx1, nx0)));
+			return _mm256_mul_ps(n, _mm256_set1_ps(NOISE_SCALE));
+		}
+
+		//Full batches of 8 only; fbmRow pads the tail
+		EW_TARGET_AVX2 void fbmRowAVX2(float x0, float dx, int first, size_t count, float y, const NoiseParams& params, float* out) {
+			const __m256 laneOffsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+			float ampSum = 0.0f;
+			float amplitude = 1.0f;
+			for (int o = 0; o < params.octaves; o++)
+			{
+				ampSum += amplitude;
+				amplitude *= params.gain;
+			}
+			const __m256 invAmpSum = _mm256_set1_ps(ampSum > 0.0f ? 1.0f / ampSum : 0.0f);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				//Column indices are exact in float well past any grid size
+				const __m256 column = _mm256_add_ps(_mm256_set1_ps((float)(first + (int)i)), laneOffsets);
+				const __m256 x = _mm256_add_ps(_mm256_set1_ps(x0), _mm256_mul_ps(column, _mm256_set1_ps(dx)));
+				__m256 sum = _mm256_setzero_ps();
+				float frequency = params.frequency;
+				amplitude = 1.0f;
+				uint32_t seed = params.seed;
+				for (int o = 0; o < params.octaves; o++)
+				{
+					const __m256 n = gradientNoise8(_mm256_mul_ps(x, _mm256_set1_ps(frequency)), _mm256_set1_ps(y * frequency), _mm256_set1_epi32((int)seed));
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(n, _mm256_set1_ps(amplitude)));
+					frequency *= params.lacunarity;
+					amplitude *= params.gain;
+					seed += OCTAVE_SEED_STEP;
+				}
+				_mm256_storeu_ps(out + i, _mm256_mul_ps(sum, invAmpSum));
+			}
+		}
+#endif
+	}
+
+	float gradientNoise(float x, float y, unsigned int seed)
+	{
+		const float fx0 = floorf(x);
+		const float fy0 = floorf(y);
+		const int32_t ix = (int32_t)fx0;
+		const int32_t iy = (int32_t)fy0;
+		const float fx = x - fx0;
+		const float fy = y - fy0;
+
+		const float n00 = cornerDot(ix, iy, seed, fx, fy);
+		const float n10 = cornerDot(ix + 1, iy, seed, fx - 1.0f, fy);
+		const float n01 = cornerDot(ix, iy + 1, seed, fx, fy - 1.0f);
+		const float n11 = cornerDot(ix + 1, iy + 1, seed, fx - 1.0f, fy - 1.0f);
+
+		//Quintic fade t^3 * (t * (6t - 15) + 10)
+		const float u = fx * fx * fx * (fx * (fx * 6.0f - 15.0f) + 10.0f);
+		const float v = fy * fy * fy * (fy * (fy * 6.0f - 15.0f) + 10.0f);
+
+		const float nx0 = n00 + u * (n10 - n00);
+		const float nx1 = n01 + u * (n11 - n01);
+		return (nx0 + v * (nx1 - nx0)) * NOISE_SCALE;
+	}
+
+	float fbm(float x, float y, const NoiseParams& params)
+	{
+		float sum = 0.0f;
+		float ampSum = 0.0f;
+		float amplitude = 1.0f;
+		float frequency = params.frequency;
+		uint32_t seed = params.seed;
+		for (int o = 0; o < params.octaves; o++)
+		{
+			sum += gradientNoise(x * frequency, y * frequency, seed) * amplitude;
+			ampSum += amplitude;
+			frequency *= params.lacunarity;
+			amplitude *= params.gain;
+			seed += OCTAVE_SEED_STEP;
+		}
+		return ampSum > 0.0f ? sum * (1.0f / ampSum) : 0.0f;
+	}
+
+	void fbmRow(float x0, float dx, int first, size_t count, float y, const NoiseParams& params, float* out)
+	{
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			const size_t full = count & ~(size_t)7;
+			fbmRowAVX2(x0, dx, first, full, y, params, out);
+			if (full < count) {
+				float tail[8];
+				fbmRowAVX2(x0, dx, first + (int)full, 8, y, params, tail);
+				for (size_t i = full; i < count; i++)
+					out[i] = tail[i - full];
+			}
+			return;
+		}
+#endif
+		for (size_t i = 0; i < count; i++)
+		{
+			out[i] = fbm(x0 + (float)(first + (int)i) * dx, y, params);
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+namespace ew {
+	//Fractal (fBm) gradient noise settings
+	struct NoiseParams {
+		int octaves = 6;
+		//Cycles per unit of the first octave
+		float frequency = 1.0f / 64.0f;
+		//Frequency multiplier per octave
+		float lacunarity = 2.0f;
+		//Amplitude multiplier per octave
+		float gain = 0.5f;
+		unsigned int seed = 0;
+	};
+
+	/// <summary>
+	/// 2D gradient (Perlin style) noise on an integer lattice, in [-1,1].
+	/// </summary>
+	float gradientNoise(float x, float y, unsigned int seed);
+
+	/// <summary>
+	/// Sum of params.octaves gradient noise octaves, normalized to [-1,1].
+	/// </summary>
+	float fbm(float x, float y, const NoiseParams& params);
+
+	/// <summary>
+	/// out[i] = fbm(x0 + (first + i) * dx, y) for i in [0, count). Uses AVX2 for 8 points at a time when available.
+	/// Every point of a row goes through the same code path, so overlapping rows computed with different first/count agree exactly.
+	/// The AVX2 and scalar paths agree to within float rounding.
+	/// </summary>
+	void fbmRow(float x0, float dx, int first, size_t count, float y, const NoiseParams& params, float* out);
+}
@@ -0,0 +1,98 @@
+#include "parallel.h"
+#include <thread>
+#include <vector>
+#include <utility>
+
+namespace ew {
+	unsigned int hardwareThreadCount() {
+		unsigned int n = std::thread::hardware_concurrency();
+		return n > 0 ? n : 1;
+	}
+	void parallelFor(size_t count, unsigned int threadCount, size_t grain, const std::function<void(size_t begin, size_t end)>& fn)
+	{
+		if (count == 0)
+			return;
+		if (threadCount == 0)
+			threadCount = hardwareThreadCount();
+		if (grain == 0)
+			grain = 1;
+		//Don't spin up threads that would get less than one grain of work
+		size_t maxThreads = (count + grain - 1) / grain;
+		if (threadCount > maxThreads)
+			threadCount = (unsigned int)maxThreads;
+		if (threadCount <= 1) {
+			fn(0, count);
+			return;
+		}
+		size_t chunk = (count + threadCount - 1) / threadCount;
+		chunk = ((chunk + grain - 1) / grain) * grain;
+
+		std::vector<std::thread> workers;
+		workers.reserve(threadCount - 1);
+		for (size_t begin = chunk; begin < count; begin += chunk)
+		{
+			size_t end = begin + chunk < count ? begin + chunk : count;
+			workers.emplace_back(fn, begin, end);
+		}
+		fn(0, chunk < count ? chunk : count);
+		for (std::thread& t : workers) {
+			t.join();
+		}
+	}
+
+	WorkerPool::WorkerPool(unsigned int threadCount)
+	{
+		if (threadCount == 0)
+			threadCount = hardwareThreadCount() > 1 ? hardwareThreadCount() - 1 : 1;
+		m_threads.reserve(threadCount);
+		for (unsigned int i = 0; i < threadCount; i++)
+		{
+			m_threads.emplace_back(&WorkerPool::run, this);
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.clear();
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& t : m_threads) {
+			t.join();
+		}
+	}
+
+	void WorkerPool::submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_wake.notify_one();
+	}
+
+	size_t WorkerPool::busyCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_jobs.size() + m_running;
+	}
+
+	void WorkerPool::run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true) {
+			m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+			if (m_stop)
+				return;
+			std::function<void()> job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			m_running++;
+			lock.unlock();
+			job();
+			lock.lock();
+			m_running--;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ew {
+	/// <summary>
+	/// Splits [0,count) into contiguous ranges and calls fn(begin, end) for each range on up to threadCount threads.
+	/// The calling thread runs the first range. Returns when every range has finished.
+	/// </summary>
+	/// <param name="count">Number of items</param>
+	/// <param name="threadCount">Max threads to use. 0 = one per hardware thread</param>
+	/// <param name="grain">Range sizes are rounded up to a multiple of this (e.g. SIMD width)</param>
+	/// <param name="fn">Work function. Called concurrently with disjoint ranges.</param>
+	void parallelFor(size_t count, unsigned int threadCount, size_t grain, const std::function<void(size_t begin, size_t end)>& fn);
+	//Number of hardware threads, at least 1
+	unsigned int hardwareThreadCount();
+
+	/// <summary>
+	/// Persistent worker threads running submitted jobs in FIFO order, for background work that outlives a frame
+	/// (parallelFor starts and joins its threads on every call).
+	/// </summary>
+	class WorkerPool {
+	public:
+		/// <param name="threadCount">Worker threads. 0 = one less than the hardware threads, at least 1</param>
+		explicit WorkerPool(unsigned int threadCount = 0);
+		//Drops jobs that haven't started and waits for running ones
+		~WorkerPool();
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		//Queues a job. Jobs run concurrently, so they must not touch GL or unsynchronized shared state.
+		void submit(std::function<void()> job);
+		//Jobs queued or running
+		size_t busyCount();
+		inline unsigned int getThreadCount()const { return (unsigned int)m_threads.size(); }
+	private:
+		void run();
+
+		std::vector<std::thread> m_threads;
+		std::deque<std::function<void()>> m_jobs;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		size_t m_running = 0;
+		bool m_stop = false;
+	};
+}
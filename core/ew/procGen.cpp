@@ -4,17 +4,55 @@
 
 
 #include "procGen.h"
+#include "parallel.h"
 #include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
 
 namespace ew {
+	//Built at compile time
+	static constexpr ew::Vec3 CUBE_FACE_NORMALS[6] = {
+		ew::Vec3{ +0.0f,+0.0f,+1.0f }, //Front
+		ew::Vec3{ +1.0f,+0.0f,+0.0f }, //Right
+		ew::Vec3{ +0.0f,+1.0f,+0.0f }, //Top
+		ew::Vec3{ -1.0f,+0.0f,+0.0f }, //Left
+		ew::Vec3{ +0.0f,-1.0f,+0.0f }, //Bottom
+		ew::Vec3{ +0.0f,+0.0f,-1.0f }  //Back
+	};
+
+	//Subdivision counts below these produce no triangles
+	static int planeSubdivisions(const PlaneParams& params) { return params.subdivisions < 1 ? 1 : params.subdivisions; }
+	//Fewer rows have no side between the caps
+	static int sphereSubdivisions(const SphereParams& params) { return params.subdivisions < 2 ? 2 : params.subdivisions; }
+	static int cylinderSubdivisions(const CylinderParams& params) { return params.subdivisions < 1 ? 1 : params.subdivisions; }
+
+	static bool fits(const MeshCounts& counts, const VertexSpan& vertices, const IndexSpan& indices, const char* generator) {
+		if (vertices.size >= counts.vertexCount && indices.size >= counts.indexCount)
+			return true;
+		printf("%s needs %zu vertices and %zu indices, got %zu and %zu\n", generator, counts.vertexCount, counts.indexCount, vertices.size, indices.size);
+		return false;
+	}
+
+	AngleTable::AngleTable(float step, int count)
+		:sin(count + 1), cos(count + 1)
+	{
+		for (int i = 0; i <= count; i++)
+		{
+			const float angle = i * step;
+			sin[i] = sinf(angle);
+			cos[i] = cosf(angle);
+		}
+	}
+
 	/// <summary>
-	/// Helper function for createCube. Note that this is not meant to be used standalone
+	/// Helper function for emit(CubeParams). Note that this is not meant to be used standalone
 	/// </summary>
 	/// <param name="normal">Normal direction of the face</param>
 	/// <param name="size">Width/height of the face</param>
-	/// <param name="mesh">MeshData struct to fill</param>
-	static void createCubeFace(ew::Vec3 normal, float size, MeshData* mesh) {
-		unsigned int startVertex = mesh->vertices.size();
+	/// <param name="vertices">4 vertices to fill</param>
+	/// <param name="indices">6 indices to fill</param>
+	/// <param name="startVertex">Index of vertices[0]</param>
+	static void createCubeFace(ew::Vec3 normal, float size, Vertex* vertices, unsigned int* indices, unsigned int startVertex) {
 		ew::Vec3 a = ew::Vec3(normal.z, normal.x, normal.y); //U axis
 		ew::Vec3 b = ew::Cross(normal, a); //V axis
 		for (int i = 0; i < 4; i++)
@@ -25,213 +63,567 @@ namespace ew {
 			ew::Vec3 pos = normal * size * 0.5f;
 			pos -= (a + b) * size * 0.5f;
 			pos += (a * col + b * row) * size;
-			Vertex vertex;// = &mesh->vertices[mesh->vertices.size()];
-			vertex.pos = pos;
-			vertex.normal = normal;
-			vertex.uv = ew::Vec2(col, row);
-			mesh->vertices.push_back(vertex);
+			vertices[i].pos = pos;
+			vertices[i].normal = normal;
+			vertices[i].uv = ew::Vec2(col, row);
 		}
 
 		//Indices
-		mesh->indices.push_back(startVertex);
-		mesh->indices.push_back(startVertex + 1);
-		mesh->indices.push_back(startVertex + 3);
-		mesh->indices.push_back(startVertex + 3);
-		mesh->indices.push_back(startVertex + 2);
-		mesh->indices.push_back(startVertex);
+		indices[0] = startVertex;
+		indices[1] = startVertex + 1;
+		indices[2] = startVertex + 3;
+		indices[3] = startVertex + 3;
+		indices[4] = startVertex + 2;
+		indices[5] = startVertex;
+	}
+	MeshCounts queryCounts(const CubeParams&)
+	{
+		MeshCounts counts;
+		counts.vertexCount = 24; //6 x 4 vertices
+		counts.indexCount = 36; //6 x 6 indices
+		return counts;
+	}
+	Bounds queryBounds(const CubeParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(-params.size * 0.5f), ew::Vec3(params.size * 0.5f));
+	}
+	bool emit(const CubeParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex)
+	{
+		if (!fits(queryCounts(params), vertices, indices, "Cube"))
+			return false;
+		for (int face = 0; face < 6; face++) {
+			createCubeFace(CUBE_FACE_NORMALS[face], params.size, vertices.data + face * 4, indices.data + face * 6, baseVertex + face * 4);
+		}
+		return true;
 	}
 	/// <summary>
 	/// Creates a cube of uniform size
 	/// </summary>
 	/// <param name="size">Total width, height, depth</param>
-	/// <param name="mesh">MeshData struct to fill. Will be cleared.</param>
 	MeshData createCube(float size) {
-		MeshData mesh;
-		mesh.vertices.reserve(24); //6 x 4 vertices
-		mesh.indices.reserve(36); //6 x 6 indices
-		createCubeFace(ew::Vec3{ +0.0f,+0.0f,+1.0f }, size, &mesh); //Front
-		createCubeFace(ew::Vec3{ +1.0f,+0.0f,+0.0f }, size, &mesh); //Right
-		createCubeFace(ew::Vec3{ +0.0f,+1.0f,+0.0f }, size, &mesh); //Top
-		createCubeFace(ew::Vec3{ -1.0f,+0.0f,+0.0f }, size, &mesh); //Left
-		createCubeFace(ew::Vec3{ +0.0f,-1.0f,+0.0f }, size, &mesh); //Bottom
-		createCubeFace(ew::Vec3{ +0.0f,+0.0f,-1.0f }, size, &mesh); //Back
-		return mesh;
-	}
-	MeshData createPlane(float width, float height, int subdivisions)
+		CubeParams params;
+		params.size = size;
+		return createMesh(params);
+	}
+
+	MeshCounts queryCounts(const PlaneParams& params)
 	{
-		//VERTICES
-		MeshData mesh;
-		int columns = subdivisions + 1;
-		for (size_t row = 0; row <= subdivisions; row++)
-		{
-			for (size_t col = 0; col <= subdivisions; col++)
-			{
-				Vertex v;
-				v.uv.x = ((float)col / subdivisions);
-				v.uv.y = ((float)row / subdivisions);
-				v.pos.x = -width/2 + width * v.uv.x;
-				v.pos.y = 0;
-				v.pos.z = height/2 -height * v.uv.y;
-				v.normal = ew::Vec3(0, 1, 0);
-				mesh.vertices.push_back(v);
-			}
-		}
-		//INDICES
-		for (size_t row = 0; row < subdivisions; row++)
-		{
-			for (size_t col = 0; col < subdivisions; col++)
+		const size_t subdivisions = planeSubdivisions(params);
+		MeshCounts counts;
+		counts.vertexCount = (subdivisions + 1) * (subdivisions + 1);
+		counts.indexCount = subdivisions * subdivisions * 6;
+		return counts;
+	}
+	Bounds queryBounds(const PlaneParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(-params.width * 0.5f, 0, -params.height * 0.5f), ew::Vec3(params.width * 0.5f, 0, params.height * 0.5f));
+	}
+	bool emit(const PlaneParams& params, VertexSpan vertexSpan, IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertexSpan, indexSpan, "Plane"))
+			return false;
+		const float width = params.width;
+		const float height = params.height;
+		const int subdivisions = planeSubdivisions(params);
+		const size_t columns = subdivisions + 1;
+		Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
+		//Each row writes its vertices and the quads below it, so bands are independent
+		ew::parallelFor(columns, threadCount, procGenRowGrain(columns), [&](size_t begin, size_t end) {
+			for (size_t row = begin; row < end; row++)
 			{
-				int start = row * columns + col;
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
-				mesh.indices.push_back(start + columns + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start);
+				//VERTICES
+				Vertex* v = vertices + row * columns;
+				for (size_t col = 0; col < columns; col++, v++)
+				{
+					v->uv.x = ((float)col / subdivisions);
+					v->uv.y = ((float)row / subdivisions);
+					v->pos.x = -width / 2 + width * v->uv.x;
+					v->pos.y = 0;
+					v->pos.z = height / 2 - height * v->uv.y;
+					v->normal = ew::Vec3(0, 1, 0);
+				}
+				//INDICES
+				if (row == (size_t)subdivisions)
+					continue;
+				unsigned int* index = indices + row * subdivisions * 6;
+				for (size_t col = 0; col < (size_t)subdivisions; col++)
+				{
+					unsigned int start = baseVertex + (unsigned int)(row * columns + col);
+					*index++ = start;
+					*index++ = start + 1;
+					*index++ = start + columns + 1;
+					*index++ = start + columns + 1;
+					*index++ = start + columns;
+					*index++ = start;
+				}
 			}
-		}
-		return mesh;
+		});
+		return true;
 	}
-	MeshData createSphere(float radius, int subdivisions)
+	MeshData createPlane(float width, float height, int subdivisions, unsigned int threadCount)
 	{
-		MeshData mesh;
-		//VERTICES
-		float thetaStep = ew::TAU / subdivisions;
-		float phiStep = ew::PI / subdivisions;
-		for (size_t row = 0; row <= subdivisions; row++)
-		{
-			float phi = row * phiStep;
-			for (size_t col = 0; col <= subdivisions; col++)
+		PlaneParams params;
+		params.width = width;
+		params.height = height;
+		params.subdivisions = subdivisions;
+		return createMesh(params, threadCount);
+	}
+
+	MeshCounts queryCounts(const SphereParams& params)
+	{
+		const size_t subdivisions = sphereSubdivisions(params);
+		MeshCounts counts;
+		counts.vertexCount = (subdivisions + 1) * (subdivisions + 1);
+		//Two caps of triangles and rows of quads between them
+		counts.indexCount = subdivisions * 3 * 2 + subdivisions * 6 * (subdivisions - 2);
+		return counts;
+	}
+	Bounds queryBounds(const SphereParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(-params.radius), ew::Vec3(params.radius), params.radius);
+	}
+	bool emit(const SphereParams& params, VertexSpan vertexSpan, IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertexSpan, indexSpan, "Sphere"))
+			return false;
+		const float radius = params.radius;
+		const int subdivisions = sphereSubdivisions(params);
+		const size_t columns = subdivisions + 1;
+		const size_t capIndices = (size_t)subdivisions * 3;
+		const size_t rowIndices = (size_t)subdivisions * 6;
+		const AngleTable theta(ew::TAU / subdivisions, subdivisions);
+		const AngleTable phi(ew::PI / subdivisions, subdivisions);
+		Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
+		ew::parallelFor(columns, threadCount, procGenRowGrain(columns), [&](size_t begin, size_t end) {
+			for (size_t row = begin; row < end; row++)
 			{
-				float theta = thetaStep * col;
-				Vertex v;
-				v.normal.x = cosf(theta) * sinf(phi);
-				v.normal.y = cosf(phi);
-				v.normal.z = sinf(theta) * sinf(phi);
-				v.pos = v.normal * radius;
-				v.uv.x = (float)col / subdivisions;
-				v.uv.y = 1.0 - ((float)row / subdivisions);
-				mesh.vertices.push_back(v);
+				//VERTICES
+				Vertex* v = vertices + row * columns;
+				for (size_t col = 0; col < columns; col++, v++)
+				{
+					v->normal.x = theta.cos[col] * phi.sin[row];
+					v->normal.y = phi.cos[row];
+					v->normal.z = theta.sin[col] * phi.sin[row];
+					v->pos = v->normal * radius;
+					v->uv.x = (float)col / subdivisions;
+					v->uv.y = 1.0f - ((float)row / subdivisions);
+				}
+
+				//INDICES
+				const unsigned int rowStart = baseVertex + (unsigned int)(row * columns);
+				if (row == 0) {
+					//Top cap
+					const unsigned int sideStart = rowStart + (unsigned int)columns;
+					const unsigned int poleStart = rowStart;
+					unsigned int* index = indices;
+					for (unsigned int i = 0; i < (unsigned int)subdivisions; i++)
+					{
+						*index++ = sideStart + i;
+						*index++ = poleStart + i;
+						*index++ = sideStart + i + 1;
+					}
+				}
+				else if (row < (size_t)subdivisions - 1) {
+					//Rows of quads for sides
+					unsigned int* index = indices + capIndices + (row - 1) * rowIndices;
+					for (unsigned int col = 0; col < (unsigned int)subdivisions; col++)
+					{
+						unsigned int start = rowStart + col;
+						*index++ = start;
+						*index++ = start + 1;
+						*index++ = start + columns;
+						*index++ = start + columns;
+						*index++ = start + 1;
+						*index++ = start + columns + 1;
+					}
+				}
+				if (row == (size_t)subdivisions - 1) {
+					//Bottom cap
+					const unsigned int poleStart = rowStart + (unsigned int)columns;
+					const unsigned int sideStart = rowStart;
+					unsigned int* index = indices + capIndices + (subdivisions - 2) * rowIndices;
+					for (unsigned int i = 0; i < (unsigned int)subdivisions; i++)
+					{
+						*index++ = sideStart + i;
+						*index++ = sideStart + i + 1;
+						*index++ = poleStart + i;
+					}
+				}
 			}
+		});
+		return true;
+	}
+	MeshData createSphere(float radius, int subdivisions, unsigned int threadCount)
+	{
+		SphereParams params;
+		params.radius = radius;
+		params.subdivisions = subdivisions;
+		return createMesh(params, threadCount);
+	}
+
+	static void createCylinderRingVertex(Vertex* v, const AngleTable& angles, int i, int subdivisions, float radius, float y, bool sideFacing) {
+		const float cosA = angles.cos[i];
+		const float sinA = angles.sin[i];
+		v->pos = ew::Vec3(cosA * radius, y, sinA * radius);
+		if (sideFacing) {
+			v->normal = ew::Vec3(cosA, 0, sinA);
+			v->uv = ew::Vec2((float)i / subdivisions, y > 0 ? 1 : 0);
 		}
-		
-		//INDICES
-		unsigned int columns = subdivisions + 1;
-		unsigned int sideStart = columns;
-		unsigned int poleStart = 0;
-		//Top cap
-		for (size_t i = 0; i < subdivisions; i++)
-		{
-			mesh.indices.push_back(sideStart + i);
-			mesh.indices.push_back(poleStart + i);
-			mesh.indices.push_back(sideStart +i+1);
+		else {
+			v->normal = ew::Vec3(0, ew::Sign(y), 0);
+			v->uv = ew::Vec2(cosA * 0.5f + 0.5f, sinA * 0.5f + 0.5f);
 		}
-		//Rows of quads for sides
-		for (size_t row = 1; row < subdivisions - 1; row++)
-		{
-			for (size_t col = 0; col < subdivisions; col++)
+	}
+	MeshCounts queryCounts(const CylinderParams& params)
+	{
+		const size_t subdivisions = cylinderSubdivisions(params);
+		MeshCounts counts;
+		//Two centers and four rings
+		counts.vertexCount = 2 + (subdivisions + 1) * 4;
+		//Two caps and a row of quads
+		counts.indexCount = subdivisions * 12;
+		return counts;
+	}
+	Bounds queryBounds(const CylinderParams& params)
+	{
+		const float radius = params.radius;
+		const float height = params.height;
+		return ew::makeBounds(ew::Vec3(-radius, -height * 0.5f, -radius), ew::Vec3(radius, height * 0.5f, radius), sqrtf(radius * radius + height * height * 0.25f));
+	}
+	bool emit(const CylinderParams& params, VertexSpan vertexSpan, IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertexSpan, indexSpan, "Cylinder"))
+			return false;
+		const float radius = params.radius;
+		const int subdivisions = cylinderSubdivisions(params);
+		const unsigned int columns = subdivisions + 1;
+		//Top center, top cap ring, top side ring, bottom side ring, bottom cap ring, bottom center
+		const unsigned int topCapStart = 1;
+		const unsigned int topSideStart = topCapStart + columns;
+		const unsigned int bottomSideStart = topSideStart + columns;
+		const unsigned int bottomCapStart = bottomSideStart + columns;
+		const unsigned int bottomIndex = bottomCapStart + columns;
+		const size_t capIndices = (size_t)subdivisions * 3;
+
+		const float topY = params.height * 0.5;
+		const float bottomY = -topY;
+		const AngleTable angles(ew::TAU / subdivisions, subdivisions);
+		Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
+
+		//VERTICES
+		vertices[0].pos = ew::Vec3(0, topY, 0);
+		vertices[0].normal = ew::Vec3(0, 1, 0);
+		vertices[0].uv = ew::Vec2(0.5);
+		vertices[bottomIndex].pos = ew::Vec3(0, bottomY, 0);
+		vertices[bottomIndex].normal = ew::Vec3(0, -1, 0);
+		vertices[bottomIndex].uv = ew::Vec2(0.5);
+
+		ew::parallelFor(columns, threadCount, 4096, [&](size_t begin, size_t end) {
+			for (unsigned int i = (unsigned int)begin; i < (unsigned int)end; i++)
 			{
-				int start = row * columns + col;
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
+				createCylinderRingVertex(&vertices[topCapStart + i], angles, i, subdivisions, radius, topY, false);
+				createCylinderRingVertex(&vertices[topSideStart + i], angles, i, subdivisions, radius, topY, true);
+				createCylinderRingVertex(&vertices[bottomSideStart + i], angles, i, subdivisions, radius, bottomY, true);
+				createCylinderRingVertex(&vertices[bottomCapStart + i], angles, i, subdivisions, radius, bottomY, false);
+
+				//INDICES
+				if (i == (unsigned int)subdivisions)
+					continue;
+				//Top cap
+				unsigned int* index = indices + i * 3;
+				index[0] = baseVertex;
+				index[1] = baseVertex + topCapStart + i + 1;
+				index[2] = baseVertex + topCapStart + i;
+				//Sides
+				index = indices + capIndices + i * 6;
+				unsigned int start = baseVertex + topSideStart + i;
+				index[0] = start;
+				index[1] = start + 1;
+				index[2] = start + columns;
+				index[3] = start + columns;
+				index[4] = start + 1;
+				index[5] = start + columns + 1;
+				//Bottom cap
+				index = indices + capIndices * 3 + i * 3;
+				index[0] = baseVertex + bottomIndex;
+				index[1] = baseVertex + bottomCapStart + i;
+				index[2] = baseVertex + bottomCapStart + i + 1;
 			}
-		}
-		//Bottom cap
-		poleStart = (columns * columns) - columns;
-		sideStart = poleStart - columns;
-		for (size_t i = 0; i < subdivisions; i++)
-		{
-			mesh.indices.push_back(sideStart + i);
-			mesh.indices.push_back(sideStart + i + 1);
-			mesh.indices.push_back(poleStart + i);
-		}
-		return mesh;
+		});
+		return true;
+	}
+	MeshData createCylinder(float radius, float height, int subdivisions, unsigned int threadCount)
+	{
+		CylinderParams params;
+		params.radius = radius;
+		params.height = height;
+		params.subdivisions = subdivisions;
+		return createMesh(params, threadCount);
 	}
-	void createCylinderRing(MeshData* meshData, float radius, int subdivisions, float y, bool sideFacing) {
-		float thetaStep = ew::TAU / subdivisions;
-		for (size_t i = 0; i <= subdivisions; i++)
-		{
-			float theta = i * thetaStep;
-			float cosA = cosf(theta);
-			float sinA = sinf(theta);
-			ew::Vertex v;
-			v.pos = ew::Vec3(cosA * radius, y, sinA * radius);
-			if (sideFacing) {
-				v.normal = ew::Vec3(cosA, 0, sinA);
-				v.uv = ew::Vec2((float)i / subdivisions, y > 0 ? 1 : 0);
-			}
-			else {
-				v.normal = ew::Vec3(0, ew::Sign(y), 0);
-				v.uv = ew::Vec2(cosA * 0.5 + 0.5, sinA * 0.5 + 0.5);
-			}
 
-			meshData->vertices.push_back(v);
+	//Golden ratio, for the icosahedron's corners
+	static constexpr float ICOSAHEDRON_T = 1.61803398875f;
+	static constexpr ew::Vec3 ICOSAHEDRON_CORNERS[12] = {
+		ew::Vec3{ -1, +ICOSAHEDRON_T, 0 }, ew::Vec3{ +1, +ICOSAHEDRON_T, 0 }, ew::Vec3{ -1, -ICOSAHEDRON_T, 0 }, ew::Vec3{ +1, -ICOSAHEDRON_T, 0 },
+		ew::Vec3{ 0, -1, +ICOSAHEDRON_T }, ew::Vec3{ 0, +1, +ICOSAHEDRON_T }, ew::Vec3{ 0, -1, -ICOSAHEDRON_T }, ew::Vec3{ 0, +1, -ICOSAHEDRON_T },
+		ew::Vec3{ +ICOSAHEDRON_T, 0, -1 }, ew::Vec3{ +ICOSAHEDRON_T, 0, +1 }, ew::Vec3{ -ICOSAHEDRON_T, 0, -1 }, ew::Vec3{ -ICOSAHEDRON_T, 0, +1 }
+	};
+	//Counter clockwise from outside
+	static constexpr unsigned int ICOSAHEDRON_FACES[20 * 3] = {
+		0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+		1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+		3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+		4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1
+	};
+	static constexpr ew::Vec3 CUBE_CORNERS[8] = {
+		ew::Vec3{ -1, -1, -1 }, ew::Vec3{ +1, -1, -1 }, ew::Vec3{ -1, +1, -1 }, ew::Vec3{ +1, +1, -1 },
+		ew::Vec3{ -1, -1, +1 }, ew::Vec3{ +1, -1, +1 }, ew::Vec3{ -1, +1, +1 }, ew::Vec3{ +1, +1, +1 }
+	};
+	//Corners (00, 10, 01, 11) of each face, with cross(10 - 00, 01 - 00) facing out
+	static constexpr unsigned int CUBE_FACES[6 * 4] = {
+		1, 3, 5, 7, //+X
+		0, 4, 2, 6, //-X
+		2, 6, 3, 7, //+Y
+		0, 1, 4, 5, //-Y
+		4, 5, 6, 7, //+Z
+		0, 2, 1, 3  //-Z
+	};
+
+	//Base shape for subdivideSphere
+	struct SpherePolyhedron {
+		const ew::Vec3* corners;
+		unsigned int cornerCount;
+		const unsigned int* faces;
+		unsigned int faceCount;
+		//3 or 4
+		unsigned int faceCorners;
+	};
+	static const SpherePolyhedron ICOSAHEDRON = { ICOSAHEDRON_CORNERS, 12, ICOSAHEDRON_FACES, 20, 3 };
+	static const SpherePolyhedron CUBE = { CUBE_CORNERS, 8, CUBE_FACES, 6, 4 };
+
+	static int sphereSubdivisions(int subdivisions, int targetTriangles, int trianglesPerFace) {
+		if (targetTriangles > 0)
+			subdivisions = (int)(sqrtf((float)targetTriangles / trianglesPerFace) + 0.5f);
+		return subdivisions < 1 ? 1 : subdivisions;
+	}
+	static int icosphereSubdivisions(const IcosphereParams& params) { return sphereSubdivisions(params.subdivisions, params.targetTriangles, 20); }
+	static int cubeSphereSubdivisions(const CubeSphereParams& params) { return sphereSubdivisions(params.subdivisions, params.targetTriangles, 12); }
+
+	static MeshCounts subdividedSphereCounts(const SpherePolyhedron& base, size_t subdivisions) {
+		const size_t edgeCount = base.faceCount * base.faceCorners / 2;
+		const size_t faceInterior = base.faceCorners == 3 ? (subdivisions - 1) * (subdivisions - 2) / 2 : (subdivisions - 1) * (subdivisions - 1);
+		MeshCounts counts;
+		counts.vertexCount = base.cornerCount + edgeCount * (subdivisions - 1) + base.faceCount * faceInterior;
+		counts.indexCount = base.faceCount * subdivisions * subdivisions * (base.faceCorners - 2) * 3;
+		return counts;
+	}
+
+	//Point on the base shape to sphere vertex
+	static void sphereVertex(const ew::Vec3& point, float radius, bool equalAngle, Vertex* v) {
+		ew::Vec3 p = point;
+		if (equalAngle) {
+			//Cube coordinates in [-1,1] to tangents of equal angle steps, so cells near face centers aren't larger
+			p = ew::Vec3(tanf(p.x * ew::PI * 0.25f), tanf(p.y * ew::PI * 0.25f), tanf(p.z * ew::PI * 0.25f));
 		}
+		v->normal = ew::Normalize(p);
+		v->pos = v->normal * radius;
+		float u = atan2f(v->normal.z, v->normal.x) / ew::TAU;
+		v->uv.x = u < 0.0f ? u + 1.0f : u;
+		v->uv.y = 1.0f - acosf(ew::Clamp(v->normal.y, -1.0f, 1.0f)) / ew::PI;
 	}
-	MeshData createCylinder(float radius, float height, int subdivisions)
-	{
-		MeshData mesh;
 
-		//VERTICES
+	/// <summary>
+	/// Splits every edge of base into subdivisions segments and projects the grid onto a sphere.
+	/// Vertices are laid out as corners, then subdivisions - 1 per edge, then each face's interior,
+	/// so shared vertices have one fixed index and faces can be filled independently.
+	/// </summary>
+	static void subdivideSphere(const SpherePolyhedron& base, int subdivisions, float radius, Vertex* vertices, unsigned int* indices,
+		unsigned int baseVertex, unsigned int threadCount) {
+		const unsigned int s = (unsigned int)subdivisions;
+		const unsigned int corners = base.faceCorners;
+		const bool equalAngle = corners == 4;
+
+		//Edges as (low corner, high corner), and which edge each side of a face is
+		//Triangle sides: (0,1) (0,2) (1,2). Quad sides: (00,10) (10,11) (01,11) (00,01).
+		static constexpr unsigned int TRIANGLE_SIDES[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+		static constexpr unsigned int QUAD_SIDES[4][2] = { { 0, 1 }, { 1, 3 }, { 2, 3 }, { 0, 2 } };
+		std::vector<unsigned int> edges;
+		std::vector<unsigned int> faceEdges(base.faceCount * corners);
+		for (unsigned int f = 0; f < base.faceCount; f++)
 		{
-			const float topY = height * 0.5;
-			const float bottomY = -topY;
-
-			ew::Vertex topVertex;
-			topVertex.pos = ew::Vec3(0, topY, 0);
-			topVertex.normal = ew::Vec3(0, 1, 0);
-			topVertex.uv = ew::Vec2(0.5);
-			mesh.vertices.push_back(topVertex);
-
-			createCylinderRing(&mesh, radius, subdivisions, topY, false);
-			createCylinderRing(&mesh, radius, subdivisions, topY, true);
-			createCylinderRing(&mesh, radius, subdivisions, bottomY, true);
-			createCylinderRing(&mesh, radius, subdivisions, bottomY, false);
-
-			ew::Vertex bottomVertex;
-			bottomVertex.pos = ew::Vec3(0, bottomY, 0);
-			bottomVertex.normal = ew::Vec3(0, -1, 0);
-			bottomVertex.uv = ew::Vec2(0.5);
-			mesh.vertices.push_back(bottomVertex);
+			for (unsigned int side = 0; side < corners; side++)
+			{
+				const unsigned int* sideCorners = corners == 3 ? TRIANGLE_SIDES[side] : QUAD_SIDES[side];
+				unsigned int a = base.faces[f * corners + sideCorners[0]];
+				unsigned int b = base.faces[f * corners + sideCorners[1]];
+				if (a > b)
+					std::swap(a, b);
+				unsigned int id = 0;
+				while (id < edges.size() / 2 && (edges[id * 2] != a || edges[id * 2 + 1] != b))
+					id++;
+				if (id == edges.size() / 2) {
+					edges.push_back(a);
+					edges.push_back(b);
+				}
+				faceEdges[f * corners + side] = id;
+			}
 		}
-		
+		const unsigned int edgeCount = (unsigned int)edges.size() / 2;
+		const unsigned int edgeStart = base.cornerCount;
+		const unsigned int faceStart = edgeStart + edgeCount * (s - 1);
+		const unsigned int faceInterior = corners == 3 ? (s - 1) * (s - 2) / 2 : (s - 1) * (s - 1);
+		const unsigned int faceTriangles = s * s * (corners - 2);
 
-		//INDICES
+		//VERTICES: corners and edges are shared, so they are written once up front
+		for (unsigned int c = 0; c < base.cornerCount; c++)
 		{
-			int columns = subdivisions + 1;
-			//Top cap
-			for (size_t i = 0; i < columns; i++)
+			sphereVertex(base.corners[c], radius, equalAngle, &vertices[c]);
+		}
+		ew::parallelFor(edgeCount, threadCount, 4096 / s + 1, [&](size_t begin, size_t end) {
+			for (size_t e = begin; e < end; e++)
 			{
-				mesh.indices.push_back(0);
-				mesh.indices.push_back(i + 1);
-				mesh.indices.push_back(i);
+				const ew::Vec3& a = base.corners[edges[e * 2]];
+				const ew::Vec3& b = base.corners[edges[e * 2 + 1]];
+				for (unsigned int k = 1; k < s; k++)
+				{
+					sphereVertex(a + (b - a) * ((float)k / s), radius, equalAngle, &vertices[edgeStart + e * (s - 1) + k - 1]);
+				}
 			}
-			int sideStart = columns;
-			//Sides
-			for (size_t i = 0; i < columns; i++)
-			{
-				int start = sideStart + i;
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
+		});
+
+		//Index of grid point k steps along a face side going from corner a to corner b
+		auto edgeVertex = [&](unsigned int face, unsigned int side, unsigned int a, unsigned int b, unsigned int k) {
+			const unsigned int* c = base.faces + face * corners;
+			const unsigned int e = faceEdges[face * corners + side];
+			if (k == 0)
+				return c[a];
+			if (k == s)
+				return c[b];
+			return edgeStart + e * (s - 1) + (c[a] < c[b] ? k : s - k) - 1;
+		};
+		//Index of grid point (i, j), i steps along corner 0 to 1 and j steps along corner 0 to 2
+		auto gridVertex = [&](unsigned int face, unsigned int i, unsigned int j) {
+			unsigned int index;
+			if (corners == 3) {
+				if (j == 0)
+					index = edgeVertex(face, 0, 0, 1, i);
+				else if (i == 0)
+					index = edgeVertex(face, 1, 0, 2, j);
+				else if (i + j == s)
+					index = edgeVertex(face, 2, 1, 2, j);
+				else
+					index = faceStart + face * faceInterior + (i - 1) * (s - 1) - (i - 1) * i / 2 + j - 1;
 			}
-			//Bottom cap
-			int bottomIndex = mesh.vertices.size() - 1;
-			sideStart = bottomIndex - columns;
-			for (size_t i = 0; i < columns; i++)
+			else {
+				if (j == 0)
+					index = edgeVertex(face, 0, 0, 1, i);
+				else if (i == s)
+					index = edgeVertex(face, 1, 1, 3, j);
+				else if (j == s)
+					index = edgeVertex(face, 2, 2, 3, i);
+				else if (i == 0)
+					index = edgeVertex(face, 3, 0, 2, j);
+				else
+					index = faceStart + face * faceInterior + (i - 1) * (s - 1) + j - 1;
+			}
+			return baseVertex + index;
+		};
+
+		//Each (face, row) writes the row's interior vertices and triangles
+		ew::parallelFor((size_t)base.faceCount * s, threadCount, procGenRowGrain(s), [&](size_t begin, size_t end) {
+			for (size_t item = begin; item < end; item++)
 			{
-				mesh.indices.push_back(bottomIndex);
-				mesh.indices.push_back(sideStart + i);
-				mesh.indices.push_back(sideStart + i + 1);
+				const unsigned int face = (unsigned int)(item / s);
+				const unsigned int i = (unsigned int)(item % s);
+				const unsigned int* c = base.faces + face * corners;
+				const ew::Vec3 origin = base.corners[c[0]];
+				const ew::Vec3 du = (base.corners[c[1]] - origin) / (float)s;
+				const ew::Vec3 dv = (base.corners[c[2]] - origin) / (float)s;
+				//Interior vertices of this row
+				const unsigned int rowEnd = corners == 3 ? s - i : s;
+				for (unsigned int j = 1; i > 0 && j < rowEnd; j++)
+				{
+					sphereVertex(origin + du * (float)i + dv * (float)j, radius, equalAngle, &vertices[gridVertex(face, i, j) - baseVertex]);
+				}
+				//INDICES
+				unsigned int* index = indices + (size_t)face * faceTriangles * 3;
+				if (corners == 3) {
+					//Row i has s - i upward and s - i - 1 downward triangles
+					index += (size_t)(2 * s * i - i * i) * 3;
+					for (unsigned int j = 0; j < s - i; j++)
+					{
+						*index++ = gridVertex(face, i, j);
+						*index++ = gridVertex(face, i + 1, j);
+						*index++ = gridVertex(face, i, j + 1);
+						if (i + j + 1 < s) {
+							*index++ = gridVertex(face, i + 1, j);
+							*index++ = gridVertex(face, i + 1, j + 1);
+							*index++ = gridVertex(face, i, j + 1);
+						}
+					}
+				}
+				else {
+					index += (size_t)i * s * 6;
+					for (unsigned int j = 0; j < s; j++)
+					{
+						*index++ = gridVertex(face, i, j);
+						*index++ = gridVertex(face, i + 1, j);
+						*index++ = gridVertex(face, i, j + 1);
+						*index++ = gridVertex(face, i + 1, j);
+						*index++ = gridVertex(face, i + 1, j + 1);
+						*index++ = gridVertex(face, i, j + 1);
+					}
+				}
 			}
-		}
-		return mesh;
+		});
+	}
+
+	MeshCounts queryCounts(const IcosphereParams& params)
+	{
+		return subdividedSphereCounts(ICOSAHEDRON, icosphereSubdivisions(params));
+	}
+	Bounds queryBounds(const IcosphereParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(-params.radius), ew::Vec3(params.radius), params.radius);
+	}
+	bool emit(const IcosphereParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertices, indices, "Icosphere"))
+			return false;
+		subdivideSphere(ICOSAHEDRON, icosphereSubdivisions(params), params.radius, vertices.data, indices.data, baseVertex, threadCount);
+		return true;
+	}
+	MeshData createIcosphere(float radius, int subdivisions, unsigned int threadCount)
+	{
+		IcosphereParams params;
+		params.radius = radius;
+		params.subdivisions = subdivisions;
+		return createMesh(params, threadCount);
+	}
+
+	MeshCounts queryCounts(const CubeSphereParams& params)
+	{
+		return subdividedSphereCounts(CUBE, cubeSphereSubdivisions(params));
+	}
+	Bounds queryBounds(const CubeSphereParams& params)
+	{
+		return ew::makeBounds(ew::Vec3(-params.radius), ew::Vec3(params.radius), params.radius);
+	}
+	bool emit(const CubeSphereParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex, unsigned int threadCount)
+	{
+		if (!fits(queryCounts(params), vertices, indices, "Cube sphere"))
+			return false;
+		subdivideSphere(CUBE, cubeSphereSubdivisions(params), params.radius, vertices.data, indices.data, baseVertex, threadCount);
+		return true;
+	}
+	MeshData createCubeSphere(float radius, int subdivisions, unsigned int threadCount)
+	{
+		CubeSphereParams params;
+		params.radius = radius;
+		params.subdivisions = subdivisions;
+		return createMesh(params, threadCount);
 	}
-}
\ No newline at end of file
+}
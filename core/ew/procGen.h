@@ -4,11 +4,140 @@
 
 
 #pragma once
+#include <vector>
 #include "mesh.h"
 
 namespace ew {
+	//Generators size their output up front and fill it in row bands on threadCount threads (0 = one per hardware thread).
+	//Small meshes stay on the calling thread.
 	MeshData createCube(float size);
-	MeshData createPlane(float width, float height, int subdivisions);
-	MeshData createSphere(float radius, int subdivisions);
-	MeshData createCylinder(float radius, float height, int subdivisions);
+	MeshData createPlane(float width, float height, int subdivisions, unsigned int threadCount = 0);
+	MeshData createSphere(float radius, int subdivisions, unsigned int threadCount = 0);
+	MeshData createCylinder(float radius, float height, int subdivisions, unsigned int threadCount = 0);
+	//Spheres with about even triangle sizes, unlike createSphere's crowded poles (see IcosphereParams, CubeSphereParams)
+	MeshData createIcosphere(float radius, int subdivisions, unsigned int threadCount = 0);
+	MeshData createCubeSphere(float radius, int subdivisions, unsigned int threadCount = 0);
+
+	//Two phase API: queryCounts gives the exact output size, emit writes into caller owned memory
+	//(a mapped GPU buffer, an arena, a slice of a merged batch...) instead of a new MeshData.
+	//emit still allocates scratch that grows with subdivisions (angle tables, edge lists), and with threadCount != 1
+	//starts threads on every call. Pass threadCount = 1 to stay on the calling thread.
+	//The create functions above are wrappers that emit into a new MeshData.
+
+	struct MeshCounts {
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+	};
+
+	//Non owning destinations for emit
+	struct VertexSpan {
+		Vertex* data = nullptr;
+		size_t size = 0;
+		VertexSpan() {};
+		VertexSpan(Vertex* data, size_t size) :data(data), size(size) {};
+		VertexSpan(std::vector<Vertex>& vertices) :data(vertices.data()), size(vertices.size()) {};
+	};
+	struct IndexSpan {
+		unsigned int* data = nullptr;
+		size_t size = 0;
+		IndexSpan() {};
+		IndexSpan(unsigned int* data, size_t size) :data(data), size(size) {};
+		IndexSpan(std::vector<unsigned int>& indices) :data(indices.data()), size(indices.size()) {};
+	};
+
+	//Each params struct has a VERSION, part of its cache key (see ProceduralMeshCache).
+	//Bump it whenever that generator's output changes, so stale .ewmesh files are regenerated.
+	struct CubeParams {
+		static constexpr unsigned int VERSION = 1;
+		float size = 1.0f;
+	};
+	struct PlaneParams {
+		static constexpr unsigned int VERSION = 1;
+		float width = 1.0f;
+		float height = 1.0f;
+		int subdivisions = 1;
+	};
+	struct SphereParams {
+		static constexpr unsigned int VERSION = 1;
+		float radius = 0.5f;
+		int subdivisions = 16;
+	};
+	struct CylinderParams {
+		static constexpr unsigned int VERSION = 1;
+		float radius = 0.5f;
+		float height = 1.0f;
+		int subdivisions = 16;
+	};
+
+	//Icosahedron with each edge split into subdivisions segments, projected onto the sphere.
+	//20 * subdivisions^2 triangles and 10 * subdivisions^2 + 2 vertices. Vertices on shared edges are emitted once,
+	//so UVs (spherical, like createSphere) wrap back to 0 across the seam at +X.
+	struct IcosphereParams {
+		static constexpr unsigned int VERSION = 1;
+		float radius = 0.5f;
+		int subdivisions = 4;
+		//If > 0, overrides subdivisions with the count giving the closest number of triangles
+		int targetTriangles = 0;
+	};
+	//Cube with each face split into subdivisions^2 quads, warped to equal angles and projected onto the sphere.
+	//12 * subdivisions^2 triangles and 6 * subdivisions^2 + 2 vertices. Same seam as IcosphereParams.
+	struct CubeSphereParams {
+		static constexpr unsigned int VERSION = 1;
+		float radius = 0.5f;
+		int subdivisions = 8;
+		//If > 0, overrides subdivisions with the count giving the closest number of triangles
+		int targetTriangles = 0;
+	};
+
+	MeshCounts queryCounts(const CubeParams& params);
+	MeshCounts queryCounts(const PlaneParams& params);
+	MeshCounts queryCounts(const SphereParams& params);
+	MeshCounts queryCounts(const CylinderParams& params);
+	MeshCounts queryCounts(const IcosphereParams& params);
+	MeshCounts queryCounts(const CubeSphereParams& params);
+
+	//Local space bounds of the emitted vertices
+	Bounds queryBounds(const CubeParams& params);
+	Bounds queryBounds(const PlaneParams& params);
+	Bounds queryBounds(const SphereParams& params);
+	Bounds queryBounds(const CylinderParams& params);
+	Bounds queryBounds(const IcosphereParams& params);
+	Bounds queryBounds(const CubeSphereParams& params);
+
+	/// <summary>
+	/// Writes the mesh into the first queryCounts(params) elements of vertices and indices.
+	/// </summary>
+	/// <param name="baseVertex">Added to every index, for meshes emitted after others in a shared vertex buffer</param>
+	/// <returns>False, writing nothing, if either span is too small</returns>
+	bool emit(const CubeParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0);
+	bool emit(const PlaneParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+	bool emit(const SphereParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+	bool emit(const CylinderParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+	bool emit(const IcosphereParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+	bool emit(const CubeSphereParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 0);
+
+	//Emits the mesh for params into a new MeshData sized to the exact counts. Extra args are passed to emit (e.g. threadCount).
+	template<typename Params, typename... Args>
+	MeshData createMesh(const Params& params, Args... args) {
+		MeshData mesh;
+		const MeshCounts counts = queryCounts(params);
+		mesh.vertices.resize(counts.vertexCount);
+		mesh.indices.resize(counts.indexCount);
+		emit(params, VertexSpan(mesh.vertices), IndexSpan(mesh.indices), 0, args...);
+		mesh.bounds = queryBounds(params);
+		mesh.hasBounds = true;
+		return mesh;
+	}
+
+	//sinf and cosf of i * step for i in [0, count], so generators evaluate each angle once instead of per vertex
+	struct AngleTable {
+		std::vector<float> sin;
+		std::vector<float> cos;
+		AngleTable(float step, int count);
+	};
+
+	//Rows per parallelFor grain, so each thread gets at least a few thousand vertices
+	inline size_t procGenRowGrain(size_t columns) {
+		return 4096 / (columns > 0 ? columns : 1) + 1;
+	}
 }
@@ -0,0 +1,310 @@
+#include "sdf.h"
+#include "ewMath/simdMath.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace ew {
+	namespace {
+		inline float signOf(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+		//Distance to one node's shape, and its gradient if gradient isn't null
+		float shapeDistance(const SdfNode& node, const ew::Vec3& p, ew::Vec3* gradient) {
+			const ew::Vec3 q = p - node.center;
+			switch (node.shape) {
+			case SdfShape::BOX: {
+				const ew::Vec3 a = ew::Vec3(fabsf(q.x) - node.size.x, fabsf(q.y) - node.size.y, fabsf(q.z) - node.size.z);
+				const ew::Vec3 outside = ew::Vec3(std::max(a.x, 0.0f), std::max(a.y, 0.0f), std::max(a.z, 0.0f));
+				const float outsideLength = ew::Magnitude(outside);
+				const float inside = std::min(std::max(a.x, std::max(a.y, a.z)), 0.0f);
+				if (gradient) {
+					if (outsideLength > 0.0f) {
+						*gradient = ew::Vec3(outside.x * signOf(q.x), outside.y * signOf(q.y), outside.z * signOf(q.z)) / outsideLength;
+					}
+					else {
+						//Inside, the nearest face is along the axis closest to its face
+						*gradient = a.x >= a.y && a.x >= a.z ? ew::Vec3(signOf(q.x), 0.0f, 0.0f)
+							: a.y >= a.z ? ew::Vec3(0.0f, signOf(q.y), 0.0f) : ew::Vec3(0.0f, 0.0f, signOf(q.z));
+					}
+				}
+				return outsideLength + inside - node.radius;
+			}
+			case SdfShape::TORUS: {
+				const float ringDistance = sqrtf(q.x * q.x + q.z * q.z);
+				const float tx = ringDistance - node.size.x;
+				const float length = sqrtf(tx * tx + q.y * q.y);
+				if (gradient) {
+					const float cosine = ringDistance > 0.0f ? q.x / ringDistance : 1.0f;
+					const float sine = ringDistance > 0.0f ? q.z / ringDistance : 0.0f;
+					*gradient = length > 0.0f ? ew::Vec3(tx * cosine, q.y, tx * sine) / length : ew::Vec3(0.0f, 1.0f, 0.0f);
+				}
+				return length - node.radius;
+			}
+			case SdfShape::PLANE: {
+				const ew::Vec3 normal = ew::Normalize(node.size);
+				if (gradient)
+					*gradient = normal;
+				return ew::Dot(q, normal);
+			}
+			default: {
+				const float length = ew::Magnitude(q);
+				if (gradient)
+					*gradient = length > 0.0f ? q / length : ew::Vec3(0.0f, 1.0f, 0.0f);
+				return length - node.radius;
+			}
+			}
+		}
+
+		//Combines the field so far (a) with a node (b). Gradients are blended with the same weights:
+		//the terms from the blend weight's own derivative cancel for the polynomial smooth min.
+		float combine(SdfOp op, float blend, float a, float b, const ew::Vec3* ga, const ew::Vec3* gb, ew::Vec3* gradient) {
+			if (blend <= 0.0f) {
+				if (op == SdfOp::SMOOTH_UNION)
+					op = SdfOp::UNION;
+				else if (op == SdfOp::SMOOTH_SUBTRACT)
+					op = SdfOp::SUBTRACT;
+				else if (op == SdfOp::SMOOTH_INTERSECT)
+					op = SdfOp::INTERSECT;
+			}
+			switch (op) {
+			case SdfOp::SUBTRACT:
+				if (gradient)
+					*gradient = a >= -b ? *ga : -*gb;
+				return std::max(a, -b);
+			case SdfOp::INTERSECT:
+				if (gradient)
+					*gradient = a >= b ? *ga : *gb;
+				return std::max(a, b);
+			case SdfOp::SMOOTH_UNION: {
+				const float h = std::min(std::max(0.5f + 0.5f * (b - a) / blend, 0.0f), 1.0f);
+				if (gradient)
+					*gradient = *gb + (*ga - *gb) * h;
+				return b + (a - b) * h - blend * h * (1.0f - h);
+			}
+			case SdfOp::SMOOTH_SUBTRACT: {
+				const float h = std::min(std::max(0.5f - 0.5f * (a + b) / blend, 0.0f), 1.0f);
+				if (gradient)
+					*gradient = *ga + (-*gb - *ga) * h;
+				return a + (-b - a) * h + blend * h * (1.0f - h);
+			}
+			case SdfOp::SMOOTH_INTERSECT: {
+				const float h = std::min(std::max(0.5f - 0.5f * (b - a) / blend, 0.0f), 1.0f);
+				if (gradient)
+					*gradient = *gb + (*ga - *gb) * h;
+				return b + (a - b) * h + blend * h * (1.0f - h);
+			}
+			default:
+				if (gradient)
+					*gradient = a <= b ? *ga : *gb;
+				return std::min(a, b);
+			}
+		}
+
+#if EW_SIMD_X86
+		EW_TARGET_AVX2 __m256 abs8(__m256 v) {
+			return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+		}
+
+		EW_TARGET_AVX2 __m256 clamp01(__m256 v) {
+			return _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+		}
+
+		//Mirrors shapeDistance without the gradient
+		EW_TARGET_AVX2 __m256 shapeDistance8(const SdfNode& node, __m256 qx, __m256 qy, __m256 qz) {
+			const __m256 zero = _mm256_setzero_ps();
+			switch (node.shape) {
+			case SdfShape::BOX: {
+				const __m256 ax = _mm256_sub_ps(abs8(qx), _mm256_set1_ps(node.size.x));
+				const __m256 ay = _mm256_sub_ps(abs8(qy), _mm256_set1_ps(node.size.y));
+				const __m256 az = _mm256_sub_ps(abs8(qz), _mm256_set1_ps(node.size.z));
+				const __m256 ox = _mm256_max_ps(ax, zero);
+				const __m256 oy = _mm256_max_ps(ay, zero);
+				const __m256 oz = _mm256_max_ps(az, zero);
+				const __m256 outsideLength = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ox, ox), _mm256_mul_ps(oy, oy)), _mm256_mul_ps(oz, oz)));
+				const __m256 inside = _mm256_min_ps(_mm256_max_ps(ax, _mm256_max_ps(ay, az)), zero);
+				return _mm256_sub_ps(_mm256_add_ps(outsideLength, inside), _mm256_set1_ps(node.radius));
+			}
+			case SdfShape::TORUS: {
+				const __m256 ringDistance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(qx, qx), _mm256_mul_ps(qz, qz)));
+				const __m256 tx = _mm256_sub_ps(ringDistance, _mm256_set1_ps(node.size.x));
+				const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(tx, tx), _mm256_mul_ps(qy, qy)));
+				return _mm256_sub_ps(length, _mm256_set1_ps(node.radius));
+			}
+			case SdfShape::PLANE: {
+				const ew::Vec3 normal = ew::Normalize(node.size);
+				return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(qx, _mm256_set1_ps(normal.x)), _mm256_mul_ps(qy, _mm256_set1_ps(normal.y))), _mm256_mul_ps(qz, _mm256_set1_ps(normal.z)));
+			}
+			default: {
+				const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(qx, qx), _mm256_mul_ps(qy, qy)), _mm256_mul_ps(qz, qz)));
+				return _mm256_sub_ps(length, _mm256_set1_ps(node.radius));
+			}
+			}
+		}
+
+		//Mirrors combine without the gradient
+		EW_TARGET_AVX2 __m256 combine8(SdfOp op, float blend, __m256 a, __m256 b) {
+			const __m256 negB = _mm256_xor_ps(b, _mm256_set1_ps(-0.0f));
+			if (blend <= 0.0f) {
+				if (op == SdfOp::SUBTRACT || op == SdfOp::SMOOTH_SUBTRACT)
+					return _mm256_max_ps(a, negB);
+				if (op == SdfOp::INTERSECT || op == SdfOp::SMOOTH_INTERSECT)
+					return _mm256_max_ps(a, b);
+				return _mm256_min_ps(a, b);
+			}
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 k = _mm256_set1_ps(blend);
+			const __m256 invK = _mm256_set1_ps(0.5f / blend);
+			switch (op) {
+			case SdfOp::SUBTRACT:
+				return _mm256_max_ps(a, negB);
+			case SdfOp::INTERSECT:
+				return _mm256_max_ps(a, b);
+			case SdfOp::SMOOTH_UNION:
+			case SdfOp::SMOOTH_INTERSECT: {
+				//Union: h = 0.5 + 0.5 (b - a) / k, minus the bump. Intersect: h = 0.5 - 0.5 (b - a) / k, plus the bump.
+				const __m256 t = _mm256_mul_ps(_mm256_sub_ps(b, a), invK);
+				const bool isUnion = op == SdfOp::SMOOTH_UNION;
+				const __m256 h = clamp01(isUnion ? _mm256_add_ps(half, t) : _mm256_sub_ps(half, t));
+				const __m256 mixed = _mm256_add_ps(b, _mm256_mul_ps(_mm256_sub_ps(a, b), h));
+				const __m256 bump = _mm256_mul_ps(_mm256_mul_ps(k, h), _mm256_sub_ps(_mm256_set1_ps(1.0f), h));
+				return isUnion ? _mm256_sub_ps(mixed, bump) : _mm256_add_ps(mixed, bump);
+			}
+			case SdfOp::SMOOTH_SUBTRACT: {
+				const __m256 h = clamp01(_mm256_sub_ps(half, _mm256_mul_ps(_mm256_add_ps(a, b), invK)));
+				const __m256 mixed = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(negB, a), h));
+				const __m256 bump = _mm256_mul_ps(_mm256_mul_ps(k, h), _mm256_sub_ps(_mm256_set1_ps(1.0f), h));
+				return _mm256_add_ps(mixed, bump);
+			}
+			default:
+				return _mm256_min_ps(a, b);
+			}
+		}
+
+		//Full batches of 8 only; evaluateSdfRow pads the tail
+		EW_TARGET_AVX2 void evaluateSdfRowAVX2(const Sdf& sdf, float x0, float dx, int first, size_t count, float y, float z, float* out) {
+			const __m256 laneOffsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+			for (size_t i = 0; i < count; i += 8)
+			{
+				const __m256 column = _mm256_add_ps(_mm256_set1_ps((float)(first + (int)i)), laneOffsets);
+				const __m256 x = _mm256_add_ps(_mm256_set1_ps(x0), _mm256_mul_ps(column, _mm256_set1_ps(dx)));
+				__m256 d = _mm256_set1_ps(FLT_MAX);
+				for (size_t n = 0; n < sdf.nodes.size(); n++)
+				{
+					const SdfNode& node = sdf.nodes[n];
+					const __m256 qx = _mm256_sub_ps(x, _mm256_set1_ps(node.center.x));
+					const __m256 qy = _mm256_set1_ps(y - node.center.y);
+					const __m256 qz = _mm256_set1_ps(z - node.center.z);
+					const __m256 b = shapeDistance8(node, qx, qy, qz);
+					d = n == 0 ? b : combine8(node.op, node.blend, d, b);
+				}
+				_mm256_storeu_ps(out + i, d);
+			}
+		}
+#endif
+	}
+
+	Sdf& Sdf::sphere(const ew::Vec3& center, float radius, SdfOp op, float blend)
+	{
+		SdfNode node;
+		node.shape = SdfShape::SPHERE;
+		node.op = op;
+		node.center = center;
+		node.radius = radius;
+		node.blend = blend;
+		nodes.push_back(node);
+		return *this;
+	}
+
+	Sdf& Sdf::box(const ew::Vec3& center, const ew::Vec3& halfExtents, float rounding, SdfOp op, float blend)
+	{
+		SdfNode node;
+		node.shape = SdfShape::BOX;
+		node.op = op;
+		node.center = center;
+		node.size = halfExtents;
+		node.radius = rounding;
+		node.blend = blend;
+		nodes.push_back(node);
+		return *this;
+	}
+
+	Sdf& Sdf::torus(const ew::Vec3& center, float ringRadius, float tubeRadius, SdfOp op, float blend)
+	{
+		SdfNode node;
+		node.shape = SdfShape::TORUS;
+		node.op = op;
+		node.center = center;
+		node.size = ew::Vec3(ringRadius, 0.0f, 0.0f);
+		node.radius = tubeRadius;
+		node.blend = blend;
+		nodes.push_back(node);
+		return *this;
+	}
+
+	Sdf& Sdf::plane(const ew::Vec3& point, const ew::Vec3& normal, SdfOp op, float blend)
+	{
+		SdfNode node;
+		node.shape = SdfShape::PLANE;
+		node.op = op;
+		node.center = point;
+		node.size = normal;
+		node.blend = blend;
+		nodes.push_back(node);
+		return *this;
+	}
+
+	float evaluateSdf(const Sdf& sdf, const ew::Vec3& p)
+	{
+		float d = FLT_MAX;
+		for (size_t n = 0; n < sdf.nodes.size(); n++)
+		{
+			const SdfNode& node = sdf.nodes[n];
+			const float b = shapeDistance(node, p, nullptr);
+			d = n == 0 ? b : combine(node.op, node.blend, d, b, nullptr, nullptr, nullptr);
+		}
+		return d;
+	}
+
+	float evaluateSdf(const Sdf& sdf, const ew::Vec3& p, ew::Vec3* gradient)
+	{
+		float d = FLT_MAX;
+		ew::Vec3 g = ew::Vec3(0.0f, 1.0f, 0.0f);
+		for (size_t n = 0; n < sdf.nodes.size(); n++)
+		{
+			const SdfNode& node = sdf.nodes[n];
+			ew::Vec3 nodeGradient;
+			const float b = shapeDistance(node, p, &nodeGradient);
+			if (n == 0) {
+				d = b;
+				g = nodeGradient;
+			}
+			else {
+				const ew::Vec3 previous = g;
+				d = combine(node.op, node.blend, d, b, &previous, &nodeGradient, &g);
+			}
+		}
+		*gradient = g;
+		return d;
+	}
+
+	void evaluateSdfRow(const Sdf& sdf, float x0, float dx, int first, size_t count, float y, float z, float* out)
+	{
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			const size_t full = count & ~(size_t)7;
+			evaluateSdfRowAVX2(sdf, x0, dx, first, full, y, z, out);
+			if (full < count) {
+				float tail[8];
+				evaluateSdfRowAVX2(sdf, x0, dx, first + (int)full, 8, y, z, tail);
+				for (size_t i = full; i < count; i++)
+					out[i] = tail[i - full];
+			}
+			return;
+		}
+#endif
+		for (size_t i = 0; i < count; i++)
+		{
+			out[i] = evaluateSdf(sdf, ew::Vec3(x0 + (float)(first + (int)i) * dx, y, z));
+		}
+	}
+}
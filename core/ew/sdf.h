@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "ewMath/ewMath.h"
+
+namespace ew {
+	//Signed distance fields built from primitives combined in order. Negative inside.
+
+	enum class SdfShape {
+		//radius
+		SPHERE = 0,
+		//size = half extents, radius rounds the edges (and grows the box by radius)
+		BOX = 1,
+		//Ring in the XZ plane: size.x = ring radius, radius = tube radius
+		TORUS = 2,
+		//Half space below the plane through center with normal size (normalized)
+		PLANE = 3
+	};
+
+	//How a node combines with the field of the nodes before it. Ignored for the first node.
+	enum class SdfOp {
+		UNION = 0,
+		//Removes the node's shape
+		SUBTRACT = 1,
+		INTERSECT = 2,
+		//Polynomial smooth min over blend distance. Smooth unions of spheres make metaballs.
+		SMOOTH_UNION = 3,
+		SMOOTH_SUBTRACT = 4,
+		SMOOTH_INTERSECT = 5
+	};
+
+	struct SdfNode {
+		SdfShape shape = SdfShape::SPHERE;
+		SdfOp op = SdfOp::UNION;
+		ew::Vec3 center = ew::Vec3(0.0f);
+		ew::Vec3 size = ew::Vec3(0.5f);
+		float radius = 0.5f;
+		//Blend distance of the smooth ops. 0 makes them sharp.
+		float blend = 0.0f;
+	};
+
+	struct Sdf {
+		std::vector<SdfNode> nodes;
+
+		Sdf& sphere(const ew::Vec3& center, float radius, SdfOp op = SdfOp::UNION, float blend = 0.0f);
+		Sdf& box(const ew::Vec3& center, const ew::Vec3& halfExtents, float rounding = 0.0f, SdfOp op = SdfOp::UNION, float blend = 0.0f);
+		Sdf& torus(const ew::Vec3& center, float ringRadius, float tubeRadius, SdfOp op = SdfOp::UNION, float blend = 0.0f);
+		Sdf& plane(const ew::Vec3& point, const ew::Vec3& normal, SdfOp op = SdfOp::UNION, float blend = 0.0f);
+	};
+
+	//Distance at p. An empty field is +infinity everywhere.
+	float evaluateSdf(const Sdf& sdf, const ew::Vec3& p);
+	/// <summary>
+	/// Distance at p and its analytic gradient (the outward surface normal on the surface).
+	/// Smooth ops blend the gradients with the same weights as the distances, which is exact for the polynomial smooth min.
+	/// </summary>
+	float evaluateSdf(const Sdf& sdf, const ew::Vec3& p, ew::Vec3* gradient);
+
+	/// <summary>
+	/// out[i] = evaluateSdf(sdf, (x0 + (first + i) * dx, y, z)) for i in [0, count). Uses AVX2 for 8 points at a time when available.
+	/// Like fbmRow, every point goes through the same code path at a given SIMD level, so overlapping rows computed with different
+	/// first/count agree exactly. The AVX2 and scalar paths (and evaluateSdf) only agree to within float rounding, so points on the
+	/// surface can change sign between SIMD levels.
+	/// </summary>
+	void evaluateSdfRow(const Sdf& sdf, float x0, float dx, int first, size_t count, float y, float z, float* out);
+}
@@ -0,0 +1,265 @@
+#include "sdfMesh.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace ew {
+	namespace {
+		struct SdfBlock {
+			//Global cell of each vertex, ascending since cells are visited in z, y, x order
+			std::vector<uint64_t> cells;
+			std::vector<Vertex> vertices;
+			//4 vertices per quad in winding order: an index into vertices, or CROSS_BLOCK | global cell for vertices owned by a lower neighbor
+			std::vector<uint64_t> quads;
+			size_t firstVertex = 0;
+			size_t firstIndex = 0;
+			//Indices written from firstIndex, fewer than 6 per quad if any were skipped
+			size_t indexCount = 0;
+		};
+
+		struct SdfGrid {
+			int resolution;
+			int blockSize;
+			int blocksPerAxis;
+			float min[3];
+			float cellSize[3];
+
+			uint64_t cellKey(int x, int y, int z)const { return (uint64_t)x + (uint64_t)resolution * ((uint64_t)y + (uint64_t)resolution * (uint64_t)z); }
+			//Same expression in every block, so shared samples agree exactly
+			float coordinate(int axis, int index)const { return min[axis] + (float)index * cellSize[axis]; }
+		};
+
+		constexpr uint64_t CROSS_BLOCK = 1ull << 63;
+
+		//The 12 cell edges as pairs of corners. Corner bits are x = 1, y = 2, z = 4.
+		constexpr int CELL_EDGES[12][2] = {
+			{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+			{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+			{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+		};
+
+		void meshBlock(const Sdf& sdf, const SdfGrid& grid, const SdfMeshParams& params, size_t blockIndex, std::vector<float>& samples, std::vector<int>& cellVertices, SdfBlock& block) {
+			int origin[3];
+			int cells[3];
+			origin[0] = (int)(blockIndex % grid.blocksPerAxis) * grid.blockSize;
+			origin[1] = (int)(blockIndex / grid.blocksPerAxis % grid.blocksPerAxis) * grid.blockSize;
+			origin[2] = (int)(blockIndex / ((size_t)grid.blocksPerAxis * grid.blocksPerAxis)) * grid.blockSize;
+			for (int a = 0; a < 3; a++)
+			{
+				cells[a] = std::min(grid.blockSize, grid.resolution - origin[a]);
+			}
+
+			//A distance field changes no faster than distance, so if the center is further from the surface
+			//than any corner is from the center, no sample in the block can change sign
+			const ew::Vec3 cellSize = ew::Vec3(grid.cellSize[0], grid.cellSize[1], grid.cellSize[2]);
+			const ew::Vec3 extent = ew::Vec3(cellSize.x * cells[0], cellSize.y * cells[1], cellSize.z * cells[2]);
+			const ew::Vec3 center = ew::Vec3(grid.coordinate(0, origin[0]), grid.coordinate(1, origin[1]), grid.coordinate(2, origin[2])) + extent * 0.5f;
+			const float margin = ew::Magnitude(cellSize);
+			if (fabsf(evaluateSdf(sdf, center)) > ew::Magnitude(extent) * 0.5f + margin)
+				return;
+
+			const int px = cells[0] + 1;
+			const int py = cells[1] + 1;
+			const int pz = cells[2] + 1;
+			samples.resize((size_t)px * py * pz);
+			for (int k = 0; k < pz; k++)
+			{
+				for (int j = 0; j < py; j++)
+				{
+					evaluateSdfRow(sdf, grid.min[0], grid.cellSize[0], origin[0], px, grid.coordinate(1, origin[1] + j), grid.coordinate(2, origin[2] + k),
+						samples.data() + ((size_t)k * py + j) * px);
+				}
+			}
+			auto sample = [&](int i, int j, int k) { return samples[((size_t)k * py + j) * px + i]; };
+			//Vertex of each of the block's cells, for quads whose cells are all in this block
+			cellVertices.assign((size_t)cells[0] * cells[1] * cells[2], -1);
+			auto cellVertex = [&](const int* local) { return cellVertices[((size_t)local[2] * cells[1] + local[1]) * cells[0] + local[0]]; };
+
+			const ew::Vec3 regionSize = params.max - params.min;
+			for (int k = 0; k < cells[2]; k++)
+			{
+				for (int j = 0; j < cells[1]; j++)
+				{
+					for (int i = 0; i < cells[0]; i++)
+					{
+						//VERTEX at the mean of the edge crossings of cells the surface passes through
+						float corner[8];
+						int inside = 0;
+						for (int c = 0; c < 8; c++)
+						{
+							corner[c] = sample(i + (c & 1), j + ((c >> 1) & 1), k + ((c >> 2) & 1));
+							inside |= (corner[c] < 0.0f ? 1 : 0) << c;
+						}
+						if (inside == 0 || inside == 255)
+							continue;
+						ew::Vec3 sum = ew::Vec3(0.0f);
+						int crossings = 0;
+						for (int e = 0; e < 12; e++)
+						{
+							const int c0 = CELL_EDGES[e][0];
+							const int c1 = CELL_EDGES[e][1];
+							if (((inside >> c0) & 1) == ((inside >> c1) & 1))
+								continue;
+							const float t = corner[c0] / (corner[c0] - corner[c1]);
+							const ew::Vec3 p0 = ew::Vec3((float)(c0 & 1), (float)((c0 >> 1) & 1), (float)((c0 >> 2) & 1));
+							const ew::Vec3 p1 = ew::Vec3((float)(c1 & 1), (float)((c1 >> 1) & 1), (float)((c1 >> 2) & 1));
+							sum += p0 + (p1 - p0) * t;
+							crossings++;
+						}
+						const ew::Vec3 local = sum / (float)crossings;
+						const int gx = origin[0] + i;
+						const int gy = origin[1] + j;
+						const int gz = origin[2] + k;
+						Vertex v;
+						v.pos = ew::Vec3(grid.coordinate(0, gx) + local.x * cellSize.x,
+							grid.coordinate(1, gy) + local.y * cellSize.y,
+							grid.coordinate(2, gz) + local.z * cellSize.z);
+						ew::Vec3 gradient;
+						evaluateSdf(sdf, v.pos, &gradient);
+						const float gradientLength = ew::Magnitude(gradient);
+						v.normal = gradientLength > 0.0f ? gradient / gradientLength : ew::Vec3(0.0f, 1.0f, 0.0f);
+						v.uv = ew::Vec2((v.pos.x - params.min.x) / regionSize.x, (v.pos.z - params.min.z) / regionSize.z);
+						cellVertices[((size_t)k * cells[1] + j) * cells[0] + i] = (int)block.vertices.size();
+						block.cells.push_back(grid.cellKey(gx, gy, gz));
+						block.vertices.push_back(v);
+
+						//QUADS joining the 4 cells around each crossed grid edge starting at this cell's origin.
+						//(a, b, c) is cyclic, so b x c = a and going +b then +c turns counterclockwise seen from +a.
+						//The other 3 cells come earlier in z, y, x order, so any in this block already have their vertex.
+						const int g[3] = { origin[0] + i, origin[1] + j, origin[2] + k };
+						const int l[3] = { i, j, k };
+						for (int a = 0; a < 3; a++)
+						{
+							const int b = (a + 1) % 3;
+							const int c = (a + 2) % 3;
+							//Edges on the region's low sides have cells on one side only
+							if (g[b] == 0 || g[c] == 0)
+								continue;
+							const bool startInside = corner[0] < 0.0f;
+							const bool endInside = corner[1 << a] < 0.0f;
+							if (startInside == endInside)
+								continue;
+							auto quadVertex = [&](int db, int dc) -> uint64_t {
+								int local[3] = { l[0], l[1], l[2] };
+								local[b] -= db;
+								local[c] -= dc;
+								if (local[b] >= 0 && local[c] >= 0 && cellVertex(local) >= 0)
+									return (uint64_t)cellVertex(local);
+								return CROSS_BLOCK | grid.cellKey(origin[0] + local[0], origin[1] + local[1], origin[2] + local[2]);
+							};
+							const uint64_t v00 = quadVertex(1, 1);
+							const uint64_t v10 = quadVertex(0, 1);
+							const uint64_t v11 = quadVertex(0, 0);
+							const uint64_t v01 = quadVertex(1, 0);
+							//Faces point from inside to outside
+							const uint64_t quad[4] = { v00, startInside ? v10 : v01, v11, startInside ? v01 : v10 };
+							block.quads.insert(block.quads.end(), quad, quad + 4);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	MeshData createSdfMesh(const Sdf& sdf, const SdfMeshParams& params, unsigned int threadCount)
+	{
+		SdfGrid grid;
+		grid.resolution = params.resolution < 1 ? 1 : params.resolution;
+		grid.blockSize = params.blockSize < 1 ? 1 : params.blockSize;
+		grid.blocksPerAxis = (grid.resolution + grid.blockSize - 1) / grid.blockSize;
+		const ew::Vec3 cellSize = (params.max - params.min) / (float)grid.resolution;
+		grid.min[0] = params.min.x;
+		grid.min[1] = params.min.y;
+		grid.min[2] = params.min.z;
+		grid.cellSize[0] = cellSize.x;
+		grid.cellSize[1] = cellSize.y;
+		grid.cellSize[2] = cellSize.z;
+		const size_t blockCount = (size_t)grid.blocksPerAxis * grid.blocksPerAxis * grid.blocksPerAxis;
+		std::vector<SdfBlock> blocks(blockCount);
+		if (threadCount == 0)
+			threadCount = hardwareThreadCount();
+
+		//Most blocks are skipped and the rest cost about the same, so threads pull blocks one at a time
+		std::atomic<size_t> nextBlock(0);
+		ew::parallelFor(threadCount, threadCount, 1, [&](size_t, size_t) {
+			std::vector<float> samples;
+			std::vector<int> cellVertices;
+			for (size_t b = nextBlock++; b < blockCount; b = nextBlock++)
+			{
+				meshBlock(sdf, grid, params, b, samples, cellVertices, blocks[b]);
+			}
+		});
+
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (SdfBlock& block : blocks) {
+			block.firstVertex = vertexCount;
+			block.firstIndex = indexCount;
+			vertexCount += block.vertices.size();
+			indexCount += block.quads.size() / 4 * 6;
+		}
+		MeshData mesh;
+		mesh.vertices.resize(vertexCount);
+		mesh.indices.resize(indexCount);
+
+		//Vertices owned by another block are found by cell, at the cell's sorted position in that block
+		auto vertexIndex = [&](const SdfBlock& block, uint64_t vertex, unsigned int* index) {
+			if (!(vertex & CROSS_BLOCK)) {
+				*index = (unsigned int)(block.firstVertex + vertex);
+				return true;
+			}
+			const uint64_t cell = vertex & ~CROSS_BLOCK;
+			const int x = (int)(cell % grid.resolution);
+			const int y = (int)(cell / grid.resolution % grid.resolution);
+			const int z = (int)(cell / ((uint64_t)grid.resolution * grid.resolution));
+			const SdfBlock& owner = blocks[(size_t)(x / grid.blockSize) + grid.blocksPerAxis * ((size_t)(y / grid.blockSize) + grid.blocksPerAxis * (size_t)(z / grid.blockSize))];
+			auto it = std::lower_bound(owner.cells.begin(), owner.cells.end(), cell);
+			if (it == owner.cells.end() || *it != cell)
+				return false;
+			*index = (unsigned int)(owner.firstVertex + (it - owner.cells.begin()));
+			return true;
+		};
+		ew::parallelFor(blockCount, threadCount, 1, [&](size_t begin, size_t end) {
+			for (size_t b = begin; b < end; b++)
+			{
+				SdfBlock& block = blocks[b];
+				std::copy(block.vertices.begin(), block.vertices.end(), mesh.vertices.begin() + block.firstVertex);
+				unsigned int* out = mesh.indices.data() + block.firstIndex;
+				for (size_t q = 0; q < block.quads.size(); q += 4)
+				{
+					unsigned int v[4];
+					bool found = true;
+					for (int c = 0; c < 4; c++)
+						found = found && vertexIndex(block, block.quads[q + c], &v[c]);
+					//Only possible if the field changes faster than distance and fooled a neighbor's empty block test.
+					//The quad is left as a hole.
+					if (!found)
+						continue;
+					out[0] = v[0];
+					out[1] = v[1];
+					out[2] = v[2];
+					out[3] = v[0];
+					out[4] = v[2];
+					out[5] = v[3];
+					out += 6;
+				}
+				block.indexCount = out - (mesh.indices.data() + block.firstIndex);
+			}
+		});
+		//Close the gaps skipped quads left at the end of their blocks' ranges
+		size_t written = 0;
+		for (const SdfBlock& block : blocks) {
+			if (written != block.firstIndex)
+				std::copy(mesh.indices.begin() + block.firstIndex, mesh.indices.begin() + block.firstIndex + block.indexCount, mesh.indices.begin() + written);
+			written += block.indexCount;
+		}
+		mesh.indices.resize(written);
+
+		mesh.bounds = computeBounds(mesh.vertices.data(), mesh.vertices.size());
+		mesh.hasBounds = true;
+		return mesh;
+	}
+}
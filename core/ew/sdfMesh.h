@@ -0,0 +1,28 @@
+#pragma once
+#include "mesh.h"
+#include "sdf.h"
+
+namespace ew {
+	struct SdfMeshParams {
+		//Region sampled. Surfaces leaving it are left open at its sides.
+		ew::Vec3 min = ew::Vec3(-1.0f);
+		ew::Vec3 max = ew::Vec3(1.0f);
+		//Cells along each axis
+		int resolution = 64;
+		//Cells per side of the blocks that are sampled and meshed as independent tasks
+		int blockSize = 16;
+	};
+
+	/// <summary>
+	/// Meshes the sdf's zero surface with surface nets (dual contouring with each vertex at the mean of its cell's edge crossings).
+	/// The grid is split into blocks processed on threadCount threads (0 = one per hardware thread). Each block samples its
+	/// corners in SIMD rows (evaluateSdfRow) and skips sampling entirely when the distance at its center rules out a surface.
+	/// Vertices belong to the block owning their cell and quads reaching into a neighbor refer to its vertices by global cell, so
+	/// blocks share border vertices: the output is indexed, welded and crack free. Normals are the sdf's analytic gradient, UVs are XZ across the region.
+	/// The mesh can differ slightly between SIMD levels (see evaluateSdfRow).
+	/// Surface nets places one vertex per cell, so cells where the surface passes through twice (thin walls and creases, e.g. smooth
+	/// subtractions) can give a few non-manifold edges and flipped triangles. Don't rely on the output being manifold.
+	/// </summary>
+	/// <returns>Counts aren't known up front, so unlike the other generators there is no queryCounts/emit form</returns>
+	MeshData createSdfMesh(const Sdf& sdf, const SdfMeshParams& params, unsigned int threadCount = 0);
+}
@@ -123,5 +123,14 @@ namespace ew {
 	{
 		glUniformMatrix4fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &m[0][0]);
 	}
+	void Shader::setMat3(const std::string& name, const ew::Mat4& m) const
+	{
+		const float m3[9] = {
+			m[0][0], m[0][1], m[0][2],
+			m[1][0], m[1][1], m[1][2],
+			m[2][0], m[2][1], m[2][2]
+		};
+		glUniformMatrix3fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, m3);
+	}
 }
 
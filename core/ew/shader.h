@@ -18,6 +18,8 @@ namespace ew {
 		void setVec4(const std::string& name, float x, float y, float z, float w) const;
 		void setVec4(const std::string& name, const ew::Vec4& v) const;
 		void setMat4(const std::string& name, const ew::Mat4& m) const;
+		//Uploads the upper 3x3 of m to a mat3 uniform
+		void setMat3(const std::string& name, const ew::Mat4& m) const;
 	private:
 		unsigned int m_id; //Shader program handle
 	};
@@ -0,0 +1,210 @@
+#include "simplify.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace ew {
+	namespace {
+		//Symmetric 4x4 matrix of summed squared plane distances, plus the total weight
+		struct Quadric {
+			double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+			double weight = 0;
+
+			void addPlane(double a, double b, double c, double d, double w) {
+				a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+				b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+				c2 += w * c * c; cd += w * c * d;
+				d2 += w * d * d;
+				weight += w;
+			}
+			void add(const Quadric& q) {
+				a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+				b2 += q.b2; bc += q.bc; bd += q.bd;
+				c2 += q.c2; cd += q.cd;
+				d2 += q.d2;
+				weight += q.weight;
+			}
+			//Weighted sum of squared distances from p to the planes
+			double evaluate(const ew::Vec3& p)const {
+				const double x = p.x, y = p.y, z = p.z;
+				const double r = x * x * a2 + y * y * b2 + z * z * c2 + d2
+					+ 2.0 * (x * y * ab + x * z * ac + y * z * bc + x * ad + y * bd + z * cd);
+				return r < 0.0 ? 0.0 : r;
+			}
+		};
+
+		struct Collapse {
+			unsigned int from;
+			unsigned int to;
+			double cost;
+		};
+
+		uint64_t edgeKey(unsigned int a, unsigned int b) {
+			return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+		}
+
+		//Vertices on edges used by only one triangle. Seams show up here too since their vertices are split.
+		std::vector<bool> findOpenVertices(const unsigned int* indices, size_t indexCount, size_t vertexCount) {
+			std::vector<uint64_t> edges;
+			edges.reserve(indexCount);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				for (int e = 0; e < 3; e++)
+				{
+					edges.push_back(edgeKey(indices[i + e], indices[i + (e + 1) % 3]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			std::vector<bool> open(vertexCount, false);
+			for (size_t i = 0; i < edges.size();)
+			{
+				size_t j = i + 1;
+				while (j < edges.size() && edges[j] == edges[i])
+					j++;
+				if (j - i == 1) {
+					open[edges[i] >> 32] = true;
+					open[edges[i] & 0xffffffff] = true;
+				}
+				i = j;
+			}
+			return open;
+		}
+
+		//Rejects collapses that would flip or flatten a triangle around from
+		bool collapseFlips(const Vertex* vertices, const unsigned int* indices, const std::vector<unsigned int>& offsets,
+			const std::vector<unsigned int>& triangles, unsigned int from, unsigned int to) {
+			const ew::Vec3& target = vertices[to].pos;
+			for (unsigned int a = offsets[from]; a < offsets[from + 1]; a++)
+			{
+				const unsigned int* tri = indices + triangles[a] * 3;
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+					continue;
+				ew::Vec3 p[3], q[3];
+				for (int j = 0; j < 3; j++)
+				{
+					p[j] = vertices[tri[j]].pos;
+					q[j] = tri[j] == from ? target : p[j];
+				}
+				const ew::Vec3 before = ew::Cross(p[1] - p[0], p[2] - p[0]);
+				const ew::Vec3 after = ew::Cross(q[1] - q[0], q[2] - q[0]);
+				if (ew::Dot(before, after) <= 0.0f)
+					return true;
+			}
+			return false;
+		}
+	}
+
+	std::vector<unsigned int> simplifyMesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+		size_t targetIndexCount, float* resultError)
+	{
+		indexCount -= indexCount % 3;
+		std::vector<unsigned int> result(indices, indices + indexCount);
+		double maxError = 0.0;
+		const std::vector<bool> locked = findOpenVertices(indices, indexCount, vertexCount);
+
+		//Area weighted plane of every triangle
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			const ew::Vec3& p0 = vertices[indices[i]].pos;
+			const ew::Vec3 cross = ew::Cross(vertices[indices[i + 1]].pos - p0, vertices[indices[i + 2]].pos - p0);
+			const float length = ew::Magnitude(cross);
+			if (length <= 0.0f)
+				continue;
+			const ew::Vec3 n = cross / length;
+			const double d = -ew::Dot(n, p0);
+			for (int j = 0; j < 3; j++)
+			{
+				quadrics[indices[i + j]].addPlane(n.x, n.y, n.z, d, length * 0.5);
+			}
+		}
+
+		std::vector<uint64_t> edges;
+		std::vector<Collapse> collapses;
+		std::vector<unsigned int> offsets, triangles, remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		while (result.size() > targetIndexCount)
+		{
+			//Cheapest direction of every edge
+			edges.clear();
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (int e = 0; e < 3; e++)
+				{
+					edges.push_back(edgeKey(result[i + e], result[i + (e + 1) % 3]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+			collapses.clear();
+			for (uint64_t key : edges)
+			{
+				const unsigned int a = (unsigned int)(key >> 32), b = (unsigned int)(key & 0xffffffff);
+				if (locked[a] && locked[b])
+					continue;
+				Quadric q = quadrics[a];
+				q.add(quadrics[b]);
+				const double costAB = locked[a] ? 1e300 : q.evaluate(vertices[b].pos);
+				const double costBA = locked[b] ? 1e300 : q.evaluate(vertices[a].pos);
+				if (costAB <= costBA)
+					collapses.push_back({ a, b, costAB });
+				else
+					collapses.push_back({ b, a, costBA });
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) {
+				return l.cost < r.cost;
+			});
+
+			//Triangles around each vertex for the flip test
+			offsets.assign(vertexCount + 1, 0);
+			for (unsigned int v : result)
+				offsets[v + 1]++;
+			for (size_t v = 0; v < vertexCount; v++)
+				offsets[v + 1] += offsets[v];
+			triangles.resize(result.size());
+			std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i++)
+				triangles[fill[result[i]]++] = (unsigned int)(i / 3);
+
+			//Each collapse removes about 2 triangles. Vertices collapse at most once per pass so neighborhoods stay valid.
+			const size_t wanted = (result.size() - targetIndexCount) / 6 + 1;
+			size_t done = 0;
+			for (size_t v = 0; v < vertexCount; v++)
+				remap[v] = (unsigned int)v;
+			std::fill(touched.begin(), touched.end(), false);
+			for (const Collapse& c : collapses)
+			{
+				if (done >= wanted)
+					break;
+				if (touched[c.from] || touched[c.to])
+					continue;
+				if (collapseFlips(vertices, result.data(), offsets, triangles, c.from, c.to))
+					continue;
+				remap[c.from] = c.to;
+				quadrics[c.to].add(quadrics[c.from]);
+				touched[c.from] = touched[c.to] = true;
+				const double weight = quadrics[c.to].weight;
+				if (weight > 0.0)
+					maxError = std::max(maxError, c.cost / weight);
+				done++;
+			}
+			if (done == 0)
+				break;
+
+			//Apply and drop triangles that collapsed to a line
+			size_t write = 0;
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				const unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+				if (a == b || b == c || c == a)
+					continue;
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+			result.resize(write);
+		}
+		if (resultError)
+			*resultError = (float)sqrt(maxError);
+		return result;
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	/// <summary>
+	/// Reduces a triangle list with quadric error metric edge collapses (Garland and Heckbert 1997).
+	/// Vertices only collapse onto existing vertices, so the result indexes the same vertex array.
+	/// Vertices on open edges, including UV and normal seams where vertices are split, never move, so seams stay closed.
+	/// </summary>
+	/// <param name="targetIndexCount">Stops once the result has this many indices or fewer</param>
+	/// <param name="resultError">Optional. Worst RMS distance of a collapsed vertex to the surface planes it replaced</param>
+	/// <returns>Simplified indices. Can have more than targetIndexCount if every remaining collapse is blocked.</returns>
+	std::vector<unsigned int> simplifyMesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+		size_t targetIndexCount, float* resultError = nullptr);
+}
@@ -0,0 +1,200 @@
+#include "terrain.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <cmath>
+#include <utility>
+
+namespace ew {
+	namespace {
+		int tileResolution(const TerrainParams& params) {
+			return params.tileResolution < 1 ? 1 : params.tileResolution;
+		}
+
+		//Row r of the grid is at z = half - r * spacing, column c at x = -half + c * spacing.
+		//Both the noise and the positions use these exact expressions, so shared borders match bit for bit.
+		struct TerrainGrid {
+			float half;
+			float spacing;
+			float x(int column)const { return -half + (float)column * spacing; }
+			float z(int row)const { return half - (float)row * spacing; }
+		};
+
+		TerrainGrid makeGrid(const TerrainParams& params) {
+			TerrainGrid grid;
+			grid.half = params.size * 0.5f;
+			grid.spacing = terrainSpacing(params);
+			return grid;
+		}
+	}
+
+	int terrainTileCount(const TerrainParams& params)
+	{
+		const int tile = tileResolution(params);
+		const int resolution = params.resolution < 1 ? 1 : params.resolution;
+		return (resolution + tile - 1) / tile;
+	}
+
+	float terrainSpacing(const TerrainParams& params)
+	{
+		return params.size / (float)(terrainTileCount(params) * tileResolution(params));
+	}
+
+	float terrainHeight(const TerrainParams& params, float x, float z)
+	{
+		return fbm(x, z, params.noise) * params.heightScale;
+	}
+
+	MeshCounts queryCounts(const TerrainTileParams& params)
+	{
+		const size_t resolution = tileResolution(params.terrain);
+		MeshCounts counts;
+		//Grid plus a copy of each border for the skirt
+		counts.vertexCount = (resolution + 1) * (resolution + 1) + (resolution + 1) * 4;
+		//Grid quads plus one quad per border segment
+		counts.indexCount = resolution * resolution * 6 + resolution * 4 * 6;
+		return counts;
+	}
+
+	Bounds queryBounds(const TerrainTileParams& params)
+	{
+		const TerrainParams& terrain = params.terrain;
+		const TerrainGrid grid = makeGrid(terrain);
+		const int resolution = tileResolution(terrain);
+		const float height = fabsf(terrain.heightScale);
+		const ew::Vec3 min = ew::Vec3(grid.x(params.tileX * resolution), -height - fabsf(terrain.skirtDepth), grid.z((params.tileZ + 1) * resolution));
+		const ew::Vec3 max = ew::Vec3(grid.x((params.tileX + 1) * resolution), height, grid.z(params.tileZ * resolution));
+		return ew::makeBounds(min, max);
+	}
+
+	bool emit(const TerrainTileParams& params, VertexSpan vertexSpan, IndexSpan indexSpan, unsigned int baseVertex, unsigned int threadCount)
+	{
+		const MeshCounts counts = queryCounts(params);
+		if (vertexSpan.size < counts.vertexCount || indexSpan.size < counts.indexCount) {
+			printf("Terrain tile needs %zu vertices and %zu indices, got %zu and %zu\n", counts.vertexCount, counts.indexCount, vertexSpan.size, indexSpan.size);
+			return false;
+		}
+		const TerrainParams& terrain = params.terrain;
+		const TerrainGrid grid = makeGrid(terrain);
+		const int resolution = tileResolution(terrain);
+		const int columns = resolution + 1;
+		const int firstColumn = params.tileX * resolution;
+		const int firstRow = params.tileZ * resolution;
+		const float uvScale = 1.0f / (float)(terrainTileCount(terrain) * resolution);
+		const float normalScale = terrain.heightScale / (2.0f * grid.spacing);
+		Vertex* vertices = vertexSpan.data;
+		unsigned int* indices = indexSpan.data;
+
+		//Bands of rows keep 3 rows of heights (with a 1 vertex apron for the differences), computing each row once
+		ew::parallelFor(columns, threadCount, procGenRowGrain(columns), [&](size_t begin, size_t end) {
+			const size_t rowLength = columns + 2;
+			std::vector<float> buffer(rowLength * 3);
+			float* rows[3] = { buffer.data(), buffer.data() + rowLength, buffer.data() + rowLength * 2 };
+			auto computeRow = [&](int row, float* out) {
+				fbmRow(-grid.half, grid.spacing, firstColumn - 1, rowLength, grid.z(firstRow + row), terrain.noise, out);
+			};
+			computeRow((int)begin - 1, rows[0]);
+			computeRow((int)begin, rows[1]);
+			for (int row = (int)begin; row < (int)end; row++)
+			{
+				computeRow(row + 1, rows[2]);
+				const float* above = rows[0] + 1;
+				const float* center = rows[1] + 1;
+				const float* below = rows[2] + 1;
+				const int globalRow = firstRow + row;
+				const float z = grid.z(globalRow);
+				Vertex* v = vertices + (size_t)row * columns;
+				for (int col = 0; col < columns; col++, v++)
+				{
+					const int globalColumn = firstColumn + col;
+					v->pos = ew::Vec3(grid.x(globalColumn), center[col] * terrain.heightScale, z);
+					//Central differences. Rows go toward -Z, so the row above is at +Z.
+					const float dx = (center[col + 1] - center[col - 1]) * normalScale;
+					const float dz = (above[col] - below[col]) * normalScale;
+					v->normal = ew::Normalize(ew::Vec3(-dx, 1.0f, -dz));
+					v->uv = ew::Vec2(globalColumn * uvScale, globalRow * uvScale);
+				}
+				std::swap(rows[0], rows[1]);
+				std::swap(rows[1], rows[2]);
+
+				//INDICES, same winding as createPlane
+				if (row == resolution)
+					continue;
+				unsigned int* index = indices + (size_t)row * resolution * 6;
+				for (int col = 0; col < resolution; col++)
+				{
+					const unsigned int start = baseVertex + row * columns + col;
+					*index++ = start;
+					*index++ = start + 1;
+					*index++ = start + columns + 1;
+					*index++ = start + columns + 1;
+					*index++ = start + columns;
+					*index++ = start;
+				}
+			}
+		});
+
+		//SKIRTS: each border is copied skirtDepth lower and joined to the grid by a strip facing outward
+		const unsigned int gridVertices = (unsigned int)(columns * columns);
+		unsigned int* index = indices + (size_t)resolution * resolution * 6;
+		for (int side = 0; side < 4; side++)
+		{
+			//+Z edge (row 0), -Z edge (last row), -X edge (column 0), +X edge (last column)
+			const unsigned int first = side == 0 ? 0 : side == 1 ? resolution * columns : side == 2 ? 0 : resolution;
+			const unsigned int step = side < 2 ? 1 : columns;
+			//Order along the border that makes (a, b, skirt b) face outward
+			const bool flip = side == 1 || side == 2;
+			const unsigned int skirtStart = gridVertices + side * columns;
+			for (int i = 0; i < columns; i++)
+			{
+				Vertex& skirt = vertices[skirtStart + i];
+				skirt = vertices[first + i * step];
+				skirt.pos.y -= terrain.skirtDepth;
+			}
+			for (int i = 0; i < resolution; i++)
+			{
+				unsigned int a = baseVertex + first + i * step, b = a + step;
+				unsigned int skirtA = baseVertex + skirtStart + i, skirtB = skirtA + 1;
+				if (flip) {
+					std::swap(a, b);
+					std::swap(skirtA, skirtB);
+				}
+				*index++ = a;
+				*index++ = skirtB;
+				*index++ = b;
+				*index++ = a;
+				*index++ = skirtA;
+				*index++ = skirtB;
+			}
+		}
+		return true;
+	}
+
+	MeshData createTerrainTile(const TerrainParams& params, int tileX, int tileZ, unsigned int threadCount)
+	{
+		TerrainTileParams tile;
+		tile.terrain = params;
+		tile.tileX = tileX;
+		tile.tileZ = tileZ;
+		MeshData mesh;
+		const MeshCounts counts = queryCounts(tile);
+		mesh.vertices.resize(counts.vertexCount);
+		mesh.indices.resize(counts.indexCount);
+		emit(tile, VertexSpan(mesh.vertices), IndexSpan(mesh.indices), 0, threadCount);
+		mesh.bounds = queryBounds(tile);
+		mesh.hasBounds = true;
+		return mesh;
+	}
+
+	std::vector<MeshData> createTerrain(const TerrainParams& params, unsigned int threadCount)
+	{
+		const int tiles = terrainTileCount(params);
+		std::vector<MeshData> meshes((size_t)tiles * tiles);
+		ew::parallelFor(meshes.size(), threadCount, 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				meshes[i] = createTerrainTile(params, (int)(i % tiles), (int)(i / tiles), 1);
+			}
+		});
+		return meshes;
+	}
+}
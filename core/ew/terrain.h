@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "noise.h"
+#include "procGen.h"
+
+namespace ew {
+	//Heightfield displaced by fBm noise, split into square tiles that can be generated independently
+	struct TerrainParams {
+		//Width and depth of the whole terrain, centered on the origin like createPlane
+		float size = 256.0f;
+		//Quads per side of the whole terrain. Rounded up to a multiple of tileResolution.
+		int resolution = 1024;
+		//Quads per side of one tile
+		int tileResolution = 128;
+		//Heights are noise * heightScale, so within [-heightScale, heightScale]
+		float heightScale = 16.0f;
+		//How far the skirt around each tile hangs below its border, hiding cracks between tiles
+		float skirtDepth = 1.0f;
+		NoiseParams noise;
+	};
+
+	//One tile for the queryCounts/emit API (see procGen.h)
+	struct TerrainTileParams {
+		TerrainParams terrain;
+		//Tile column, 0 at -X
+		int tileX = 0;
+		//Tile row, 0 at +Z like createPlane's rows
+		int tileZ = 0;
+	};
+
+	//Tiles per side
+	int terrainTileCount(const TerrainParams& params);
+	//Distance between grid vertices
+	float terrainSpacing(const TerrainParams& params);
+	//Height of the noise at (x, z), e.g. for placing objects. Matches the mesh at grid vertices up to rounding.
+	float terrainHeight(const TerrainParams& params, float x, float z);
+
+	//Grid of (tileResolution + 1)^2 vertices in createPlane's layout and winding, then the skirt vertices
+	MeshCounts queryCounts(const TerrainTileParams& params);
+	//Conservative, from heightScale and skirtDepth
+	Bounds queryBounds(const TerrainTileParams& params);
+	/// <summary>
+	/// Evaluates the tile's heights row by row (AVX2 when available) and writes positions, finite difference normals
+	/// and terrain wide UVs in the same pass. Border heights come from the same world positions in neighboring tiles,
+	/// so tiles meet without seams.
+	/// </summary>
+	/// <param name="threadCount">Threads for this tile's rows. Defaults to 1 since tiles are usually the parallel unit.</param>
+	bool emit(const TerrainTileParams& params, VertexSpan vertices, IndexSpan indices, unsigned int baseVertex = 0, unsigned int threadCount = 1);
+
+	MeshData createTerrainTile(const TerrainParams& params, int tileX, int tileZ, unsigned int threadCount = 1);
+	/// <summary>
+	/// Generates every tile, one tile per task on threadCount threads (0 = one per hardware thread).
+	/// </summary>
+	/// <returns>Tiles in row major order, index tileZ * terrainTileCount(params) + tileX</returns>
+	std::vector<MeshData> createTerrain(const TerrainParams& params, unsigned int threadCount = 0);
+}
@@ -6,13 +6,82 @@ namespace ew {
 		ew::Vec3 position = ew::Vec3(0.0f, 0.0f, 0.0f);
 		ew::Vec3 rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (Degrees)
 		ew::Vec3 scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+		ew::Quat orientation = ew::Quat(); //Unit quaternion, replaces rotation when useOrientation is set
+		bool useOrientation = false;
 
-		ew::Mat4 getModelMatrix() const {
-			return ew::Translate(position)
-				* ew::RotateY(ew::Radians(rotation.y))
-				* ew::RotateX(ew::Radians(rotation.x))
-				* ew::RotateZ(ew::Radians(rotation.z))
-				* ew::Scale(scale);
+		//Translate * RotateY * RotateX * RotateZ * Scale, or Translate * orientation * Scale.
+		//Matrices are cached and only rebuilt after position, rotation or scale change.
+		//The cache makes these getters unsafe to call on the same Transform from multiple threads.
+		const ew::Mat4& getModelMatrix() const {
+			sync();
+			if (!(m_valid & MODEL)) {
+				float r[3][3];
+				rotationMatrix(r);
+				m_model = ew::TRS(position, r, scale);
+				m_valid |= MODEL;
+			}
+			return m_model;
 		}
+		//World->Local. Scale must be non-zero.
+		const ew::Mat4& getInverseModelMatrix() const {
+			sync();
+			if (!(m_valid & INVERSE)) {
+				float r[3][3];
+				rotationMatrix(r);
+				m_inverse = ew::InverseTRS(position, r, scale);
+				m_valid |= INVERSE;
+			}
+			return m_inverse;
+		}
+		//transpose(inverse(mat3(model))) in the upper 3x3. Scale must be non-zero.
+		const ew::Mat4& getNormalMatrix() const {
+			sync();
+			if (!(m_valid & NORMAL)) {
+				float r[3][3];
+				rotationMatrix(r);
+				m_normal = ew::NormalMatrixTRS(r, scale);
+				m_valid |= NORMAL;
+			}
+			return m_normal;
+		}
+	private:
+		enum : unsigned char { MODEL = 1, INVERSE = 2, NORMAL = 4 };
+
+		static bool equal(const ew::Vec3& a, const ew::Vec3& b) {
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+		static bool equal(const ew::Quat& a, const ew::Quat& b) {
+			return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+		}
+		//Quaternions skip the trig entirely
+		void rotationMatrix(float r[3][3]) const {
+			if (useOrientation)
+				ew::QuatToRotation(orientation, r);
+			else
+				ew::EulerYXZ(rotation * ew::DEG2RAD, r);
+		}
+		//Fields are public and edited directly (e.g. by ImGui), so changes are detected
+		//by comparing against the values the cache was built from.
+		void sync() const {
+			if (!equal(position, m_cachedPosition) || !equal(rotation, m_cachedRotation) || !equal(scale, m_cachedScale)
+				|| !equal(orientation, m_cachedOrientation) || useOrientation != m_cachedUseOrientation) {
+				m_cachedPosition = position;
+				m_cachedRotation = rotation;
+				m_cachedScale = scale;
+				m_cachedOrientation = orientation;
+				m_cachedUseOrientation = useOrientation;
+				m_valid = 0;
+			}
+		}
+
+		mutable ew::Vec3 m_cachedPosition = ew::Vec3(0.0f, 0.0f, 0.0f);
+		mutable ew::Vec3 m_cachedRotation = ew::Vec3(0.0f, 0.0f, 0.0f);
+		mutable ew::Vec3 m_cachedScale = ew::Vec3(1.0f, 1.0f, 1.0f);
+		mutable ew::Quat m_cachedOrientation = ew::Quat();
+		mutable bool m_cachedUseOrientation = false;
+		mutable unsigned char m_valid = 0;
+		mutable ew::Mat4 m_model;
+		mutable ew::Mat4 m_inverse;
+		mutable ew::Mat4 m_normal;
 	};
 }
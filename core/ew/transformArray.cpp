@@ -0,0 +1,193 @@
+#include "transformArray.h"
+#include "parallel.h"
+#include "ewMath/simdMath.h"
+
+namespace ew {
+	namespace {
+		void modelMatricesScalar(const TransformArray& a, size_t begin, size_t end, ew::Mat4* out) {
+			for (size_t i = begin; i < end; i++)
+			{
+				ew::Vec3 p = ew::Vec3(a.positions(0)[i], a.positions(1)[i], a.positions(2)[i]);
+				ew::Vec3 r = ew::Vec3(a.rotations(0)[i], a.rotations(1)[i], a.rotations(2)[i]);
+				ew::Vec3 s = ew::Vec3(a.scales(0)[i], a.scales(1)[i], a.scales(2)[i]);
+				if (a.useOrientation()[i]) {
+					float m[3][3];
+					ew::QuatToRotation(ew::Quat(a.orientations(0)[i], a.orientations(1)[i], a.orientations(2)[i], a.orientations(3)[i]), m);
+					out[i] = ew::TRS(p, m, s);
+				}
+				else {
+					out[i] = ew::TRS(p, r * ew::DEG2RAD, s);
+				}
+			}
+		}
+#if EW_SIMD_X86
+		//See ew::EulerYXZ. m[R * 3 + C] = row R, column C
+		EW_TARGET_AVX2 void eulerRotation8(const TransformArray& a, size_t i, __m256 m[9]) {
+			const __m256 deg2Rad = _mm256_set1_ps(ew::DEG2RAD);
+			__m256 sx, cx, sy, cy, sz, cz;
+			simd::SinCos8(_mm256_mul_ps(_mm256_loadu_ps(a.rotations(0) + i), deg2Rad), &sx, &cx);
+			simd::SinCos8(_mm256_mul_ps(_mm256_loadu_ps(a.rotations(1) + i), deg2Rad), &sy, &cy);
+			simd::SinCos8(_mm256_mul_ps(_mm256_loadu_ps(a.rotations(2) + i), deg2Rad), &sz, &cz);
+			const __m256 sysx = _mm256_mul_ps(sy, sx);
+			const __m256 cysx = _mm256_mul_ps(cy, sx);
+			m[0] = _mm256_fmadd_ps(sysx, sz, _mm256_mul_ps(cy, cz));
+			m[1] = _mm256_fmsub_ps(sysx, cz, _mm256_mul_ps(cy, sz));
+			m[2] = _mm256_mul_ps(sy, cx);
+			m[3] = _mm256_mul_ps(cx, sz);
+			m[4] = _mm256_mul_ps(cx, cz);
+			m[5] = _mm256_sub_ps(_mm256_setzero_ps(), sx);
+			m[6] = _mm256_fmsub_ps(cysx, sz, _mm256_mul_ps(sy, cz));
+			m[7] = _mm256_fmadd_ps(cysx, cz, _mm256_mul_ps(sy, sz));
+			m[8] = _mm256_mul_ps(cy, cx);
+		}
+		//See ew::QuatToRotation
+		EW_TARGET_AVX2 void quatRotation8(const TransformArray& a, size_t i, __m256 m[9]) {
+			const __m256 x = _mm256_loadu_ps(a.orientations(0) + i);
+			const __m256 y = _mm256_loadu_ps(a.orientations(1) + i);
+			const __m256 z = _mm256_loadu_ps(a.orientations(2) + i);
+			const __m256 w = _mm256_loadu_ps(a.orientations(3) + i);
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 two = _mm256_set1_ps(2.0f);
+			const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+			const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+			const __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+			m[0] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz)));
+			m[1] = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz));
+			m[2] = _mm256_mul_ps(two, _mm256_add_ps(xz, wy));
+			m[3] = _mm256_mul_ps(two, _mm256_add_ps(xy, wz));
+			m[4] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz)));
+			m[5] = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx));
+			m[6] = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+			m[7] = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+			m[8] = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy)));
+		}
+		//Same math as ew::TRS, 8 transforms per iteration. Returns the first index it did not process.
+		EW_TARGET_AVX2 size_t modelMatricesAVX2(const TransformArray& a, size_t begin, size_t end, ew::Mat4* out) {
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 one = _mm256_set1_ps(1.0f);
+			size_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				//Lanes using their orientation. Groups of 8 are usually all one kind, so only mixed groups compute both.
+				const __m256 quatMask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.useOrientation() + i)), _mm256_setzero_si256()));
+				const int quatLanes = _mm256_movemask_ps(quatMask);
+				__m256 m[9];
+				if (quatLanes == 0xFF) {
+					quatRotation8(a, i, m);
+				}
+				else {
+					eulerRotation8(a, i, m);
+					if (quatLanes != 0) {
+						__m256 q[9];
+						quatRotation8(a, i, q);
+						for (int j = 0; j < 9; j++)
+						{
+							m[j] = _mm256_blendv_ps(m[j], q[j], quatMask);
+						}
+					}
+				}
+				const __m256 scaleX = _mm256_loadu_ps(a.scales(0) + i);
+				const __m256 scaleY = _mm256_loadu_ps(a.scales(1) + i);
+				const __m256 scaleZ = _mm256_loadu_ps(a.scales(2) + i);
+
+				float* dst = reinterpret_cast<float*>(out + i);
+				simd::StoreTransposed4x8(_mm256_mul_ps(m[0], scaleX), _mm256_mul_ps(m[3], scaleX), _mm256_mul_ps(m[6], scaleX), zero, dst + 0, 16);
+				simd::StoreTransposed4x8(_mm256_mul_ps(m[1], scaleY), _mm256_mul_ps(m[4], scaleY), _mm256_mul_ps(m[7], scaleY), zero, dst + 4, 16);
+				simd::StoreTransposed4x8(_mm256_mul_ps(m[2], scaleZ), _mm256_mul_ps(m[5], scaleZ), _mm256_mul_ps(m[8], scaleZ), zero, dst + 8, 16);
+				simd::StoreTransposed4x8(_mm256_loadu_ps(a.positions(0) + i), _mm256_loadu_ps(a.positions(1) + i), _mm256_loadu_ps(a.positions(2) + i), one, dst + 12, 16);
+			}
+			return i;
+		}
+#endif
+	}
+
+	TransformArray::TransformArray(size_t count)
+	{
+		resize(count);
+	}
+	size_t TransformArray::add(const ew::Transform& transform)
+	{
+		resize(m_count + 1);
+		set(m_count - 1, transform);
+		return m_count - 1;
+	}
+	void TransformArray::set(size_t index, const ew::Transform& transform)
+	{
+		m_position[0][index] = transform.position.x;
+		m_position[1][index] = transform.position.y;
+		m_position[2][index] = transform.position.z;
+		m_rotation[0][index] = transform.rotation.x;
+		m_rotation[1][index] = transform.rotation.y;
+		m_rotation[2][index] = transform.rotation.z;
+		m_scale[0][index] = transform.scale.x;
+		m_scale[1][index] = transform.scale.y;
+		m_scale[2][index] = transform.scale.z;
+		m_orientation[0][index] = transform.orientation.x;
+		m_orientation[1][index] = transform.orientation.y;
+		m_orientation[2][index] = transform.orientation.z;
+		m_orientation[3][index] = transform.orientation.w;
+		m_useOrientation[index] = transform.useOrientation ? 1 : 0;
+	}
+	ew::Transform TransformArray::get(size_t index) const
+	{
+		ew::Transform t;
+		t.position = ew::Vec3(m_position[0][index], m_position[1][index], m_position[2][index]);
+		t.rotation = ew::Vec3(m_rotation[0][index], m_rotation[1][index], m_rotation[2][index]);
+		t.scale = ew::Vec3(m_scale[0][index], m_scale[1][index], m_scale[2][index]);
+		t.orientation = ew::Quat(m_orientation[0][index], m_orientation[1][index], m_orientation[2][index], m_orientation[3][index]);
+		t.useOrientation = m_useOrientation[index] != 0;
+		return t;
+	}
+	void TransformArray::resize(size_t count)
+	{
+		//New transforms default to identity, same as ew::Transform
+		for (int axis = 0; axis < 3; axis++)
+		{
+			m_position[axis].resize(count, 0.0f);
+			m_rotation[axis].resize(count, 0.0f);
+			m_scale[axis].resize(count, 1.0f);
+		}
+		const ew::Quat identity = ew::Quat();
+		m_orientation[0].resize(count, identity.x);
+		m_orientation[1].resize(count, identity.y);
+		m_orientation[2].resize(count, identity.z);
+		m_orientation[3].resize(count, identity.w);
+		m_useOrientation.resize(count, 0);
+		m_count = count;
+	}
+	void TransformArray::reserve(size_t count)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			m_position[axis].reserve(count);
+			m_rotation[axis].reserve(count);
+			m_scale[axis].reserve(count);
+		}
+		for (int component = 0; component < 4; component++)
+		{
+			m_orientation[component].reserve(count);
+		}
+		m_useOrientation.reserve(count);
+	}
+	void TransformArray::clear()
+	{
+		resize(0);
+	}
+	void TransformArray::computeModelMatrices(ew::Mat4* out, unsigned int threadCount) const
+	{
+		//Ranges are multiples of 8 so only the last one has a scalar tail
+		ew::parallelFor(m_count, threadCount, 1024, [&](size_t begin, size_t end) {
+			computeModelMatrices(begin, end, out);
+		});
+	}
+	void TransformArray::computeModelMatrices(size_t begin, size_t end, ew::Mat4* out) const
+	{
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			begin = modelMatricesAVX2(*this, begin, end, out);
+		}
+#endif
+		modelMatricesScalar(*this, begin, end, out);
+	}
+}
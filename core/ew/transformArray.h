@@ -0,0 +1,55 @@
+#pragma once
+#include "transform.h"
+#include "alignedAllocator.h"
+
+namespace ew {
+	/// <summary>
+	/// Stores many transforms as separate position/rotation/scale streams (structure of arrays)
+	/// so their model matrices can be built 8 at a time with AVX2.
+	/// Rotation is Euler angles in degrees, or the orientation quaternion where useOrientation is set, same as ew::Transform.
+	/// </summary>
+	class TransformArray {
+	public:
+		TransformArray() {};
+		TransformArray(size_t count);
+		//Appends a transform. Returns its index
+		size_t add(const ew::Transform& transform);
+		void set(size_t index, const ew::Transform& transform);
+		ew::Transform get(size_t index) const;
+		void resize(size_t count);
+		void reserve(size_t count);
+		void clear();
+		inline size_t size()const { return m_count; }
+
+		//Direct access to the component streams. axis: 0 = x, 1 = y, 2 = z
+		inline float* positions(int axis) { return m_position[axis].data(); }
+		inline float* rotations(int axis) { return m_rotation[axis].data(); }
+		inline float* scales(int axis) { return m_scale[axis].data(); }
+		//component: 0 = x, 1 = y, 2 = z, 3 = w
+		inline float* orientations(int component) { return m_orientation[component].data(); }
+		//1 where the transform uses its orientation instead of its Euler rotation, else 0
+		inline int* useOrientation() { return m_useOrientation.data(); }
+		inline const float* positions(int axis)const { return m_position[axis].data(); }
+		inline const float* rotations(int axis)const { return m_rotation[axis].data(); }
+		inline const float* scales(int axis)const { return m_scale[axis].data(); }
+		inline const float* orientations(int component)const { return m_orientation[component].data(); }
+		inline const int* useOrientation()const { return m_useOrientation.data(); }
+
+		/// <summary>
+		/// Writes size() model matrices into out, in the same order as the transforms.
+		/// Matrices are tightly packed column-major floats, so out can be uploaded as per-instance data.
+		/// </summary>
+		/// <param name="out">Destination with room for size() matrices</param>
+		/// <param name="threadCount">Threads to split the work over. 0 = one per hardware thread</param>
+		void computeModelMatrices(ew::Mat4* out, unsigned int threadCount = 1)const;
+		//Same as above for transforms [begin, end), written to out[begin] .. out[end - 1]
+		void computeModelMatrices(size_t begin, size_t end, ew::Mat4* out)const;
+	private:
+		size_t m_count = 0;
+		ew::AlignedVector<float> m_position[3];
+		ew::AlignedVector<float> m_rotation[3];
+		ew::AlignedVector<float> m_scale[3];
+		ew::AlignedVector<float> m_orientation[4];
+		ew::AlignedVector<int> m_useOrientation;
+	};
+}
@@ -0,0 +1,275 @@
+#include "vertexLayout.h"
+#include "mesh.h"
+#include "ewMath/simdMath.h"
+#include "external/glad.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace ew {
+	namespace {
+		//Per axis scale/offset that maps box to [0, 65535]
+		struct Quantization {
+			float offset[3];
+			float scale[3];
+		};
+
+		Quantization makeQuantization(const AABB& box) {
+			Quantization q;
+			const float mn[3] = { box.min.x, box.min.y, box.min.z };
+			const float mx[3] = { box.max.x, box.max.y, box.max.z };
+			for (int i = 0; i < 3; i++)
+			{
+				const float extent = mx[i] - mn[i];
+				q.offset[i] = mn[i];
+				//Flat axes store 0, which dequantizes to box.min
+				q.scale[i] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+			}
+			return q;
+		}
+
+		uint32_t floatBits(float f) {
+			uint32_t u;
+			memcpy(&u, &f, sizeof(u));
+			return u;
+		}
+
+		uint32_t pack16(uint32_t lo, uint32_t hi) {
+			return (lo & 0xffff) | (hi << 16);
+		}
+
+		//Clamped to [lo, hi], rounded to nearest even like the AVX2 path
+		int32_t quantize(float v, float lo, float hi) {
+			v = v < lo ? lo : (v > hi ? hi : v);
+			return (int32_t)lrintf(v);
+		}
+
+		//Octahedral projection of a normal onto the [-1,1] square
+		void octEncode(const ew::Vec3& n, float* ox, float* oy) {
+			const float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+			const float inv = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+			float x = n.x * inv, y = n.y * inv;
+			if (n.z < 0.0f) {
+				const float fx = (1.0f - fabsf(y)) * (x < 0.0f ? -1.0f : 1.0f);
+				const float fy = (1.0f - fabsf(x)) * (y < 0.0f ? -1.0f : 1.0f);
+				x = fx;
+				y = fy;
+			}
+			*ox = x;
+			*oy = y;
+		}
+
+		//Writes one vertex as 32 bit words. Returns the number written (layout.stride() / 4).
+		size_t packVertexScalar(const Vertex& v, const VertexLayout& layout, const Quantization& q, uint32_t* out) {
+			size_t n = 0;
+			if (layout.position == PositionFormat::FLOAT3) {
+				out[n++] = floatBits(v.pos.x);
+				out[n++] = floatBits(v.pos.y);
+				out[n++] = floatBits(v.pos.z);
+			}
+			else {
+				const int32_t x = quantize((v.pos.x - q.offset[0]) * q.scale[0], 0.0f, 65535.0f);
+				const int32_t y = quantize((v.pos.y - q.offset[1]) * q.scale[1], 0.0f, 65535.0f);
+				const int32_t z = quantize((v.pos.z - q.offset[2]) * q.scale[2], 0.0f, 65535.0f);
+				out[n++] = pack16(x, y);
+				out[n++] = pack16(z, 0);
+			}
+			if (layout.normal == NormalFormat::FLOAT3) {
+				out[n++] = floatBits(v.normal.x);
+				out[n++] = floatBits(v.normal.y);
+				out[n++] = floatBits(v.normal.z);
+			}
+			else {
+				float ox, oy;
+				octEncode(v.normal, &ox, &oy);
+				out[n++] = pack16(quantize(ox * 32767.0f, -32767.0f, 32767.0f), quantize(oy * 32767.0f, -32767.0f, 32767.0f));
+			}
+			switch (layout.uv) {
+			case UVFormat::FLOAT2:
+				out[n++] = floatBits(v.uv.x);
+				out[n++] = floatBits(v.uv.y);
+				break;
+			case UVFormat::HALF2:
+				out[n++] = pack16(floatToHalf(v.uv.x), floatToHalf(v.uv.y));
+				break;
+			case UVFormat::UNORM16:
+				out[n++] = pack16(quantize(v.uv.x * 65535.0f, 0.0f, 65535.0f), quantize(v.uv.y * 65535.0f, 0.0f, 65535.0f));
+				break;
+			}
+			return n;
+		}
+
+#if EW_SIMD_X86
+		static_assert(sizeof(Vertex) == sizeof(float) * 8, "Vertex must be 8 floats for the transposed load");
+
+		//Clamps, rounds to nearest even, then packs the low 16 bits of a and b into one word
+		EW_TARGET_AVX2 __m256i pack16x8(__m256 a, __m256 b, __m256 lo, __m256 hi) {
+			const __m256i ia = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(a, lo), hi));
+			const __m256i ib = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(b, lo), hi));
+			return _mm256_or_si256(_mm256_and_si256(ia, _mm256_set1_epi32(0xffff)), _mm256_slli_epi32(ib, 16));
+		}
+
+		//Same encoding as packVertexScalar, 8 vertices per iteration. Returns the first index it did not process.
+		EW_TARGET_AVX2 size_t packVerticesAVX2(const Vertex* vertices, size_t count, const VertexLayout& layout, const Quantization& q, uint32_t* out) {
+			const size_t words = layout.stride() / 4;
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 minusOne = _mm256_set1_ps(-1.0f);
+			const __m256 unormMax = _mm256_set1_ps(65535.0f);
+			const __m256 snormMax = _mm256_set1_ps(32767.0f);
+			const __m256 snormMin = _mm256_set1_ps(-32767.0f);
+			const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+			alignas(32) uint32_t lanes[8][8];
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				//f[0..7] = pos.xyz, normal.xyz, uv.xy of 8 vertices
+				__m256 f[8];
+				simd::LoadTransposed8x8(&vertices[i].pos.x, 8, f);
+				__m256i w[8];
+				size_t n = 0;
+				if (layout.position == PositionFormat::FLOAT3) {
+					w[n++] = _mm256_castps_si256(f[0]);
+					w[n++] = _mm256_castps_si256(f[1]);
+					w[n++] = _mm256_castps_si256(f[2]);
+				}
+				else {
+					const __m256 x = _mm256_mul_ps(_mm256_sub_ps(f[0], _mm256_set1_ps(q.offset[0])), _mm256_set1_ps(q.scale[0]));
+					const __m256 y = _mm256_mul_ps(_mm256_sub_ps(f[1], _mm256_set1_ps(q.offset[1])), _mm256_set1_ps(q.scale[1]));
+					const __m256 z = _mm256_mul_ps(_mm256_sub_ps(f[2], _mm256_set1_ps(q.offset[2])), _mm256_set1_ps(q.scale[2]));
+					w[n++] = pack16x8(x, y, zero, unormMax);
+					w[n++] = pack16x8(z, zero, zero, unormMax);
+				}
+				if (layout.normal == NormalFormat::FLOAT3) {
+					w[n++] = _mm256_castps_si256(f[3]);
+					w[n++] = _mm256_castps_si256(f[4]);
+					w[n++] = _mm256_castps_si256(f[5]);
+				}
+				else {
+					const __m256 ax = _mm256_and_ps(f[3], absMask);
+					const __m256 ay = _mm256_and_ps(f[4], absMask);
+					const __m256 az = _mm256_and_ps(f[5], absMask);
+					const __m256 l1 = _mm256_add_ps(_mm256_add_ps(ax, ay), az);
+					const __m256 inv = _mm256_and_ps(_mm256_div_ps(one, l1), _mm256_cmp_ps(l1, zero, _CMP_GT_OQ));
+					const __m256 x = _mm256_mul_ps(f[3], inv);
+					const __m256 y = _mm256_mul_ps(f[4], inv);
+					//Lower hemisphere folds over the diagonals
+					const __m256 signX = _mm256_blendv_ps(one, minusOne, _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+					const __m256 signY = _mm256_blendv_ps(one, minusOne, _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+					const __m256 foldX = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_and_ps(y, absMask)), signX);
+					const __m256 foldY = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_and_ps(x, absMask)), signY);
+					const __m256 lower = _mm256_cmp_ps(f[5], zero, _CMP_LT_OQ);
+					const __m256 ox = _mm256_blendv_ps(x, foldX, lower);
+					const __m256 oy = _mm256_blendv_ps(y, foldY, lower);
+					w[n++] = pack16x8(_mm256_mul_ps(ox, snormMax), _mm256_mul_ps(oy, snormMax), snormMin, snormMax);
+				}
+				switch (layout.uv) {
+				case UVFormat::FLOAT2:
+					w[n++] = _mm256_castps_si256(f[6]);
+					w[n++] = _mm256_castps_si256(f[7]);
+					break;
+				case UVFormat::HALF2: {
+					const __m128i u = _mm256_cvtps_ph(f[6], _MM_FROUND_TO_NEAREST_INT);
+					const __m128i v = _mm256_cvtps_ph(f[7], _MM_FROUND_TO_NEAREST_INT);
+					w[n++] = _mm256_setr_m128i(_mm_unpacklo_epi16(u, v), _mm_unpackhi_epi16(u, v));
+					break;
+				}
+				case UVFormat::UNORM16:
+					w[n++] = pack16x8(_mm256_mul_ps(f[6], unormMax), _mm256_mul_ps(f[7], unormMax), zero, unormMax);
+					break;
+				}
+
+				//Interleave the attribute words back into vertices
+				for (size_t j = 0; j < n; j++)
+					_mm256_store_si256((__m256i*)lanes[j], w[j]);
+				uint32_t* dst = out + i * words;
+				for (size_t lane = 0; lane < 8; lane++)
+				{
+					for (size_t j = 0; j < n; j++)
+						dst[lane * words + j] = lanes[j][lane];
+				}
+			}
+			return i;
+		}
+#endif
+	}
+
+	unsigned short floatToHalf(float f)
+	{
+		uint32_t u = floatBits(f);
+		const uint32_t sign = (u >> 16) & 0x8000;
+		u &= 0x7fffffff;
+		//Inf and NaN
+		if (u >= 0x7f800000)
+			return (unsigned short)(sign | (u > 0x7f800000 ? 0x7e00 : 0x7c00));
+		//Too large for half
+		if (u >= 0x47800000)
+			return (unsigned short)(sign | 0x7c00);
+		//Subnormal half. Adding 0.5 lets the FPU do the rounding.
+		if (u < 0x38800000) {
+			float a;
+			memcpy(&a, &u, sizeof(a));
+			return (unsigned short)(sign | (floatBits(a + 0.5f) - 0x3f000000));
+		}
+		//Rebias the exponent and round the mantissa to nearest even
+		const uint32_t odd = (u >> 13) & 1;
+		u += 0xc8000fff + odd;
+		return (unsigned short)(sign | (u >> 13));
+	}
+
+	void packVertices(const Vertex* vertices, size_t count, const VertexLayout& layout, const AABB& box, void* out)
+	{
+		const Quantization q = makeQuantization(box);
+		uint32_t* dst = (uint32_t*)out;
+		const size_t words = layout.stride() / 4;
+		size_t i = 0;
+#if EW_SIMD_X86
+		if (ew::GetSimdLevel() >= ew::SimdLevel::AVX2) {
+			i = packVerticesAVX2(vertices, count, layout, q, dst);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			packVertexScalar(vertices[i], layout, q, dst + i * words);
+		}
+	}
+
+	std::vector<unsigned char> packVertices(const std::vector<Vertex>& vertices, const VertexLayout& layout, const AABB& box)
+	{
+		std::vector<unsigned char> out(vertices.size() * layout.stride());
+		packVertices(vertices.data(), vertices.size(), layout, box, out.data());
+		return out;
+	}
+
+	void setVertexAttributes(const VertexLayout& layout)
+	{
+		const GLsizei stride = layout.stride();
+		//Position attribute
+		if (layout.position == PositionFormat::FLOAT3)
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (const void*)(size_t)layout.positionOffset());
+		else
+			glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (const void*)(size_t)layout.positionOffset());
+		glEnableVertexAttribArray(0);
+
+		//Normal attribute
+		if (layout.normal == NormalFormat::FLOAT3)
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const void*)(size_t)layout.normalOffset());
+		else
+			glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (const void*)(size_t)layout.normalOffset());
+		glEnableVertexAttribArray(1);
+
+		//UV attribute
+		switch (layout.uv) {
+		case UVFormat::FLOAT2:
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (const void*)(size_t)layout.uvOffset());
+			break;
+		case UVFormat::HALF2:
+			glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (const void*)(size_t)layout.uvOffset());
+			break;
+		case UVFormat::UNORM16:
+			glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (const void*)(size_t)layout.uvOffset());
+			break;
+		}
+		glEnableVertexAttribArray(2);
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include "ewMath/ewMath.h"
+#include "bounds.h"
+
+namespace ew {
+	struct Vertex;
+
+	enum class PositionFormat {
+		FLOAT3 = 0,
+		//4 x unorm16 (w unused) relative to the mesh AABB. Draw with Mesh::getDequantizeMatrix in the model matrix.
+		UNORM16 = 1
+	};
+
+	enum class NormalFormat {
+		FLOAT3 = 0,
+		//Octahedral encoding in 2 x snorm16. Decode in the vertex shader:
+		//vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+		//float t = max(-n.z, 0.0);
+		//n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+		//n = normalize(n);
+		OCT_SNORM16 = 1
+	};
+
+	enum class UVFormat {
+		FLOAT2 = 0,
+		HALF2 = 1,
+		//Clamped to [0,1]. Use HALF2 for tiling UVs.
+		UNORM16 = 2
+	};
+
+	/// <summary>
+	/// How vertex attributes are stored in a mesh's vertex buffer. Attributes are interleaved in the order
+	/// position, normal, uv at locations 0, 1 and 2. The default is the 32 byte float layout of ew::Vertex.
+	/// </summary>
+	struct VertexLayout {
+		PositionFormat position = PositionFormat::FLOAT3;
+		NormalFormat normal = NormalFormat::FLOAT3;
+		UVFormat uv = UVFormat::FLOAT2;
+
+		constexpr VertexLayout() {};
+		constexpr VertexLayout(PositionFormat position, NormalFormat normal, UVFormat uv)
+			: position(position), normal(normal), uv(uv) {};
+
+		//16 bytes per vertex: quantized positions, octahedral normals, half UVs
+		static constexpr VertexLayout Compact() {
+			return VertexLayout(PositionFormat::UNORM16, NormalFormat::OCT_SNORM16, UVFormat::HALF2);
+		}
+
+		//Sizes and offsets in bytes. Every attribute is a multiple of 4 bytes.
+		constexpr unsigned int positionSize()const { return position == PositionFormat::FLOAT3 ? 12 : 8; }
+		constexpr unsigned int normalSize()const { return normal == NormalFormat::FLOAT3 ? 12 : 4; }
+		constexpr unsigned int uvSize()const { return uv == UVFormat::FLOAT2 ? 8 : 4; }
+		constexpr unsigned int positionOffset()const { return 0; }
+		constexpr unsigned int normalOffset()const { return positionSize(); }
+		constexpr unsigned int uvOffset()const { return positionSize() + normalSize(); }
+		constexpr unsigned int stride()const { return positionSize() + normalSize() + uvSize(); }
+
+		constexpr bool isQuantized()const { return position == PositionFormat::UNORM16; }
+		constexpr bool isDefault()const {
+			return position == PositionFormat::FLOAT3 && normal == NormalFormat::FLOAT3 && uv == UVFormat::FLOAT2;
+		}
+	};
+
+	/// <summary>
+	/// Converts vertices into a layout, 8 at a time with AVX2 (and F16C for half UVs).
+	/// </summary>
+	/// <param name="box">Range quantized positions are stored relative to. Unused for float positions.</param>
+	/// <param name="out">Destination with room for count * layout.stride() bytes</param>
+	void packVertices(const Vertex* vertices, size_t count, const VertexLayout& layout, const AABB& box, void* out);
+	std::vector<unsigned char> packVertices(const std::vector<Vertex>& vertices, const VertexLayout& layout, const AABB& box);
+
+	/// <summary>
+	/// Maps unorm16 positions in [0,1] back into box. Multiply into the model matrix (model * dequantize)
+	/// for positions only, and keep computing the normal matrix from the model alone.
+	/// </summary>
+	inline constexpr ew::Mat4 DequantizeMatrix(const AABB& box) {
+		//Translate(box.min) * Scale(box.max - box.min)
+		return ew::Mat4(
+			box.max.x - box.min.x, 0.0f, 0.0f, box.min.x,
+			0.0f, box.max.y - box.min.y, 0.0f, box.min.y,
+			0.0f, 0.0f, box.max.z - box.min.z, box.min.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	//Sets attribute pointers 0-2 for the layout on the currently bound VAO and GL_ARRAY_BUFFER
+	void setVertexAttributes(const VertexLayout& layout);
+
+	//IEEE half precision, rounded to nearest even
+	unsigned short floatToHalf(float f);
+}
@@ -0,0 +1,178 @@
+#include "weld.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace ew {
+	namespace {
+		struct CellEntry {
+			uint64_t key;
+			unsigned int vertex;
+			inline bool operator<(const CellEntry& rhs)const {
+				return key != rhs.key ? key < rhs.key : vertex < rhs.vertex;
+			}
+		};
+
+		//Cells are clamped to +-MAX_CELL, which is exactly representable as a float and fits in int64_t
+		constexpr float MAX_CELL = 4611686018427387904.0f; //2^62
+
+		//Grid cells are twice the tolerance, so a vertex is within tolerance of at most one neighbor cell per axis
+		struct Grid {
+			float cellSize;
+			int64_t cell(float v)const {
+				if (cellSize > 0.0f) {
+					//Large coordinates over a small tolerance overflow any integer (or reach infinity), so clamp before converting.
+					//Clamped vertices share a cell, which only adds candidates.
+					const float c = floorf(v / cellSize);
+					if (!(c > -MAX_CELL))
+						return -(int64_t)MAX_CELL;
+					return c < MAX_CELL ? (int64_t)c : (int64_t)MAX_CELL;
+				}
+				//Exact matching: the float itself is the cell. +0 and -0 are the same.
+				int32_t bits;
+				v = v == 0.0f ? 0.0f : v;
+				memcpy(&bits, &v, sizeof(bits));
+				return bits;
+			}
+		};
+
+		uint64_t cellKey(int64_t x, int64_t y, int64_t z) {
+			//Collisions only add candidates, every candidate is compared exactly
+			uint64_t h = (uint64_t)x * 0x9E3779B97F4A7C15ull;
+			h ^= (uint64_t)y * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+			h ^= (uint64_t)z * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+			return h;
+		}
+
+		constexpr unsigned int EMPTY_CELL = ~0u;
+
+		//Open addressing table from cell key to the cell's first entry in the sorted entry array
+		struct CellTable {
+			std::vector<uint64_t> keys;
+			std::vector<unsigned int> starts;
+			uint64_t mask = 0;
+
+			void build(const std::vector<CellEntry>& entries) {
+				size_t size = 16;
+				while (size < entries.size() * 2)
+					size *= 2;
+				keys.assign(size, 0);
+				starts.assign(size, EMPTY_CELL);
+				mask = size - 1;
+				for (size_t i = 0; i < entries.size(); i++)
+				{
+					if (i > 0 && entries[i].key == entries[i - 1].key)
+						continue;
+					uint64_t slot = entries[i].key & mask;
+					while (starts[slot] != EMPTY_CELL)
+						slot = (slot + 1) & mask;
+					keys[slot] = entries[i].key;
+					starts[slot] = (unsigned int)i;
+				}
+			}
+			//Returns EMPTY_CELL if no vertex is in the cell
+			unsigned int find(uint64_t key)const {
+				uint64_t slot = key & mask;
+				while (starts[slot] != EMPTY_CELL)
+				{
+					if (keys[slot] == key)
+						return starts[slot];
+					slot = (slot + 1) & mask;
+				}
+				return EMPTY_CELL;
+			}
+		};
+
+		bool within(const ew::Vec3& a, const ew::Vec3& b, float tolerance) {
+			return tolerance < 0.0f || (fabsf(a.x - b.x) <= tolerance && fabsf(a.y - b.y) <= tolerance && fabsf(a.z - b.z) <= tolerance);
+		}
+
+		bool within(const ew::Vec2& a, const ew::Vec2& b, float tolerance) {
+			return tolerance < 0.0f || (fabsf(a.x - b.x) <= tolerance && fabsf(a.y - b.y) <= tolerance);
+		}
+	}
+
+	std::vector<unsigned int> weldVertices(MeshData& mesh, const WeldTolerance& tolerance, unsigned int threadCount)
+	{
+		const size_t count = mesh.vertices.size();
+		std::vector<unsigned int> remap(count);
+		if (count == 0)
+			return remap;
+		const Vertex* vertices = mesh.vertices.data();
+		//A negative position tolerance would put everything in one cell
+		const float positionTolerance = tolerance.position > 0.0f ? tolerance.position : 0.0f;
+		const Grid grid = { positionTolerance * 2.0f };
+
+		std::vector<CellEntry> cells(count);
+		ew::parallelFor(count, threadCount, 4096, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				const ew::Vec3& p = vertices[i].pos;
+				cells[i] = { cellKey(grid.cell(p.x), grid.cell(p.y), grid.cell(p.z)), (unsigned int)i };
+			}
+		});
+		std::sort(cells.begin(), cells.end());
+		CellTable table;
+		table.build(cells);
+
+		//Lowest index within tolerance. Read only, so vertices are independent.
+		std::vector<unsigned int> match(count);
+		ew::parallelFor(count, threadCount, 4096, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				const Vertex& v = vertices[i];
+				int64_t lo[3], hi[3];
+				const float p[3] = { v.pos.x, v.pos.y, v.pos.z };
+				for (int axis = 0; axis < 3; axis++)
+				{
+					lo[axis] = grid.cell(p[axis] - positionTolerance);
+					hi[axis] = grid.cell(p[axis] + positionTolerance);
+				}
+				unsigned int best = (unsigned int)i;
+				for (int64_t x = lo[0]; x <= hi[0]; x++)
+				for (int64_t y = lo[1]; y <= hi[1]; y++)
+				for (int64_t z = lo[2]; z <= hi[2]; z++)
+				{
+					const uint64_t key = cellKey(x, y, z);
+					const unsigned int start = table.find(key);
+					if (start == EMPTY_CELL)
+						continue;
+					//Entries in a cell are sorted by vertex, so stop at the first one that can't improve best
+					for (auto it = cells.begin() + start; it != cells.end() && it->key == key && it->vertex < best; ++it)
+					{
+						const Vertex& c = vertices[it->vertex];
+						if (within(v.pos, c.pos, positionTolerance) && within(v.normal, c.normal, tolerance.normal) && within(v.uv, c.uv, tolerance.uv)) {
+							best = it->vertex;
+							break;
+						}
+					}
+				}
+				match[i] = best;
+			}
+		});
+
+		//Matches always point to lower indices, so one forward pass resolves chains to their first vertex
+		std::vector<Vertex> welded;
+		welded.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			if (match[i] == i) {
+				remap[i] = (unsigned int)welded.size();
+				welded.push_back(vertices[i]);
+			}
+			else {
+				remap[i] = remap[match[i]];
+			}
+		}
+
+		ew::parallelFor(mesh.indices.size(), threadCount, 4096, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				mesh.indices[i] = remap[mesh.indices[i]];
+			}
+		});
+		mesh.vertices.swap(welded);
+		return remap;
+	}
+}
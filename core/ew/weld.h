@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+
+namespace ew {
+	//Largest per component difference for two vertices to merge. A negative tolerance ignores that attribute,
+	//e.g. uv = -1 welds across UV seams and keeps the first vertex's UVs.
+	struct WeldTolerance {
+		float position = 1e-5f;
+		float normal = 1e-3f;
+		float uv = 1e-5f;
+	};
+
+	/// <summary>
+	/// Merges vertices whose attributes match within tolerance, keeping the lowest index of each group,
+	/// and rewrites the indices of every LOD. Candidates are found through a hash grid of positions,
+	/// so it runs in about linear time. Split over threadCount threads (0 = one per hardware thread).
+	/// Bounds stay valid since surviving vertices keep their positions.
+	/// </summary>
+	/// <returns>Remap table: new index of every original vertex</returns>
+	std::vector<unsigned int> weldVertices(MeshData& mesh, const WeldTolerance& tolerance = WeldTolerance(), unsigned int threadCount = 0);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdio.h>
+
+//Minimal assertions for the test executables. Each test's main() returns testResult(), which ctest reads as pass/fail.
+namespace test {
+	inline int& failureCount() {
+		static int count = 0;
+		return count;
+	}
+	inline int testResult() {
+		if (failureCount() == 0)
+			printf("PASSED\n");
+		else
+			printf("FAILED: %d check(s)\n", failureCount());
+		return failureCount() == 0 ? 0 : 1;
+	}
+}
+
+//Records a failure with a printf style message when cond is false, and keeps going
+#define EW_CHECK(cond, ...) \
+	do { \
+		if (!(cond)) { \
+			printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+			test::failureCount()++; \
+		} \
+	} while (0)
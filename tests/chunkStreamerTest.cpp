@@ -0,0 +1,134 @@
+//Streams chunks into a MeshPool while the camera moves and checks that every resident chunk in range is drawn.
+//Needs an OpenGL 4.3 context like meshPoolTest, but draws nothing. Returns 77 (skipped) without one.
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <ew/external/glad.h>
+#include <GLFW/glfw3.h>
+#include <ew/chunkStreamer.h>
+#include "check.h"
+
+namespace {
+	const int SKIPPED = 77;
+	const float LOAD_RADIUS = 2.5f;
+
+	//Unit quad on top of the chunk
+	ew::MeshData createChunkQuad(ew::ChunkCoord chunk) {
+		ew::MeshData mesh;
+		const float x = (float)chunk.x;
+		const float z = (float)chunk.z;
+		const ew::Vec3 corners[4] = { ew::Vec3(x, 0.0f, z), ew::Vec3(x + 1.0f, 0.0f, z), ew::Vec3(x + 1.0f, 0.0f, z + 1.0f), ew::Vec3(x, 0.0f, z + 1.0f) };
+		for (const ew::Vec3& p : corners) {
+			ew::Vertex v;
+			v.pos = p;
+			v.normal = ew::Vec3(0.0f, 1.0f, 0.0f);
+			mesh.vertices.push_back(v);
+		}
+		mesh.indices = { 0, 2, 1, 0, 3, 2 };
+		return mesh;
+	}
+
+	//Planes with no normal put every point in front, so nothing is culled
+	ew::Frustum everything() {
+		ew::Frustum frustum;
+		for (ew::Plane& plane : frustum.planes) {
+			plane.normal = ew::Vec3(0.0f);
+			plane.d = 1.0f;
+		}
+		return frustum;
+	}
+
+	//Chunks with centers within LOAD_RADIUS of the camera on XZ, counted the same way the streamer picks them
+	int chunksInRange(const ew::Vec3& camera) {
+		int count = 0;
+		for (int z = -8; z <= 8; z++)
+		{
+			for (int x = -8; x <= 8; x++)
+			{
+				const float dx = (float)x + 0.5f - camera.x;
+				const float dz = (float)z + 0.5f - camera.z;
+				if (dx * dx + dz * dz <= LOAD_RADIUS * LOAD_RADIUS)
+					count++;
+			}
+		}
+		return count;
+	}
+
+	//Updates until nothing is generating or staged except up to allowedGenerating chunks
+	bool settle(ew::ChunkStreamer& streamer, const ew::Vec3& camera, size_t allowedGenerating) {
+		for (int i = 0; i < 2000; i++)
+		{
+			streamer.update(camera);
+			const ew::ChunkStreamerStats& stats = streamer.getStats();
+			if (stats.generatingChunks <= allowedGenerating && stats.stagedChunks == 0 && i > 0)
+				return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+}
+
+int main() {
+	if (!glfwInit()) {
+		printf("SKIPPED: GLFW failed to init\n");
+		return SKIPPED;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(16, 16, "chunkStreamerTest", NULL, NULL);
+	if (window == NULL) {
+		printf("SKIPPED: no OpenGL 4.3 context\n");
+		glfwTerminate();
+		return SKIPPED;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGL(glfwGetProcAddress)) {
+		printf("FAILED: GLAD failed to load GL headers\n");
+		return 1;
+	}
+
+	{
+		//Chunk (0, 2) takes until release is set, so it finishes after the camera has moved away from it
+		std::atomic<bool> release(false);
+		ew::MeshPool pool(4096, 8192);
+		ew::ChunkStreamerSettings settings;
+		settings.chunkSize = 1.0f;
+		settings.loadRadius = LOAD_RADIUS;
+		settings.workerCount = 2;
+		settings.maxJobsInFlight = 64;
+		ew::ChunkStreamer streamer(pool, [&release](ew::ChunkCoord chunk) {
+			if (chunk.x == 0 && chunk.z == 2) {
+				while (!release)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			return createChunkQuad(chunk);
+		}, settings);
+		const ew::Frustum frustum = everything();
+
+		const ew::Vec3 start = ew::Vec3(0.5f, 0.0f, 0.5f);
+		EW_CHECK(settle(streamer, start, 1), "chunks around the start never finished loading");
+		pool.beginDraws();
+		EW_CHECK((int)streamer.addDraws(frustum) == chunksInRange(start) - 1, "%zu draws at the start, expected %d",
+			pool.getDrawCount(), chunksInRange(start) - 1);
+
+		//Back one chunk: (0, 2) is now past loadRadius but inside the drop margin, so it is uploaded and kept.
+		//Released once everything else has loaded, so the last update is the one that uploads it.
+		const ew::Vec3 moved = ew::Vec3(0.5f, 0.0f, -0.5f);
+		EW_CHECK(settle(streamer, moved, 1), "chunks never finished loading after the move");
+		release = true;
+		EW_CHECK(settle(streamer, moved, 0), "chunk (0, 2) never finished loading");
+		//The in range chunks plus those left behind, (0, 2) among them
+		EW_CHECK(streamer.getStats().residentChunks > (size_t)chunksInRange(moved), "%zu resident chunks", streamer.getStats().residentChunks);
+		pool.beginDraws();
+		const size_t draws = streamer.addDraws(frustum);
+		EW_CHECK((int)draws == chunksInRange(moved), "drew %zu of %d chunks in range", draws, chunksInRange(moved));
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return test::testResult();
+}
@@ -0,0 +1,131 @@
+//.ewmesh files written by writeMeshFile must open, and files whose draws reach outside their buffers must not
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <ew/meshFile.h>
+#include <ew/procGen.h>
+#include <ew/lod.h>
+#include <ew/meshlet.h>
+#include "check.h"
+
+namespace {
+	std::vector<unsigned char> readFile(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	void writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+		std::ofstream file(path, std::ios::binary);
+		file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+	}
+
+	ew::MeshFileHeader header(const std::vector<unsigned char>& bytes) {
+		ew::MeshFileHeader h;
+		memcpy(&h, bytes.data(), sizeof(h));
+		return h;
+	}
+
+	bool opens(const std::string& path) {
+		ew::MappedMeshFile file;
+		return file.open(path);
+	}
+
+	//Writes a copy of the file with edit applied and checks that it is rejected
+	template<typename Edit>
+	void checkRejected(const char* what, const std::vector<unsigned char>& original, Edit edit) {
+		std::vector<unsigned char> bytes = original;
+		edit(bytes);
+		const std::string path = "meshFileTest_corrupt.ewmesh";
+		writeFile(path, bytes);
+		EW_CHECK(!opens(path), "file with %s was accepted", what);
+		remove(path.c_str());
+	}
+
+	template<typename T>
+	void put(std::vector<unsigned char>& bytes, uint64_t offset, T value) {
+		memcpy(bytes.data() + offset, &value, sizeof(value));
+	}
+}
+
+int main() {
+	const std::string plainPath = "meshFileTest_plain.ewmesh";
+	const std::string lodPath = "meshFileTest_lod.ewmesh";
+	const std::string rangePath = "meshFileTest_ranges.ewmesh";
+
+	ew::MeshData plain = ew::createSphere(1.0f, 64);
+	ew::MeshData lod = plain;
+	ew::generateLODChain(lod);
+	ew::buildMeshlets(lod);
+	//Over 64K vertices with enough indices per range to be split into 16 bit ranges
+	ew::MeshData ranges = ew::createPlane(1.0f, 1.0f, 400);
+	EW_CHECK(ew::writeMeshFile(plainPath, plain) && ew::writeMeshFile(lodPath, lod) && ew::writeMeshFile(rangePath, ranges), "write failed");
+
+	EW_CHECK(opens(plainPath), "plain mesh rejected");
+	EW_CHECK(opens(lodPath), "mesh with LODs and meshlets rejected");
+	EW_CHECK(opens(rangePath), "mesh with index ranges rejected");
+
+	const std::vector<unsigned char> plainBytes = readFile(plainPath);
+	const std::vector<unsigned char> lodBytes = readFile(lodPath);
+	const std::vector<unsigned char> rangeBytes = readFile(rangePath);
+	const ew::MeshFileHeader plainHeader = header(plainBytes);
+	const ew::MeshFileHeader lodHeader = header(lodBytes);
+	const ew::MeshFileHeader rangeHeader = header(rangeBytes);
+	EW_CHECK(lodHeader.lodCount > 1 && lodHeader.meshletCount > 0, "%u LODs, %u meshlets", lodHeader.lodCount, lodHeader.meshletCount);
+	EW_CHECK(rangeHeader.indexRangeCount > 1, "%u index ranges", rangeHeader.indexRangeCount);
+
+	checkRejected("a truncated file", plainBytes, [](std::vector<unsigned char>& b) { b.resize(b.size() - 64); });
+	checkRejected("a misaligned LOD table", lodBytes, [&](std::vector<unsigned char>& b) {
+		put(b, offsetof(ew::MeshFileHeader, lodOffset), lodHeader.lodOffset + 4);
+	});
+	checkRejected("an index past the last vertex", plainBytes, [&](std::vector<unsigned char>& b) {
+		//createSphere(1, 64) has under 64K vertices, so indices are 16 bit
+		put(b, plainHeader.indexOffset + 2 * 7, (uint16_t)plainHeader.vertexCount);
+	});
+	checkRejected("a LOD past the last index", lodBytes, [&](std::vector<unsigned char>& b) {
+		ew::MeshLOD last;
+		const uint64_t offset = lodHeader.lodOffset + sizeof(ew::MeshLOD) * (lodHeader.lodCount - 1);
+		memcpy(&last, b.data() + offset, sizeof(last));
+		last.indexCount = lodHeader.indexCount - last.firstIndex + 3;
+		put(b, offset, last);
+	});
+	checkRejected("a meshlet starting past the last index", lodBytes, [&](std::vector<unsigned char>& b) {
+		put(b, lodHeader.meshletOffset + offsetof(ew::Meshlet, firstIndex), lodHeader.indexCount + 3);
+	});
+	checkRejected("a range past the last index", rangeBytes, [&](std::vector<unsigned char>& b) {
+		put(b, rangeHeader.indexRangeOffset + offsetof(ew::IndexRange, count), rangeHeader.indexCount + 1);
+	});
+	checkRejected("a range base vertex past the last vertex", rangeBytes, [&](std::vector<unsigned char>& b) {
+		const uint64_t offset = rangeHeader.indexRangeOffset + sizeof(ew::IndexRange) * (rangeHeader.indexRangeCount - 1) + offsetof(ew::IndexRange, baseVertex);
+		int baseVertex;
+		memcpy(&baseVertex, b.data() + offset, sizeof(baseVertex));
+		put(b, offset, baseVertex + 1000);
+	});
+	checkRejected("a negative range base vertex", rangeBytes, [&](std::vector<unsigned char>& b) {
+		put(b, rangeHeader.indexRangeOffset + offsetof(ew::IndexRange, baseVertex), -1000);
+	});
+
+#ifndef _WIN32
+	//Rewriting a mapped file replaces it rather than truncating it, so the old mapping keeps the old mesh
+	{
+		ew::MappedMeshFile mapped;
+		EW_CHECK(mapped.open(plainPath), "plain mesh rejected");
+		const std::vector<unsigned char> before((const unsigned char*)mapped.getView().vertexData,
+			(const unsigned char*)mapped.getView().vertexData + mapped.getView().vertexCount * mapped.getView().layout.stride());
+		EW_CHECK(ew::writeMeshFile(plainPath, ranges), "rewrite failed");
+		EW_CHECK(memcmp(before.data(), mapped.getView().vertexData, before.size()) == 0, "mapped vertices changed by the rewrite");
+		ew::MappedMeshFile reopened;
+		EW_CHECK(reopened.open(plainPath) && reopened.getView().vertexCount == ranges.vertices.size(), "rewritten file not replaced");
+		EW_CHECK(readFile(plainPath) == rangeBytes, "rewritten file differs from a fresh write");
+	}
+#endif
+
+	remove(plainPath.c_str());
+	remove(lodPath.c_str());
+	remove(rangePath.c_str());
+	return test::testResult();
+}
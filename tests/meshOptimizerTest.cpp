@@ -0,0 +1,124 @@
+//optimizeMesh must only reorder: the same triangles with the same winding, fewer cache misses, and unreferenced vertices kept
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <ew/meshOptimizer.h>
+#include <ew/procGen.h>
+#include "check.h"
+
+namespace {
+	//Everything a vertex holds, so vertices that only differ by UV (seams) stay distinct
+	typedef std::vector<float> VertexKey;
+	typedef std::vector<VertexKey> TriangleKey;
+
+	VertexKey vertexKey(const ew::Vertex& v) {
+		return { v.pos.x, v.pos.y, v.pos.z, v.normal.x, v.normal.y, v.normal.z, v.uv.x, v.uv.y };
+	}
+
+	//Triangles by vertex contents, each rotated to start at its smallest vertex so winding is kept but the starting corner isn't
+	std::vector<TriangleKey> triangleSet(const ew::MeshData& mesh) {
+		std::vector<TriangleKey> triangles;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			TriangleKey t = { vertexKey(mesh.vertices[mesh.indices[i]]), vertexKey(mesh.vertices[mesh.indices[i + 1]]), vertexKey(mesh.vertices[mesh.indices[i + 2]]) };
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			triangles.push_back(t);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	bool indicesInRange(const ew::MeshData& mesh) {
+		for (unsigned int index : mesh.indices)
+		{
+			if (index >= mesh.vertices.size())
+				return false;
+		}
+		return true;
+	}
+
+	//Same triangles in random order, with each triangle's starting corner kept
+	void shuffleTriangles(ew::MeshData& mesh, unsigned int seed) {
+		std::vector<unsigned int> order(mesh.indices.size() / 3);
+		for (size_t t = 0; t < order.size(); t++)
+			order[t] = (unsigned int)t;
+		std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+		std::vector<unsigned int> indices;
+		indices.reserve(mesh.indices.size());
+		for (unsigned int t : order)
+			indices.insert(indices.end(), mesh.indices.begin() + t * 3, mesh.indices.begin() + t * 3 + 3);
+		mesh.indices.swap(indices);
+	}
+}
+
+int main() {
+	//Shuffling destroys the sphere's locality, so the optimizer has something to win back
+	{
+		ew::MeshData mesh = ew::createSphere(1.0f, 64);
+		shuffleTriangles(mesh, 1234);
+		const std::vector<TriangleKey> before = triangleSet(mesh);
+		const size_t vertexCount = mesh.vertices.size();
+		const ew::MeshOptimizeStats stats = ew::optimizeMesh(mesh);
+		EW_CHECK(mesh.vertices.size() == vertexCount && indicesInRange(mesh), "vertices added, lost or indexed out of range");
+		EW_CHECK(triangleSet(mesh) == before, "triangle set changed");
+		EW_CHECK(stats.after.acmr < stats.before.acmr * 0.5f, "ACMR %.3f -> %.3f", stats.before.acmr, stats.after.acmr);
+		const ew::VertexCacheStats measured = ew::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		EW_CHECK(measured.acmr == stats.after.acmr, "reported ACMR %.3f, measured %.3f", stats.after.acmr, measured.acmr);
+		//Vertex fetch order: vertices appear in the order indices first use them
+		unsigned int next = 0;
+		for (unsigned int index : mesh.indices)
+		{
+			if (index == next)
+				next++;
+			else if (index > next) {
+				EW_CHECK(false, "vertex %u used before vertex %u", index, next);
+				break;
+			}
+		}
+	}
+
+	//Every other vertex unreferenced, on top of any the sphere leaves unused: all are kept, after the referenced ones
+	{
+		const ew::MeshData sphere = ew::createSphere(1.0f, 16);
+		ew::MeshData mesh;
+		for (const ew::Vertex& v : sphere.vertices)
+		{
+			ew::Vertex unused = v;
+			unused.pos = ew::Vec3(100.0f);
+			mesh.vertices.push_back(unused);
+			mesh.vertices.push_back(v);
+		}
+		for (unsigned int index : sphere.indices)
+			mesh.indices.push_back(index * 2 + 1);
+		shuffleTriangles(mesh, 99);
+		std::vector<unsigned int> referenced = mesh.indices;
+		std::sort(referenced.begin(), referenced.end());
+		const size_t referencedCount = std::unique(referenced.begin(), referenced.end()) - referenced.begin();
+		const std::vector<TriangleKey> before = triangleSet(mesh);
+		std::vector<VertexKey> verticesBefore;
+		for (const ew::Vertex& v : mesh.vertices)
+			verticesBefore.push_back(vertexKey(v));
+		std::sort(verticesBefore.begin(), verticesBefore.end());
+
+		ew::optimizeMesh(mesh);
+		EW_CHECK(indicesInRange(mesh), "index out of range");
+		EW_CHECK(triangleSet(mesh) == before, "triangle set changed with unreferenced vertices");
+		std::vector<VertexKey> verticesAfter;
+		for (const ew::Vertex& v : mesh.vertices)
+			verticesAfter.push_back(vertexKey(v));
+		std::sort(verticesAfter.begin(), verticesAfter.end());
+		EW_CHECK(verticesAfter == verticesBefore, "vertices added or lost");
+		const unsigned int maxIndex = *std::max_element(mesh.indices.begin(), mesh.indices.end());
+		EW_CHECK(maxIndex + 1 == referencedCount, "highest index %u with %zu referenced vertices", maxIndex, referencedCount);
+	}
+
+	//Only unreferenced vertices, and no triangles at all
+	{
+		ew::MeshData mesh;
+		mesh.vertices.resize(5);
+		ew::optimizeMesh(mesh);
+		EW_CHECK(mesh.vertices.size() == 5 && mesh.indices.empty(), "mesh without triangles changed");
+	}
+	return test::testResult();
+}
@@ -0,0 +1,176 @@
+//Draws several pooled meshes with one glMultiDrawElementsIndirect into a small offscreen target and checks the pixels.
+//Runs headless on Mesa llvmpipe: LIBGL_ALWAYS_SOFTWARE=1 (set by ctest). Without any display, run under xvfb-run.
+//Returns 77 (skipped) when no OpenGL 4.3 context can be created.
+
+#include <stdio.h>
+#include <vector>
+#include <ew/external/glad.h>
+#include <GLFW/glfw3.h>
+#include <ew/meshPool.h>
+#include <ew/ewMath/transformations.h>
+#include "check.h"
+
+namespace {
+	const int TARGET_SIZE = 64;
+	const int SKIPPED = 77;
+
+	const char* VERTEX_SHADER = R"(#version 430
+layout(location = 0) in vec3 vPos;
+layout(location = 3) in uint _DrawID;
+struct DrawData { mat4 model; mat4 normalMatrix; };
+layout(std430, binding = 0) readonly buffer DrawBuffer { DrawData _Draws[]; };
+flat out uint drawID;
+void main(){
+	drawID = _DrawID;
+	gl_Position = _Draws[_DrawID].model * vec4(vPos, 1.0);
+}
+)";
+	//Each draw writes its own index into red, so the pixels show which draw covered them
+	const char* FRAGMENT_SHADER = R"(#version 430
+flat in uint drawID;
+out vec4 FragColor;
+void main(){
+	FragColor = vec4(float(drawID + 1u) * 0.2, 0.0, 0.0, 1.0);
+}
+)";
+
+	unsigned int compileProgram() {
+		const char* sources[2] = { VERTEX_SHADER, FRAGMENT_SHADER };
+		const GLenum stages[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+		unsigned int program = glCreateProgram();
+		for (int i = 0; i < 2; i++)
+		{
+			unsigned int shader = glCreateShader(stages[i]);
+			glShaderSource(shader, 1, &sources[i], NULL);
+			glCompileShader(shader);
+			int success;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+			if (!success) {
+				char infoLog[512];
+				glGetShaderInfoLog(shader, 512, NULL, infoLog);
+				printf("Failed to compile shader: %s", infoLog);
+			}
+			glAttachShader(program, shader);
+			glDeleteShader(shader);
+		}
+		glLinkProgram(program);
+		return program;
+	}
+
+	//Square of side 1 centered on the origin, split into subdivisions^2 quads
+	ew::MeshData createSquare(int subdivisions) {
+		ew::MeshData mesh;
+		for (int y = 0; y <= subdivisions; y++)
+		{
+			for (int x = 0; x <= subdivisions; x++)
+			{
+				ew::Vertex v;
+				v.pos = ew::Vec3((float)x / subdivisions - 0.5f, (float)y / subdivisions - 0.5f, 0.0f);
+				v.normal = ew::Vec3(0.0f, 0.0f, 1.0f);
+				v.uv = ew::Vec2((float)x / subdivisions, (float)y / subdivisions);
+				mesh.vertices.push_back(v);
+			}
+		}
+		for (int y = 0; y < subdivisions; y++)
+		{
+			for (int x = 0; x < subdivisions; x++)
+			{
+				const unsigned int i = y * (subdivisions + 1) + x;
+				const unsigned int quad[6] = { i, i + 1, i + subdivisions + 2, i, i + subdivisions + 2, i + subdivisions + 1 };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	//Red channel at a pixel of the bound framebuffer
+	int redAt(int x, int y) {
+		unsigned char pixel[4];
+		glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+		return pixel[0];
+	}
+}
+
+int main() {
+	if (!glfwInit()) {
+		printf("SKIPPED: GLFW failed to init\n");
+		return SKIPPED;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(TARGET_SIZE, TARGET_SIZE, "meshPoolTest", NULL, NULL);
+	if (window == NULL) {
+		printf("SKIPPED: no OpenGL 4.3 context\n");
+		glfwTerminate();
+		return SKIPPED;
+	}
+	glfwMakeContextCurrent(window);
+	if (!gladLoadGL(glfwGetProcAddress)) {
+		printf("FAILED: GLAD failed to load GL headers\n");
+		return 1;
+	}
+	printf("%s\n", (const char*)glGetString(GL_RENDERER));
+
+	//Hidden windows may have no pixels, so render to a texture
+	unsigned int color, fbo;
+	glGenTextures(1, &color);
+	glBindTexture(GL_TEXTURE_2D, color);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TARGET_SIZE, TARGET_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+	EW_CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "framebuffer incomplete");
+	glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+	const unsigned int program = compileProgram();
+
+	{
+		ew::MeshPool pool(64, 256);
+		const int a = pool.add(createSquare(1));
+		const int removed = pool.add(createSquare(2));
+		const int b = pool.add(createSquare(3));
+		EW_CHECK(a >= 0 && removed >= 0 && b >= 0, "add failed: %d %d %d", a, removed, b);
+		//Frees a range between two live meshes, which the next mesh partly reuses
+		pool.remove(removed);
+		const int c = pool.add(createSquare(1));
+		EW_CHECK(c >= 0, "add into a freed range failed");
+		EW_CHECK(pool.get(c).baseVertex == pool.get(a).vertexCount, "freed range not reused: baseVertex %u", pool.get(c).baseVertex);
+		//40 vertices are free, but split into ranges of 5 and 35
+		EW_CHECK(pool.add(createSquare(5)) == -1, "36 vertices fit in a fragmented pool");
+
+		//One draw per quadrant, half the target in size, with the first mesh drawn twice
+		const ew::Vec3 quadrants[4] = { ew::Vec3(-0.5f, -0.5f, 0.0f), ew::Vec3(0.5f, -0.5f, 0.0f), ew::Vec3(-0.5f, 0.5f, 0.0f), ew::Vec3(0.5f, 0.5f, 0.0f) };
+		const int handles[4] = { a, b, c, a };
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glUseProgram(program);
+		pool.beginDraws();
+		for (int i = 0; i < 4; i++)
+		{
+			pool.addDraw(handles[i], ew::Translate(quadrants[i]) * ew::Scale(ew::Vec3(0.5f)));
+		}
+		EW_CHECK(pool.getDrawCount() == 4, "%zu draws recorded", pool.getDrawCount());
+		pool.submit();
+		glFinish();
+		EW_CHECK(glGetError() == GL_NO_ERROR, "GL error after submit");
+
+		//Quadrant centers show their draw, the gaps between quads show the clear color
+		const int centers[4][2] = { { 16, 16 }, { 48, 16 }, { 16, 48 }, { 48, 48 } };
+		for (int i = 0; i < 4; i++)
+		{
+			const int expected = (int)((i + 1) * 0.2f * 255.0f + 0.5f);
+			const int red = redAt(centers[i][0], centers[i][1]);
+			EW_CHECK(red >= expected - 1 && red <= expected + 1, "draw %d: red %d, expected %d", i, red, expected);
+		}
+		EW_CHECK(redAt(32, 32) == 0, "center is covered");
+		EW_CHECK(redAt(2, 2) == 0, "corner is covered");
+	}
+
+	glDeleteProgram(program);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(1, &color);
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return test::testResult();
+}
@@ -0,0 +1,137 @@
+//buildMeshlets must put every triangle in exactly one meshlet within the limits, and cullMeshlets must drop back facing clusters
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+#include <ew/meshlet.h>
+#include <ew/procGen.h>
+#include "check.h"
+
+namespace {
+	typedef std::vector<unsigned int> Triangle;
+
+	//Triangles by index, each rotated to start at its smallest index so winding is kept but the starting corner isn't
+	std::vector<Triangle> triangleSet(const unsigned int* indices, size_t indexCount) {
+		std::vector<Triangle> triangles;
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			Triangle t = { indices[i], indices[i + 1], indices[i + 2] };
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			triangles.push_back(t);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	void checkMeshlets(const char* name, const ew::MeshData& original, unsigned int threadCount) {
+		ew::MeshData mesh = original;
+		ew::buildMeshlets(mesh, threadCount);
+		EW_CHECK(triangleSet(mesh.indices.data(), mesh.indices.size()) == triangleSet(original.indices.data(), original.indices.size()),
+			"%s: triangles changed", name);
+		EW_CHECK(!mesh.meshlets.empty(), "%s: no meshlets", name);
+
+		//Meshlets tile the index buffer: each starts where the previous one ended, so no triangle is missed or repeated
+		unsigned int next = 0;
+		for (size_t i = 0; i < mesh.meshlets.size(); i++)
+		{
+			const ew::Meshlet& m = mesh.meshlets[i];
+			if (m.firstIndex != next || m.indexCount == 0 || m.indexCount % 3 != 0) {
+				EW_CHECK(false, "%s: meshlet %zu covers [%u, %u), expected to start at %u", name, i, m.firstIndex, m.firstIndex + m.indexCount, next);
+				return;
+			}
+			next += m.indexCount;
+
+			std::vector<unsigned int> vertices(mesh.indices.begin() + m.firstIndex, mesh.indices.begin() + m.firstIndex + m.indexCount);
+			std::sort(vertices.begin(), vertices.end());
+			const size_t vertexCount = std::unique(vertices.begin(), vertices.end()) - vertices.begin();
+			EW_CHECK(vertexCount <= ew::MESHLET_MAX_VERTICES && m.indexCount / 3 <= ew::MESHLET_MAX_TRIANGLES,
+				"%s: meshlet %zu has %zu vertices and %u triangles", name, i, vertexCount, m.indexCount / 3);
+
+			//Bounds hold every vertex and the cone holds every face normal
+			const float coneDot = sqrtf(1.0f - m.coneCutoff * m.coneCutoff);
+			for (unsigned int t = m.firstIndex; t < m.firstIndex + m.indexCount; t += 3)
+			{
+				const ew::Vec3& p0 = mesh.vertices[mesh.indices[t]].pos;
+				const ew::Vec3& p1 = mesh.vertices[mesh.indices[t + 1]].pos;
+				const ew::Vec3& p2 = mesh.vertices[mesh.indices[t + 2]].pos;
+				for (const ew::Vec3* p : { &p0, &p1, &p2 })
+				{
+					EW_CHECK(ew::Magnitude(*p - m.center) <= m.radius * 1.0001f + 1e-6f, "%s: vertex outside meshlet %zu", name, i);
+				}
+				const ew::Vec3 n = ew::Cross(p1 - p0, p2 - p0);
+				const float length = ew::Magnitude(n);
+				if (m.coneCutoff < 1.0f && length > 0.0f)
+					EW_CHECK(ew::Dot(n / length, m.coneAxis) >= coneDot - 1e-4f, "%s: face normal outside the cone of meshlet %zu", name, i);
+			}
+		}
+		EW_CHECK(next == mesh.indices.size(), "%s: meshlets cover %u of %zu indices", name, next, mesh.indices.size());
+	}
+
+	//Unit square on z = 0 facing +z, split into size x size quads
+	ew::MeshData createPatch(int size) {
+		ew::MeshData mesh;
+		for (int y = 0; y <= size; y++)
+		{
+			for (int x = 0; x <= size; x++)
+			{
+				ew::Vertex v;
+				v.pos = ew::Vec3((float)x / size - 0.5f, (float)y / size - 0.5f, 0.0f);
+				v.normal = ew::Vec3(0.0f, 0.0f, 1.0f);
+				mesh.vertices.push_back(v);
+			}
+		}
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const unsigned int i = (unsigned int)(y * (size + 1) + x);
+				const unsigned int up = i + (unsigned int)size + 1;
+				mesh.indices.insert(mesh.indices.end(), { i, i + 1, up + 1, i, up + 1, up });
+			}
+		}
+		return mesh;
+	}
+
+	size_t visibleMeshlets(const ew::MeshData& mesh, const ew::Camera& camera) {
+		std::vector<unsigned int> visible(mesh.meshlets.size());
+		return ew::cullMeshlets(mesh.meshlets.data(), mesh.meshlets.size(), ew::IdentityMatrix(), camera, visible.data());
+	}
+}
+
+int main() {
+	for (unsigned int threads : { 1u, 0u })
+	{
+		checkMeshlets("sphere", ew::createSphere(1.0f, 64), threads);
+		//Over 16K triangles, so it is built in several chunks
+		checkMeshlets("plane", ew::createPlane(1.0f, 1.0f, 200), threads);
+	}
+
+	//A flat patch is culled from behind and kept from the front, in perspective and orthographic
+	{
+		ew::MeshData patch = createPatch(12);
+		ew::buildMeshlets(patch);
+		EW_CHECK(patch.meshlets.size() > 1, "%zu meshlets in the patch", patch.meshlets.size());
+		for (bool orthographic : { false, true })
+		{
+			ew::Camera camera;
+			camera.orthographic = orthographic;
+			camera.position = ew::Vec3(0.0f, 0.0f, 5.0f);
+			const size_t front = visibleMeshlets(patch, camera);
+			EW_CHECK(front == patch.meshlets.size(), "%zu of %zu meshlets visible from the front", front, patch.meshlets.size());
+			camera.position = ew::Vec3(0.0f, 0.0f, -5.0f);
+			const size_t back = visibleMeshlets(patch, camera);
+			EW_CHECK(back == 0, "%zu of %zu meshlets visible from behind", back, patch.meshlets.size());
+		}
+	}
+
+	//From outside a sphere the far side is culled, but not the near side
+	{
+		ew::MeshData sphere = ew::createSphere(1.0f, 64);
+		ew::buildMeshlets(sphere);
+		ew::Camera camera;
+		camera.position = ew::Vec3(0.0f, 0.0f, 5.0f);
+		const size_t visible = visibleMeshlets(sphere, camera);
+		EW_CHECK(visible > 0 && visible < sphere.meshlets.size(), "%zu of %zu sphere meshlets visible", visible, sphere.meshlets.size());
+	}
+	return test::testResult();
+}
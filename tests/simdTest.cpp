@@ -0,0 +1,242 @@
+//Compares every SIMD backend the CPU supports against the scalar reference kernels
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <ew/ewMath/ewMath.h>
+#include <ew/ewMath/transformations.h>
+#include "check.h"
+
+namespace {
+	//Sums are reassociated differently per backend, so error is measured in ULPs of the sum of |terms|
+	//rather than of the result, which can be arbitrarily small after cancellation.
+	const float MAX_ULPS = 4.0f;
+
+	float ulp(float x) {
+		x = fabsf(x);
+		return nextafterf(x, INFINITY) - x;
+	}
+
+	float randomFloat() {
+		return (float)rand() / (float)RAND_MAX * 20.0f - 10.0f;
+	}
+
+	ew::Mat4 randomMat4() {
+		ew::Mat4 m;
+		for (int c = 0; c < 4; c++)
+		{
+			for (int r = 0; r < 4; r++)
+			{
+				m.at(c, r) = randomFloat();
+			}
+		}
+		return m;
+	}
+
+	//Error of got vs expected in ULPs of the dot product's magnitude sum(|a[i] * b[i]|)
+	float dotUlps(float got, float expected, const float a[4], const float b[4]) {
+		float magnitude = 0.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			magnitude += fabsf(a[i] * b[i]);
+		}
+		if (got == expected)
+			return 0.0f;
+		return fabsf(got - expected) / ulp(magnitude);
+	}
+
+	void testLevel(ew::SimdLevel level) {
+		const char* name = ew::SimdLevelName(level);
+		float maxMulUlps = 0.0f;
+		float maxVecUlps = 0.0f;
+		int bitExact = 0;
+		const int iterations = 100000;
+		for (int n = 0; n < iterations; n++)
+		{
+			const ew::Mat4 l = randomMat4();
+			const ew::Mat4 r = randomMat4();
+			const ew::Vec4 v = ew::Vec4(randomFloat(), randomFloat(), randomFloat(), randomFloat());
+
+			const ew::Mat4 m = l * r;
+			const ew::Mat4 expected = ew::MulScalar(l, r);
+			bitExact += memcmp(&m, &expected, sizeof(m)) == 0 ? 1 : 0;
+			for (int c = 0; c < 4; c++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					const float lRow[4] = { l.at(0, row), l.at(1, row), l.at(2, row), l.at(3, row) };
+					const float rCol[4] = { r.at(c, 0), r.at(c, 1), r.at(c, 2), r.at(c, 3) };
+					maxMulUlps = fmaxf(maxMulUlps, dotUlps(m.at(c, row), expected.at(c, row), lRow, rCol));
+				}
+			}
+
+			const ew::Vec4 mv = l * v;
+			const ew::Vec4 expectedV = ew::MulScalar(l, v);
+			for (int row = 0; row < 4; row++)
+			{
+				const float lRow[4] = { l.at(0, row), l.at(1, row), l.at(2, row), l.at(3, row) };
+				const float vec[4] = { v.x, v.y, v.z, v.w };
+				maxVecUlps = fmaxf(maxVecUlps, dotUlps(mv[row], expectedV[row], lRow, vec));
+			}
+		}
+		printf("%-7s Mat4*Mat4 max %.2f ulp (%d/%d bit exact), Mat4*Vec4 max %.2f ulp\n", name, maxMulUlps, bitExact, iterations, maxVecUlps);
+		EW_CHECK(maxMulUlps <= MAX_ULPS, "%s Mat4*Mat4 off by %.2f ulp", name, maxMulUlps);
+		EW_CHECK(maxVecUlps <= MAX_ULPS, "%s Mat4*Vec4 off by %.2f ulp", name, maxVecUlps);
+
+		//Kernels allow out to alias an input
+		const ew::Mat4 l = randomMat4();
+		const ew::Mat4 r = randomMat4();
+		ew::Mat4 aliased = l;
+		ew::simd::Mat4Mul(&aliased.at(0, 0), &r.at(0, 0), &aliased.at(0, 0));
+		const ew::Mat4 separate = l * r;
+		EW_CHECK(memcmp(&aliased, &separate, sizeof(aliased)) == 0, "%s Mat4Mul with out == l differs", name);
+		aliased = r;
+		ew::simd::Mat4Mul(&l.at(0, 0), &aliased.at(0, 0), &aliased.at(0, 0));
+		EW_CHECK(memcmp(&aliased, &separate, sizeof(aliased)) == 0, "%s Mat4Mul with out == r differs", name);
+
+		//Transpose only moves values
+		const ew::Mat4 t = ew::Transpose(l);
+		bool transposeExact = true;
+		for (int c = 0; c < 4; c++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				transposeExact = transposeExact && t.at(c, row) == l.at(row, c);
+			}
+		}
+		EW_CHECK(transposeExact, "%s Transpose is not exact", name);
+	}
+
+	//Largest |a - b| over all entries, relative to the largest entry of b (at least 1)
+	float relativeError(const ew::Mat4& a, const ew::Mat4& b) {
+		float error = 0.0f;
+		float scale = 1.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			for (int r = 0; r < 4; r++)
+			{
+				error = fmaxf(error, fabsf(a.at(c, r) - b.at(c, r)));
+				scale = fmaxf(scale, fabsf(b.at(c, r)));
+			}
+		}
+		return error / scale;
+	}
+
+	bool allZero(const ew::Mat4& m) {
+		for (int c = 0; c < 4; c++)
+		{
+			for (int r = 0; r < 4; r++)
+			{
+				if (m.at(c, r) != 0.0f)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	//Model matrices (rotation, non uniform scale, translation) and well conditioned projective matrices:
+	//perspective projections and random matrices with a dominant diagonal
+	struct InverseCases {
+		std::vector<ew::Mat4> affine;
+		std::vector<ew::Mat4> projective;
+		//Inverse of each at SimdLevel::SCALAR
+		std::vector<ew::Mat4> affineScalar;
+		std::vector<ew::Mat4> projectiveScalar;
+	};
+
+	InverseCases makeInverseCases() {
+		InverseCases cases;
+		for (int n = 0; n < 1000; n++)
+		{
+			const ew::Vec3 t = ew::Vec3(randomFloat(), randomFloat(), randomFloat());
+			const ew::Vec3 r = ew::Vec3(randomFloat(), randomFloat(), randomFloat());
+			const ew::Vec3 s = ew::Vec3(fabsf(randomFloat()) + 0.1f, fabsf(randomFloat()) + 0.1f, -(fabsf(randomFloat()) + 0.1f));
+			cases.affine.push_back(ew::TRS(t, r, s));
+			if (n % 2 == 0) {
+				cases.projective.push_back(ew::Perspective(ew::Radians(30.0f + fabsf(randomFloat()) * 10.0f), 0.5f + fabsf(randomFloat()) * 0.2f,
+					0.01f + fabsf(randomFloat()) * 0.1f, 100.0f + fabsf(randomFloat()) * 100.0f));
+			}
+			else {
+				ew::Mat4 m = randomMat4();
+				for (int i = 0; i < 4; i++)
+					m.at(i, i) += m.at(i, i) < 0.0f ? -40.0f : 40.0f;
+				cases.projective.push_back(m);
+			}
+		}
+		const ew::SimdLevel level = ew::GetSimdLevel();
+		ew::SetSimdLevel(ew::SimdLevel::SCALAR);
+		for (const ew::Mat4& m : cases.affine)
+			cases.affineScalar.push_back(ew::Inverse(m));
+		for (const ew::Mat4& m : cases.projective)
+			cases.projectiveScalar.push_back(ew::Inverse(m));
+		ew::SetSimdLevel(level);
+		return cases;
+	}
+
+	void testInverse(ew::SimdLevel level, const InverseCases& cases) {
+		const char* name = ew::SimdLevelName(level);
+		const ew::Mat4 identity = ew::IdentityMatrix();
+		float maxIdentityError = 0.0f;
+		float maxScalarError = 0.0f;
+		float maxAffineError = 0.0f;
+		float maxNormalError = 0.0f;
+		for (size_t i = 0; i < cases.affine.size(); i++)
+		{
+			const ew::Mat4& m = cases.affine[i];
+			const ew::Mat4 inverse = ew::Inverse(m);
+			maxIdentityError = fmaxf(maxIdentityError, relativeError(ew::MulScalar(m, inverse), identity));
+			maxScalarError = fmaxf(maxScalarError, relativeError(inverse, cases.affineScalar[i]));
+			maxAffineError = fmaxf(maxAffineError, relativeError(ew::AffineInverse(m), inverse));
+			//Upper 3x3 of transpose(inverse(m))
+			ew::Mat4 expectedNormal = ew::Transpose(inverse);
+			for (int j = 0; j < 3; j++)
+			{
+				expectedNormal.at(3, j) = 0.0f;
+				expectedNormal.at(j, 3) = 0.0f;
+			}
+			maxNormalError = fmaxf(maxNormalError, relativeError(ew::NormalMatrix(m), expectedNormal));
+		}
+		for (size_t i = 0; i < cases.projective.size(); i++)
+		{
+			const ew::Mat4& m = cases.projective[i];
+			const ew::Mat4 inverse = ew::Inverse(m);
+			maxIdentityError = fmaxf(maxIdentityError, relativeError(ew::MulScalar(m, inverse), identity));
+			maxScalarError = fmaxf(maxScalarError, relativeError(inverse, cases.projectiveScalar[i]));
+		}
+		printf("%-7s Inverse: M*Inverse(M) max %.1e from I, %.1e from scalar. AffineInverse %.1e, NormalMatrix %.1e from Inverse\n",
+			name, maxIdentityError, maxScalarError, maxAffineError, maxNormalError);
+		EW_CHECK(maxIdentityError <= 1e-4f, "%s M*Inverse(M) off from identity by %.1e", name, maxIdentityError);
+		EW_CHECK(maxScalarError <= 1e-5f, "%s Inverse off from scalar by %.1e", name, maxScalarError);
+		EW_CHECK(maxAffineError <= 1e-5f, "%s AffineInverse off from Inverse by %.1e", name, maxAffineError);
+		EW_CHECK(maxNormalError <= 1e-5f, "%s NormalMatrix off from transpose(Inverse) by %.1e", name, maxNormalError);
+
+		//Column 2 repeats column 0. Small integers keep every product exact, so the determinant is exactly 0 on every path.
+		const ew::Mat4 singular = ew::Mat4(
+			1.0f, 2.0f, 1.0f, 4.0f,
+			3.0f, -1.0f, 3.0f, 2.0f,
+			2.0f, 5.0f, 2.0f, -3.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+		EW_CHECK(allZero(ew::Inverse(singular)), "%s Inverse of a singular matrix is not zero", name);
+		EW_CHECK(allZero(ew::AffineInverse(singular)), "%s AffineInverse of a singular matrix is not zero", name);
+		EW_CHECK(allZero(ew::NormalMatrix(singular)), "%s NormalMatrix of a singular matrix is not zero", name);
+	}
+}
+
+int main() {
+	srand(1234);
+	const ew::SimdLevel detected = ew::DetectSimdLevel();
+	printf("Detected %s\n", ew::SimdLevelName(detected));
+	const InverseCases inverseCases = makeInverseCases();
+	for (int level = (int)ew::SimdLevel::SCALAR; level <= (int)detected; level++)
+	{
+		const ew::SimdLevel selected = ew::SetSimdLevel((ew::SimdLevel)level);
+		EW_CHECK(selected == (ew::SimdLevel)level, "SetSimdLevel(%s) selected %s", ew::SimdLevelName((ew::SimdLevel)level), ew::SimdLevelName(selected));
+		testLevel(selected);
+		testInverse(selected, inverseCases);
+	}
+	ew::SetSimdLevel(detected);
+	return test::testResult();
+}
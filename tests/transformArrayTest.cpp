@@ -0,0 +1,69 @@
+//TransformArray must round trip transforms and agree with Transform::getModelMatrix, for Euler and quaternion rotations
+
+#include <math.h>
+#include <vector>
+#include <ew/transformArray.h>
+#include "check.h"
+
+namespace {
+	std::vector<ew::Transform> makeTransforms(size_t count) {
+		std::vector<ew::Transform> transforms(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const float f = (float)i;
+			ew::Transform& t = transforms[i];
+			t.position = ew::Vec3(f, 2.0f * f, -f);
+			t.rotation = ew::Vec3(fmodf(f * 7.0f, 360.0f), fmodf(f * 13.0f, 360.0f), f);
+			t.scale = ew::Vec3(1.0f + f * 0.01f, 2.0f, 3.0f);
+			t.orientation = ew::Quat(ew::Normalize(ew::Vec3(sinf(f), 1.0f, cosf(f))) * sinf(f * 0.01f), cosf(f * 0.01f));
+			//Groups of 8 that are all Euler, all quaternion, and mixed, so every AVX2 branch runs
+			const size_t group = i / 8 % 3;
+			t.useOrientation = group == 1 || (group == 2 && i % 2 == 1);
+		}
+		return transforms;
+	}
+}
+
+int main() {
+	//Not a multiple of 8, so the scalar tail runs too
+	const std::vector<ew::Transform> transforms = makeTransforms(1003);
+	ew::TransformArray array;
+	for (const ew::Transform& t : transforms) {
+		array.add(t);
+	}
+
+	for (size_t i = 0; i < transforms.size(); i++)
+	{
+		const ew::Transform t = array.get(i);
+		const ew::Quat& q = transforms[i].orientation;
+		EW_CHECK(t.useOrientation == transforms[i].useOrientation, "transform %zu lost useOrientation", i);
+		EW_CHECK(t.orientation.x == q.x && t.orientation.y == q.y && t.orientation.z == q.z && t.orientation.w == q.w,
+			"transform %zu lost its orientation", i);
+	}
+
+	const ew::SimdLevel detected = ew::DetectSimdLevel();
+	for (int level = (int)ew::SimdLevel::SCALAR; level <= (int)detected; level++)
+	{
+		ew::SetSimdLevel((ew::SimdLevel)level);
+		std::vector<ew::Mat4> models(transforms.size());
+		array.computeModelMatrices(models.data());
+		float maxError = 0.0f;
+		for (size_t i = 0; i < transforms.size(); i++)
+		{
+			const ew::Mat4& expected = transforms[i].getModelMatrix();
+			for (int c = 0; c < 4; c++)
+			{
+				for (int r = 0; r < 4; r++)
+				{
+					//Relative to the column's scale, and positions are exact
+					const float scale = c < 3 ? (c == 0 ? transforms[i].scale.x : c == 1 ? transforms[i].scale.y : transforms[i].scale.z) : 1.0f;
+					maxError = fmaxf(maxError, fabsf(models[i].at(c, r) - expected.at(c, r)) / scale);
+				}
+			}
+		}
+		printf("%-7s max error %g\n", ew::SimdLevelName((ew::SimdLevel)level), maxError);
+		EW_CHECK(maxError < 1e-5f, "%s model matrices differ from Transform by %g", ew::SimdLevelName((ew::SimdLevel)level), maxError);
+	}
+	ew::SetSimdLevel(detected);
+	return test::testResult();
+}
@@ -0,0 +1,74 @@
+//Packs the same vertices into every layout with the scalar and AVX2 paths, which must produce identical bytes
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <ew/mesh.h>
+#include <ew/vertexLayout.h>
+#include "check.h"
+
+namespace {
+	float randomRange(float lo, float hi) {
+		return lo + (float)rand() / (float)RAND_MAX * (hi - lo);
+	}
+
+	//Random vertices around box, plus edge cases: corners and outside the box, axis and negative z normals,
+	//UVs outside [0,1], past the half range and below its normals
+	std::vector<ew::Vertex> makeVertices(size_t count, const ew::AABB& box) {
+		std::vector<ew::Vertex> vertices(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			ew::Vertex& v = vertices[i];
+			v.pos = ew::Vec3(randomRange(box.min.x - 1.0f, box.max.x + 1.0f), randomRange(box.min.y, box.max.y), randomRange(box.min.z, box.max.z));
+			v.normal = ew::Normalize(ew::Vec3(randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f)));
+			v.uv = ew::Vec2(randomRange(-2.0f, 3.0f), randomRange(0.0f, 1.0f));
+			switch (i % 8) {
+			case 1: v.pos = box.min; v.normal = ew::Vec3(0.0f, 0.0f, -1.0f); break;
+			case 3: v.pos = box.max; v.normal = ew::Vec3(1.0f, 0.0f, 0.0f); v.uv = ew::Vec2(70000.0f, -70000.0f); break;
+			case 5: v.normal = ew::Vec3(0.0f, -1.0f, 0.0f); v.uv = ew::Vec2(1e-6f, -3e-8f); break;
+			case 6: v.uv = ew::Vec2(0.5f, 1.0f); break;
+			default: break;
+			}
+		}
+		return vertices;
+	}
+
+	std::vector<unsigned char> pack(const std::vector<ew::Vertex>& vertices, const ew::VertexLayout& layout, const ew::AABB& box) {
+		//Sentinel bytes past the end catch writes beyond count vertices
+		std::vector<unsigned char> out(vertices.size() * layout.stride() + 16, 0xCD);
+		ew::packVertices(vertices.data(), vertices.size(), layout, box, out.data());
+		return out;
+	}
+}
+
+int main() {
+	srand(1234);
+	const ew::SimdLevel detected = ew::DetectSimdLevel();
+	if (detected < ew::SimdLevel::AVX2) {
+		printf("No AVX2 (detected %s), only the scalar path exists\n", ew::SimdLevelName(detected));
+		return test::testResult();
+	}
+	ew::AABB box;
+	box.min = ew::Vec3(-3.0f, 0.5f, -10.0f);
+	box.max = ew::Vec3(5.0f, 2.0f, 10.0f);
+	//Odd counts leave scalar tails after the 8 wide batches
+	const size_t counts[] = { 0, 1, 7, 8, 9, 15, 17, 1003 };
+	for (size_t count : counts)
+	{
+		const std::vector<ew::Vertex> vertices = makeVertices(count, box);
+		for (int p = 0; p < 2; p++)
+		for (int n = 0; n < 2; n++)
+		for (int u = 0; u < 3; u++)
+		{
+			const ew::VertexLayout layout((ew::PositionFormat)p, (ew::NormalFormat)n, (ew::UVFormat)u);
+			ew::SetSimdLevel(ew::SimdLevel::SCALAR);
+			const std::vector<unsigned char> scalar = pack(vertices, layout, box);
+			ew::SetSimdLevel(ew::SimdLevel::AVX2);
+			const std::vector<unsigned char> avx2 = pack(vertices, layout, box);
+			EW_CHECK(memcmp(scalar.data(), avx2.data(), scalar.size()) == 0, "%zu vertices, layout %d/%d/%d: AVX2 differs from scalar", count, p, n, u);
+		}
+	}
+	ew::SetSimdLevel(detected);
+	return test::testResult();
+}
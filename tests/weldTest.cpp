@@ -0,0 +1,103 @@
+//Welds meshes with duplicate vertices, UV seams and coordinates too large for 32 bit grid cells
+
+#include <vector>
+#include <ew/weld.h>
+#include "check.h"
+
+namespace {
+	ew::Vertex makeVertex(const ew::Vec3& pos, const ew::Vec2& uv = ew::Vec2(0.0f)) {
+		ew::Vertex v;
+		v.pos = pos;
+		v.normal = ew::Vec3(0.0f, 0.0f, 1.0f);
+		v.uv = uv;
+		return v;
+	}
+
+	//Quad made of two triangles that each have their own 3 vertices, moved to offset
+	ew::MeshData unweldedQuad(const ew::Vec3& offset, float size) {
+		ew::MeshData mesh;
+		const ew::Vec3 corners[4] = { ew::Vec3(0.0f), ew::Vec3(size, 0.0f, 0.0f), ew::Vec3(size, size, 0.0f), ew::Vec3(0.0f, size, 0.0f) };
+		const int triangles[6] = { 0, 1, 2, 0, 2, 3 };
+		for (int i = 0; i < 6; i++)
+		{
+			mesh.vertices.push_back(makeVertex(offset + corners[triangles[i]]));
+			mesh.indices.push_back((unsigned int)i);
+		}
+		return mesh;
+	}
+
+	//Every index is in range and points at a vertex at the position it had before welding
+	bool sameTriangles(const ew::MeshData& before, const ew::MeshData& after) {
+		if (before.indices.size() != after.indices.size())
+			return false;
+		for (size_t i = 0; i < after.indices.size(); i++)
+		{
+			if (after.indices[i] >= after.vertices.size())
+				return false;
+			const ew::Vec3 a = before.vertices[before.indices[i]].pos;
+			const ew::Vec3 b = after.vertices[after.indices[i]].pos;
+			if (a.x != b.x || a.y != b.y || a.z != b.z)
+				return false;
+		}
+		return true;
+	}
+}
+
+int main() {
+	for (unsigned int threads : { 1u, 0u })
+	{
+		//Duplicate positions merge into the first of each group
+		{
+			const ew::MeshData original = unweldedQuad(ew::Vec3(0.0f), 1.0f);
+			ew::MeshData mesh = original;
+			const std::vector<unsigned int> remap = ew::weldVertices(mesh, ew::WeldTolerance(), threads);
+			EW_CHECK(mesh.vertices.size() == 4, "%zu vertices after welding a quad", mesh.vertices.size());
+			EW_CHECK(remap.size() == 6 && remap[3] == remap[0] && remap[4] == remap[2], "shared corners not merged");
+			EW_CHECK(sameTriangles(original, mesh), "triangles changed");
+		}
+
+		//Positions within the tolerance merge, further apart stay split
+		{
+			ew::MeshData mesh;
+			mesh.vertices = { makeVertex(ew::Vec3(1.0f)), makeVertex(ew::Vec3(1.0f + 5e-6f, 1.0f, 1.0f)), makeVertex(ew::Vec3(1.0f + 5e-4f, 1.0f, 1.0f)) };
+			mesh.indices = { 0, 1, 2 };
+			ew::weldVertices(mesh, ew::WeldTolerance(), threads);
+			EW_CHECK(mesh.vertices.size() == 2, "%zu vertices, expected 2", mesh.vertices.size());
+			EW_CHECK(mesh.indices[0] == 0 && mesh.indices[1] == 0 && mesh.indices[2] == 1, "indices %u %u %u", mesh.indices[0], mesh.indices[1], mesh.indices[2]);
+		}
+
+		//A UV seam: same position and normal, UVs 0 and 1. Kept split unless UVs are ignored.
+		{
+			ew::MeshData seam;
+			seam.vertices = { makeVertex(ew::Vec3(0.5f, 0.0f, 0.0f), ew::Vec2(0.0f, 0.5f)), makeVertex(ew::Vec3(0.5f, 0.0f, 0.0f), ew::Vec2(1.0f, 0.5f)),
+				makeVertex(ew::Vec3(0.0f, 1.0f, 0.0f)), makeVertex(ew::Vec3(0.5f, 0.0f, 0.0f), ew::Vec2(0.0f, 0.5f)) };
+			seam.indices = { 0, 2, 1, 3, 2, 1 };
+			ew::MeshData mesh = seam;
+			ew::weldVertices(mesh, ew::WeldTolerance(), threads);
+			EW_CHECK(mesh.vertices.size() == 3, "%zu vertices across a UV seam, expected 3", mesh.vertices.size());
+			EW_CHECK(mesh.indices[0] == mesh.indices[3] && mesh.indices[2] != mesh.indices[0], "seam sides merged or duplicates kept");
+
+			ew::WeldTolerance ignoreUVs;
+			ignoreUVs.uv = -1.0f;
+			mesh = seam;
+			ew::weldVertices(mesh, ignoreUVs, threads);
+			EW_CHECK(mesh.vertices.size() == 2, "%zu vertices ignoring UVs, expected 2", mesh.vertices.size());
+		}
+
+		//Far from the origin with a 1e-6 tolerance, cells are past 32 bits. Duplicates still merge and neighbors stay split.
+		{
+			ew::WeldTolerance fine;
+			fine.position = 1e-6f;
+			const float offsets[] = { 1e7f, -3e9f, 1e30f, -3e38f };
+			for (float offset : offsets)
+			{
+				const ew::MeshData original = unweldedQuad(ew::Vec3(offset, -offset, offset), offset * 1e-3f);
+				ew::MeshData mesh = original;
+				ew::weldVertices(mesh, fine, threads);
+				EW_CHECK(mesh.vertices.size() == 4, "%zu vertices for a quad at %g", mesh.vertices.size(), offset);
+				EW_CHECK(sameTriangles(original, mesh), "triangles changed at %g", offset);
+			}
+		}
+	}
+	return test::testResult();
+}